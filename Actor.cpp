@@ -13,14 +13,33 @@
 Actor::Actor(Game* game)
 	:mGame(game)
 	,mState(EActive)
-	,mPosition(Vector3::Zero)
-	,mScale(1.0f)
-	,mRotation(0.0f)
 	,mMove(nullptr)
 	,mCollision(nullptr)
 	,mMesh(nullptr)
 	,mCamera(nullptr)
+	,mTransforms(game->GetTransforms())
+	,mTransformIndex(0)
+	,mGameIndex(0)
 {
+	mTransformIndex = mTransforms->Add(this);
+	mGame->AddActor(this);
+}
+
+
+// ============================================================================
+// ============================================================================
+Actor::Actor(Game* game, size_t transformIndex)
+	:mGame(game)
+	,mMove(nullptr)
+	,mCollision(nullptr)
+	,mMesh(nullptr)
+	,mCamera(nullptr)
+	,mTransforms(game->GetTransforms())
+	,mTransformIndex(transformIndex)
+	,mState(EActive)
+	,mGameIndex(0)
+{
+	mTransforms->SetOwner(mTransformIndex, this);
 	mGame->AddActor(this);
 }
 
@@ -38,10 +57,24 @@ Actor::~Actor()
 	if (mCamera)
 		delete mCamera;
 	
+	mTransforms->Remove(this, mTransformIndex);
 	mGame->RemoveActor(this);
 }
 
 
+// ============================================================================
+// Dead actors get queued with Game and deleted at the end of the frame
+// ============================================================================
+void Actor::SetState(State state)
+{
+	if (state == EDead && mState != EDead)
+	{
+		mGame->DestroyActor(this);
+	}
+	mState = state;
+}
+
+
 // ============================================================================
 // ============================================================================
 void Actor::Update(float deltaTime)
@@ -66,14 +99,8 @@ void Actor::Update(float deltaTime)
 		}
 		UpdateActor(deltaTime);
 		
-		// Set the world transform:
-		// worldMatrix = scaleMatrix * rotationMatrix * positionMatrix
-		const Matrix4 scaleMatrix = Matrix4::CreateScale(mScale, mScale, mScale);
-		const Matrix4 rotationMatrix = Matrix4::CreateRotationZ(mRotation);
-		const Matrix4 positionMatrix = Matrix4::CreateTranslation(mPosition);
-		
-		mWorldTransform = scaleMatrix * rotationMatrix *
-			Matrix4::CreateFromQuaternion(mQuat) * positionMatrix;
+		// The world transform is rebuilt by the TransformSystem, and only if
+		// something above changed it
 	}
 }
 
@@ -2,6 +2,8 @@
 #include <vector>
 #include <SDL/SDL_stdinc.h>
 #include "Math.h"
+#include "ActorHandle.h"
+#include "TransformSystem.h"
 class Actor
 {
 public:
@@ -27,40 +29,66 @@ public:
 	// Any actor-specific update code (overridable)
 	virtual void ActorInput(const Uint8* keyState);
 
-	// Getters/setters
-	const Vector3& GetPosition() const { return mPosition; }
-	void SetPosition(const Vector3& pos) { mPosition = pos; }
-	
-	float GetScale() const { return mScale; }
-	void SetScale(float scale) { mScale = scale; }
-	
-	float GetRotation() const { return mRotation; }
-	void SetRotation(float rotation) { mRotation = rotation; }
-	
+	// Getters/setters (the transform itself lives in Game's TransformSystem)
+	Vector3 GetPosition() const
+		{ return mTransforms->GetPosition(mTransformIndex); }
+	void SetPosition(const Vector3& pos)
+		{ mTransforms->SetPosition(mTransformIndex, pos); }
+	
+	float GetScale() const
+		{ return mTransforms->GetScale(mTransformIndex); }
+	void SetScale(float scale)
+		{ mTransforms->SetScale(mTransformIndex, scale); }
+	
+	float GetRotation() const
+		{ return mTransforms->GetRotation(mTransformIndex); }
+	void SetRotation(float rotation)
+		{ mTransforms->SetRotation(mTransformIndex, rotation); }
+	
+	// Cached basis, recomputed by the transform system on rotation changes
 	Vector3 GetForward() const
-		{ return Vector3(Math::Cos(mRotation), Math::Sin(mRotation), 0.0f); }
-	
+		{ return mTransforms->GetForward(mTransformIndex); }
 	Vector3 GetRight() const
-		{ return Vector3(Math::Cos(mRotation + Math::PiOver2),
-						 Math::Sin(mRotation + Math::PiOver2), 0.0f); }
+		{ return mTransforms->GetRight(mTransformIndex); }
+	Vector3 GetUp() const
+		{ return mTransforms->GetUp(mTransformIndex); }
 	
 	State GetState() const { return mState; }
-	void SetState(State state) { mState = state; }
+	void SetState(State state);
 
 	class Game* GetGame() { return mGame; }
 	class MoveComponent* GetMove() { return mMove; }
 	class CollisionComponent* GetCollision() { return mCollision; }
 	
-	const Matrix4& GetWorldTransform() const { return mWorldTransform; }
+	const Affine3x4& GetWorldTransform() const
+		{ return mTransforms->GetWorldTransform(mTransformIndex); }
 	
 	class MeshComponent* GetMesh() const { return mMesh; }
 	
 	class CameraComponent* GetCamera() const { return mCamera; }
 	
-	Quaternion GetQuaternion() const { return mQuat; }
-	void SetQuaternion(const Quaternion& quat) { mQuat = quat; }
+	Quaternion GetQuaternion() const
+		{ return mTransforms->GetQuaternion(mTransformIndex); }
+	void SetQuaternion(const Quaternion& quat)
+		{ mTransforms->SetQuaternion(mTransformIndex, quat); }
+	
+	// Slot in Game's actor list, so removal doesn't have to search for it
+	size_t GetGameIndex() const { return mGameIndex; }
+	void SetGameIndex(size_t index) { mGameIndex = index; }
+	
+	// Handle other actors should hold instead of a pointer to this one
+	ActorHandle GetHandle() const { return mHandle; }
+	void SetHandle(ActorHandle handle) { mHandle = handle; }
+	
+	// Slot in the TransformSystem
+	size_t GetTransformIndex() const { return mTransformIndex; }
+	void SetTransformIndex(size_t index) { mTransformIndex = index; }
 	
 protected:
+	// Take over a transform slot that was already filled in (see
+	// TransformSystem::AddRange) instead of adding a new one
+	Actor(class Game* game, size_t transformIndex);
+
 	class Game* mGame;
 	
 	// Components
@@ -70,14 +98,12 @@ protected:
 	class CameraComponent* mCamera;
 	
 	// Transform
-	Matrix4 mWorldTransform;
-	Vector3 mPosition;
-	
-	Quaternion mQuat;
+	class TransformSystem* mTransforms;
+	size_t mTransformIndex;
 	
 	// Actor's state
 	State mState;
 	
-	float mScale;
-	float mRotation;
+	size_t mGameIndex;
+	ActorHandle mHandle;
 };
@@ -0,0 +1,37 @@
+#pragma once
+
+// Weak reference to an actor. The index is a slot in Game's handle table and
+// the generation is bumped whenever that slot is freed, so a handle to an
+// actor that has since been destroyed resolves to nullptr instead of
+// dangling. Generation 0 is never handed out, so a default handle is null.
+class ActorHandle
+{
+public:
+	ActorHandle()
+		:mIndex(0)
+		,mGeneration(0)
+	{}
+
+	ActorHandle(unsigned int index, unsigned int generation)
+		:mIndex(index)
+		,mGeneration(generation)
+	{}
+
+	unsigned int GetIndex() const { return mIndex; }
+	unsigned int GetGeneration() const { return mGeneration; }
+	bool IsNull() const { return mGeneration == 0; }
+
+	bool operator==(const ActorHandle& other) const
+	{
+		return mIndex == other.mIndex && mGeneration == other.mGeneration;
+	}
+
+	bool operator!=(const ActorHandle& other) const
+	{
+		return !(*this == other);
+	}
+
+private:
+	unsigned int mIndex;
+	unsigned int mGeneration;
+};
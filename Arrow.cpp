@@ -20,18 +20,18 @@ Arrow::Arrow(class Game* game)
 // ============================================================================
 void Arrow::UpdateActor(float deltaTime)
 {
-	// If there is no next checkpoint, set mQuat to the identity quaternion
+	// If there is no next checkpoint, use the identity quaternion
 	if (GetGame()->mCheckpoints.empty())
 	{
-		mQuat = Quaternion::Identity;
-		mPosition =
-			GetGame()->GetRenderer()->Unproject(Vector3(0.0f, 250.0f, 0.1f));
+		SetQuaternion(Quaternion::Identity);
+		SetPosition(
+			GetGame()->GetRenderer()->Unproject(Vector3(0.0f, 250.0f, 0.1f)));
 		return;
 	}
 	
 	// Vector from arrow to active checkpoint
-	Checkpoint* cp = GetGame()->mCheckpoints.front();
-	Vector3 pos = cp->GetPosition() - mPosition;
+	Checkpoint* cp = GetGame()->GetActiveCheckpoint();
+	Vector3 pos = cp->GetPosition() - GetPosition();
 	pos.Normalize();
 	
 	// Axis
@@ -46,11 +46,11 @@ void Arrow::UpdateActor(float deltaTime)
 	// parallel, and hence they cannot form a plane
 	if (Math::NearZero(axis.Length()))
 	{
-		mQuat = Quaternion::Identity;
+		SetQuaternion(Quaternion::Identity);
 	}
 	
-	mQuat = Quaternion(axis, angle);
+	SetQuaternion(Quaternion(axis, angle));
 
-	mPosition =
-		GetGame()->GetRenderer()->Unproject(Vector3(0.0f, 250.0f, 0.1f));
+	SetPosition(
+		GetGame()->GetRenderer()->Unproject(Vector3(0.0f, 250.0f, 0.1f)));
 }
@@ -0,0 +1,28 @@
+#pragma once
+
+// Compact handle to a loaded asset: an index into the table of whoever
+// handed it out. Names are resolved to ids once, when the asset user is
+// created, so playing or drawing it is an array index rather than a string
+// hash. A default id is null.
+class AssetId
+{
+public:
+	AssetId()
+		:mIndex(NullIndex)
+	{}
+
+	explicit AssetId(unsigned int index)
+		:mIndex(index)
+	{}
+
+	unsigned int GetIndex() const { return mIndex; }
+	bool IsNull() const { return mIndex == NullIndex; }
+
+	bool operator==(const AssetId& other) const { return mIndex == other.mIndex; }
+	bool operator!=(const AssetId& other) const { return mIndex != other.mIndex; }
+
+private:
+	static const unsigned int NullIndex = 0xFFFFFFFF;
+
+	unsigned int mIndex;
+};
@@ -0,0 +1,248 @@
+#include "AssetPack.h"
+#include "LZ4.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <SDL/SDL_log.h>
+
+const char AssetPack::Magic[4] = { 'G', 'P', 'A', 'K' };
+
+static_assert(sizeof(AssetPackHeader) == 32, "AssetPackHeader layout changed");
+static_assert(sizeof(AssetPackEntry) == 40, "AssetPackEntry layout changed");
+
+static uint64_t AlignUp(uint64_t offset)
+{
+	return (offset + AssetPack::Alignment - 1) & ~static_cast<uint64_t>(AssetPack::Alignment - 1);
+}
+
+static bool EntryLess(const AssetPackEntry& entry, uint64_t hash)
+{
+	return entry.mHash < hash;
+}
+
+
+// ============================================================================
+// ============================================================================
+AssetPack::AssetPack()
+	:mEntries(nullptr)
+	,mNumEntries(0)
+	,mNames(nullptr)
+{
+}
+
+
+// ============================================================================
+// Everything Find and Extract rely on is checked here, so lookups don't
+// have to bounds check
+// ============================================================================
+bool AssetPack::Open(const std::string& fileName)
+{
+	Close();
+	if (!mFile.Open(fileName))
+	{
+		return false;
+	}
+
+	const unsigned char* data = mFile.GetData();
+	const uint64_t size = mFile.GetSize();
+	const AssetPackHeader* header = reinterpret_cast<const AssetPackHeader*>(data);
+	if (size < sizeof(AssetPackHeader) ||
+		memcmp(header->mMagic, Magic, sizeof(Magic)) != 0 ||
+		header->mVersion != Version)
+	{
+		SDL_Log("%s is not a version %u asset pack", fileName.c_str(),
+				static_cast<unsigned>(Version));
+		Close();
+		return false;
+	}
+
+	const uint64_t tocBytes = static_cast<uint64_t>(header->mNumEntries) * sizeof(AssetPackEntry);
+	if (header->mTOCOffset % Alignment != 0 || header->mTOCOffset > size ||
+		tocBytes > size - header->mTOCOffset || header->mNamesOffset > size ||
+		header->mNamesSize > size - header->mNamesOffset ||
+		(header->mNamesSize > 0 && data[header->mNamesOffset + header->mNamesSize - 1] != '\0'))
+	{
+		SDL_Log("Asset pack %s has a bad table of contents", fileName.c_str());
+		Close();
+		return false;
+	}
+
+	const AssetPackEntry* entries =
+		reinterpret_cast<const AssetPackEntry*>(data + header->mTOCOffset);
+	for (uint32_t i = 0; i < header->mNumEntries; i++)
+	{
+		const AssetPackEntry& entry = entries[i];
+		const bool compressed = (entry.mFlags & AssetPackCompressed) != 0;
+		if (entry.mOffset > size || entry.mStoredSize > size - entry.mOffset ||
+			entry.mNameOffset >= header->mNamesSize ||
+			(!compressed && entry.mStoredSize != entry.mSize) ||
+			(i > 0 && entries[i - 1].mHash > entry.mHash))
+		{
+			SDL_Log("Asset pack %s has a bad entry %u", fileName.c_str(), i);
+			Close();
+			return false;
+		}
+	}
+
+	mEntries = entries;
+	mNumEntries = header->mNumEntries;
+	mNames = reinterpret_cast<const char*>(data + header->mNamesOffset);
+	return true;
+}
+
+
+// ============================================================================
+// ============================================================================
+void AssetPack::Close()
+{
+	mFile.Close();
+	mEntries = nullptr;
+	mNumEntries = 0;
+	mNames = nullptr;
+}
+
+
+// ============================================================================
+// Binary search on the hash, then compare names in case two collide
+// ============================================================================
+const AssetPackEntry* AssetPack::Find(const std::string& name) const
+{
+	const uint64_t hash = HashName(name.c_str(), name.size());
+	const AssetPackEntry* end = mEntries + mNumEntries;
+	for (const AssetPackEntry* entry = std::lower_bound(mEntries, end, hash, EntryLess);
+		 entry != end && entry->mHash == hash; ++entry)
+	{
+		if (name == GetName(*entry))
+		{
+			return entry;
+		}
+	}
+	return nullptr;
+}
+
+
+// ============================================================================
+// ============================================================================
+const unsigned char* AssetPack::GetData(const AssetPackEntry& entry) const
+{
+	if (entry.mFlags & AssetPackCompressed)
+	{
+		return nullptr;
+	}
+	return mFile.GetData() + entry.mOffset;
+}
+
+
+// ============================================================================
+// ============================================================================
+bool AssetPack::Extract(const AssetPackEntry& entry, unsigned char* out) const
+{
+	const unsigned char* stored = mFile.GetData() + entry.mOffset;
+	if (!(entry.mFlags & AssetPackCompressed))
+	{
+		memcpy(out, stored, entry.mSize);
+		return true;
+	}
+	if (!LZ4::Decompress(stored, entry.mStoredSize, out, entry.mSize))
+	{
+		SDL_Log("Asset pack entry %s is corrupt", GetName(entry));
+		return false;
+	}
+	return true;
+}
+
+
+// ============================================================================
+// ============================================================================
+uint64_t AssetPack::HashName(const char* name, size_t length)
+{
+	uint64_t hash = 0xCBF29CE484222325ULL;
+	for (size_t i = 0; i < length; i++)
+	{
+		hash ^= static_cast<unsigned char>(name[i]);
+		hash *= 0x100000001B3ULL;
+	}
+	return hash;
+}
+
+
+// ============================================================================
+// Entry data is laid out in source order, then the sorted table and names
+// go at the end once every offset is known
+// ============================================================================
+bool AssetPack::Write(const std::string& fileName,
+					  const std::vector<AssetPackSource>& sources)
+{
+	std::vector<unsigned char> out(sizeof(AssetPackHeader), 0);
+	std::vector<AssetPackEntry> entries;
+	entries.reserve(sources.size());
+	std::string names;
+	std::vector<unsigned char> compressed;
+
+	for (const auto& source : sources)
+	{
+		AssetPackEntry entry;
+		memset(&entry, 0, sizeof(entry));
+		entry.mHash = HashName(source.mName.c_str(), source.mName.size());
+		entry.mSize = source.mData.size();
+		entry.mNameOffset = static_cast<uint32_t>(names.size());
+		names.append(source.mName);
+		names.push_back('\0');
+
+		const unsigned char* bytes = source.mData.data();
+		size_t storedSize = source.mData.size();
+		if (source.mCompress && !source.mData.empty())
+		{
+			compressed.resize(LZ4::GetMaxCompressedSize(source.mData.size()));
+			const size_t compressedSize =
+				LZ4::Compress(source.mData.data(), source.mData.size(), compressed.data());
+			if (compressedSize <= source.mData.size() - source.mData.size() / 4)
+			{
+				entry.mFlags |= AssetPackCompressed;
+				bytes = compressed.data();
+				storedSize = compressedSize;
+			}
+		}
+
+		entry.mOffset = AlignUp(out.size());
+		entry.mStoredSize = storedSize;
+		out.resize(entry.mOffset + storedSize, 0);
+		if (storedSize > 0)
+		{
+			memcpy(out.data() + entry.mOffset, bytes, storedSize);
+		}
+		entries.emplace_back(entry);
+	}
+
+	std::stable_sort(entries.begin(), entries.end(),
+		[](const AssetPackEntry& a, const AssetPackEntry& b) { return a.mHash < b.mHash; });
+
+	AssetPackHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.mMagic, Magic, sizeof(Magic));
+	header.mVersion = Version;
+	header.mNumEntries = static_cast<uint32_t>(entries.size());
+	header.mNamesSize = static_cast<uint32_t>(names.size());
+	header.mTOCOffset = AlignUp(out.size());
+	header.mNamesOffset = header.mTOCOffset + entries.size() * sizeof(AssetPackEntry);
+	memcpy(out.data(), &header, sizeof(header));
+
+	out.resize(header.mTOCOffset, 0);
+	const unsigned char* tocBytes = reinterpret_cast<const unsigned char*>(entries.data());
+	out.insert(out.end(), tocBytes, tocBytes + entries.size() * sizeof(AssetPackEntry));
+	out.insert(out.end(), names.begin(), names.end());
+
+	std::ofstream file(fileName, std::ios::binary | std::ios::trunc);
+	if (!file.is_open())
+	{
+		SDL_Log("Couldn't open %s for writing", fileName.c_str());
+		return false;
+	}
+	file.write(reinterpret_cast<const char*>(out.data()), out.size());
+	if (!file)
+	{
+		SDL_Log("Failed writing %s", fileName.c_str());
+		return false;
+	}
+	return true;
+}
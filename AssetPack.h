@@ -0,0 +1,94 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "MappedFile.h"
+
+// Asset pack (Assets.pak, written by Tools/Pack.cpp):
+//   header
+//   entry data, each 16 byte aligned
+//   table of contents, sorted by name hash
+//   names, NUL-terminated back to back
+// Little endian. The pack is memory mapped once; a stored entry is read in
+// place and a compressed one (LZ4 block) is decompressed on request.
+struct AssetPackHeader
+{
+	char mMagic[4];
+	uint32_t mVersion;
+	uint32_t mNumEntries;
+	uint32_t mNamesSize;
+	uint64_t mTOCOffset;
+	uint64_t mNamesOffset;
+};
+
+enum AssetPackFlags : uint32_t
+{
+	AssetPackCompressed = 1 << 0
+};
+
+struct AssetPackEntry
+{
+	uint64_t mHash;
+	uint64_t mOffset;
+	// Bytes in the pack, and once decompressed (equal if stored)
+	uint64_t mStoredSize;
+	uint64_t mSize;
+	uint32_t mNameOffset;
+	uint32_t mFlags;
+};
+
+// One file to pack, for Write
+struct AssetPackSource
+{
+	std::string mName;
+	std::vector<unsigned char> mData;
+	bool mCompress;
+};
+
+class AssetPack
+{
+public:
+	static const char Magic[4];
+	static const uint32_t Version = 1;
+	static const size_t Alignment = 16;
+
+	AssetPack();
+
+	// Map and validate a pack. Returns false, without logging, if the file
+	// doesn't exist.
+	bool Open(const std::string& fileName);
+	void Close();
+
+	// The entry for a path as the game spells it ("Assets/Cube.png"), or
+	// nullptr if the pack doesn't have it
+	const AssetPackEntry* Find(const std::string& name) const;
+
+	// Where a stored entry's bytes are in the mapping, or nullptr if the
+	// entry is compressed
+	const unsigned char* GetData(const AssetPackEntry& entry) const;
+
+	// Copy or decompress an entry into out, which holds entry.mSize bytes.
+	// Safe to call from any thread.
+	bool Extract(const AssetPackEntry& entry, unsigned char* out) const;
+
+	size_t GetNumEntries() const { return mNumEntries; }
+	const AssetPackEntry& GetEntry(size_t index) const { return mEntries[index]; }
+	const char* GetName(const AssetPackEntry& entry) const
+	{
+		return mNames + entry.mNameOffset;
+	}
+
+	// Write a pack. Sources marked mCompress are only stored compressed if
+	// that saves at least a quarter of their size.
+	static bool Write(const std::string& fileName,
+					  const std::vector<AssetPackSource>& sources);
+
+	// 64-bit FNV-1a of a name, the key the table of contents is sorted by
+	static uint64_t HashName(const char* name, size_t length);
+
+private:
+	MappedFile mFile;
+	const AssetPackEntry* mEntries;
+	size_t mNumEntries;
+	const char* mNames;
+};
@@ -0,0 +1,20 @@
+#include "AssetPath.h"
+
+const char* const AssetPath::MeshSuffix = ".bin";
+const char* const AssetPath::LevelSuffix = ".bin";
+const char* const AssetPath::TextureSuffix = ".dds";
+const char* const AssetPath::SoundSuffix = ".pcm";
+
+bool AssetPath::sUseCooked = true;
+
+
+// ============================================================================
+// ============================================================================
+std::string AssetPath::GetCooked(const std::string& source, const char* suffix)
+{
+	if (!sUseCooked)
+	{
+		return std::string();
+	}
+	return source + suffix;
+}
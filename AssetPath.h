@@ -0,0 +1,26 @@
+#pragma once
+#include <string>
+
+// Cooked assets (written by Tools/Cook.cpp) sit next to their sources with a
+// suffix per asset type. Loaders ask for the cooked path first and fall back
+// to the source if it isn't there.
+class AssetPath
+{
+public:
+	static const char* const MeshSuffix;
+	static const char* const LevelSuffix;
+	static const char* const TextureSuffix;
+	static const char* const SoundSuffix;
+
+	// Path of source's cooked form, or an empty string when cooked assets
+	// are switched off
+	static std::string GetCooked(const std::string& source, const char* suffix);
+
+	// Load only the raw sources (the --raw command line switch), for
+	// comparing against a cooked run
+	static void SetUseCooked(bool useCooked) { sUseCooked = useCooked; }
+	static bool GetUseCooked() { return sUseCooked; }
+
+private:
+	static bool sUseCooked;
+};
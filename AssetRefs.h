@@ -0,0 +1,43 @@
+#pragma once
+
+// How many scopes (and for textures, meshes) hold an asset. Assets are
+// owned by scopes: one per level, plus the session for anything asked for
+// outside a level. A transition opens the new level's scope before building
+// it and releases the old one after, so an asset both levels use never
+// drops to zero references.
+struct AssetRefs
+{
+	// Never released
+	static const unsigned int SessionScope = 0;
+
+	AssetRefs()
+		:mCount(0)
+		,mLastScope(0xFFFFFFFF)
+	{
+	}
+
+	// A scope only ever references assets while it's the current one, so
+	// remembering the last scope is enough to count each scope once.
+	// Returns true if this took a new reference.
+	bool AddScopeRef(unsigned int scope)
+	{
+		if (mLastScope == scope)
+		{
+			return false;
+		}
+		mLastScope = scope;
+		mCount++;
+		return true;
+	}
+
+	unsigned int mCount;
+	unsigned int mLastScope;
+};
+
+// One reference a scope holds, so the scope can give it back on release
+template <typename T>
+struct ScopeRef
+{
+	unsigned int mScope;
+	T mAsset;
+};
@@ -0,0 +1,399 @@
+#include "AudioSystem.h"
+#include "FileSystem.h"
+#include "AssetPack.h"
+#include <chrono>
+#include <SDL/SDL_log.h>
+
+// Room for a burst of commands; the thread drains it every couple of ms
+static const size_t sCommandCapacity = 256;
+
+// How long the audio thread sleeps between passes over the queue, well
+// under one mixer buffer
+static const int sPollMS = 2;
+
+
+// ============================================================================
+// ============================================================================
+AudioSystem::AudioSystem()
+	:mCommands(sCommandCapacity)
+	,mStopping(false)
+	,mNumSent(0)
+	,mNumApplied(0)
+	,mNextVoice(1)
+	,mNumDropped(0)
+	,mStartOrder(0)
+	,mMusic(nullptr)
+	,mNextMusic(nullptr)
+	,mMusicFadeMS(0)
+{
+}
+
+
+// ============================================================================
+// ============================================================================
+AudioSystem::~AudioSystem()
+{
+	Shutdown();
+}
+
+
+// ============================================================================
+// ============================================================================
+void AudioSystem::Initialize(int numVoices)
+{
+	Mix_AllocateChannels(numVoices);
+	Channel empty = { 0, AudioPriorityLow, 0 };
+	mChannels.assign(numVoices, empty);
+	mStopping = false;
+	mThread = std::thread(&AudioSystem::ThreadLoop, this);
+}
+
+
+// ============================================================================
+// The thread is gone by the time the mixer is touched here, so this thread
+// can take the audio lock safely
+// ============================================================================
+void AudioSystem::Shutdown()
+{
+	if (!mThread.joinable())
+	{
+		return;
+	}
+	mStopping = true;
+	mThread.join();
+
+	Mix_HaltChannel(-1);
+	Mix_HaltMusic();
+	FreeMusic(mNextMusic);
+	mNextMusic = nullptr;
+	FreeMusic(mMusic);
+	mMusic = nullptr;
+	mMusicName.clear();
+	mPaused.clear();
+
+	if (mNumDropped > 0)
+	{
+		SDL_Log("Audio command queue was full, dropped %u commands", mNumDropped);
+	}
+}
+
+
+// ============================================================================
+// ============================================================================
+AudioSystem::VoiceId AudioSystem::Play(Mix_Chunk* chunk, int loops,
+									   AudioPriority priority)
+{
+	if (!chunk)
+	{
+		return 0;
+	}
+	const VoiceId voice = mNextVoice++;
+	if (mNextVoice == 0)
+	{
+		mNextVoice = 1;
+	}
+	Command command = { CommandPlay, voice, chunk, loops, priority, nullptr, 0 };
+	Send(command);
+	return voice;
+}
+
+
+// ============================================================================
+// Voices start unpaused, so a voice with no entry is playing
+// ============================================================================
+void AudioSystem::SetPaused(VoiceId voice, bool paused)
+{
+	if (voice == 0)
+	{
+		return;
+	}
+	auto it = mPaused.find(voice);
+	const bool wasPaused = (it != mPaused.end()) && it->second;
+	if (paused == wasPaused)
+	{
+		return;
+	}
+	if (it == mPaused.end())
+	{
+		mPaused.emplace(voice, paused);
+	}
+	else
+	{
+		it->second = paused;
+	}
+	Command command = { paused ? CommandPause : CommandResume, voice, nullptr, 0,
+		AudioPriorityLow, nullptr, 0 };
+	Send(command);
+}
+
+
+// ============================================================================
+// ============================================================================
+void AudioSystem::Stop(VoiceId voice)
+{
+	if (voice == 0)
+	{
+		return;
+	}
+	mPaused.erase(voice);
+	Command command = { CommandStop, voice, nullptr, 0, AudioPriorityLow, nullptr, 0 };
+	Send(command);
+}
+
+
+// ============================================================================
+// ============================================================================
+void AudioSystem::PlayMusic(const std::string& fileName, int fadeMS)
+{
+	if (fileName == mMusicName)
+	{
+		return;
+	}
+	MusicTrack* track = LoadMusic(fileName);
+	if (!track)
+	{
+		return;
+	}
+	mMusicName = fileName;
+	Command command = { CommandPlayMusic, 0, nullptr, 0, AudioPriorityLow, track, fadeMS };
+	Send(command);
+}
+
+
+// ============================================================================
+// ============================================================================
+void AudioSystem::Flush()
+{
+	if (!mThread.joinable())
+	{
+		return;
+	}
+	while (mNumApplied.load(std::memory_order_acquire) != mNumSent)
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+}
+
+
+// ============================================================================
+// A full queue drops the command instead of waiting for the audio thread.
+// A dropped track was never handed over, so it's still ours to free.
+// ============================================================================
+void AudioSystem::Send(const Command& command)
+{
+	if (mCommands.Push(command))
+	{
+		mNumSent++;
+	}
+	else
+	{
+		mNumDropped++;
+		if (command.mType == CommandPlayMusic)
+		{
+			FreeMusic(command.mMusic);
+			mMusicName.clear();
+		}
+	}
+}
+
+
+// ============================================================================
+// Only queues what's left once asked to stop, so Shutdown sees every
+// command sent before it
+// ============================================================================
+void AudioSystem::ThreadLoop()
+{
+	for (;;)
+	{
+		const bool stopping = mStopping;
+		Command command;
+		while (mCommands.Pop(command))
+		{
+			Execute(command);
+			mNumApplied.fetch_add(1, std::memory_order_release);
+		}
+		if (stopping)
+		{
+			return;
+		}
+		UpdateMusic();
+		std::this_thread::sleep_for(std::chrono::milliseconds(sPollMS));
+	}
+}
+
+
+// ============================================================================
+// ============================================================================
+void AudioSystem::Execute(const Command& command)
+{
+	switch (command.mType)
+	{
+	case CommandPlay:
+	{
+		const int channel = ChooseChannel(command.mPriority);
+		if (channel >= 0 &&
+			Mix_PlayChannel(channel, command.mChunk, command.mLoops) == channel)
+		{
+			Channel& state = mChannels[channel];
+			state.mVoice = command.mVoice;
+			state.mPriority = command.mPriority;
+			state.mStartOrder = mStartOrder++;
+		}
+		break;
+	}
+	case CommandPause:
+	case CommandResume:
+	case CommandStop:
+	{
+		const int channel = FindVoice(command.mVoice);
+		if (channel < 0)
+		{
+			break;
+		}
+		if (command.mType == CommandPause)
+		{
+			Mix_Pause(channel);
+		}
+		else if (command.mType == CommandResume)
+		{
+			Mix_Resume(channel);
+		}
+		else
+		{
+			Mix_HaltChannel(channel);
+			mChannels[channel].mVoice = 0;
+		}
+		break;
+	}
+	case CommandPlayMusic:
+		// Mix_FadeInMusic would block until a fade out finished, so the new
+		// track waits in mNextMusic and UpdateMusic starts it after
+		FreeMusic(mNextMusic);
+		mNextMusic = nullptr;
+		if (Mix_PlayingMusic())
+		{
+			Mix_FadeOutMusic(command.mFadeMS);
+			mNextMusic = command.mMusic;
+			mMusicFadeMS = command.mFadeMS;
+		}
+		else
+		{
+			FreeMusic(mMusic);
+			mMusic = command.mMusic;
+			Mix_FadeInMusic(mMusic->mMusic, -1, command.mFadeMS);
+		}
+		break;
+	}
+}
+
+
+// ============================================================================
+// A free channel if there is one, otherwise steal
+// ============================================================================
+int AudioSystem::ChooseChannel(AudioPriority priority)
+{
+	int victim = -1;
+	for (size_t i = 0; i < mChannels.size(); i++)
+	{
+		const int channel = static_cast<int>(i);
+		if (!Mix_Playing(channel))
+		{
+			return channel;
+		}
+		const Channel& state = mChannels[i];
+		if (state.mPriority > priority)
+		{
+			continue;
+		}
+		if (victim < 0 || state.mPriority < mChannels[victim].mPriority ||
+			(state.mPriority == mChannels[victim].mPriority &&
+			 state.mStartOrder < mChannels[victim].mStartOrder))
+		{
+			victim = channel;
+		}
+	}
+	if (victim >= 0)
+	{
+		Mix_HaltChannel(victim);
+	}
+	return victim;
+}
+
+
+// ============================================================================
+// Paused channels count as playing, so a paused voice is still found
+// ============================================================================
+int AudioSystem::FindVoice(VoiceId voice) const
+{
+	for (size_t i = 0; i < mChannels.size(); i++)
+	{
+		if (mChannels[i].mVoice == voice)
+		{
+			const int channel = static_cast<int>(i);
+			return Mix_Playing(channel) ? channel : -1;
+		}
+	}
+	return -1;
+}
+
+
+// ============================================================================
+// ============================================================================
+void AudioSystem::UpdateMusic()
+{
+	if (mNextMusic && !Mix_PlayingMusic())
+	{
+		FreeMusic(mMusic);
+		mMusic = mNextMusic;
+		mNextMusic = nullptr;
+		Mix_FadeInMusic(mMusic->mMusic, -1, mMusicFadeMS);
+	}
+}
+
+
+// ============================================================================
+// Only the compressed file is held in memory; the mixer decodes a buffer's
+// worth at a time as it plays
+// ============================================================================
+AudioSystem::MusicTrack* AudioSystem::LoadMusic(const std::string& fileName)
+{
+	MusicTrack* track = new MusicTrack();
+	const AssetPack* pack = FileSystem::GetPack();
+	const AssetPackEntry* entry = pack ? pack->Find(fileName) : nullptr;
+	if (entry && pack->GetData(*entry))
+	{
+		// Stored in the pack: stream straight out of its mapping
+		track->mMusic = Mix_LoadMUS_RW(
+			SDL_RWFromConstMem(pack->GetData(*entry), static_cast<int>(entry->mSize)), 1);
+	}
+	else if (entry && FileSystem::ReadFile(fileName, track->mFile))
+	{
+		track->mMusic = Mix_LoadMUS_RW(
+			SDL_RWFromConstMem(track->mFile.data(),
+							   static_cast<int>(track->mFile.size() - 1)), 1);
+	}
+	else
+	{
+		track->mMusic = Mix_LoadMUS(fileName.c_str());
+	}
+
+	if (!track->mMusic)
+	{
+		SDL_Log("Failed to load music %s: %s", fileName.c_str(), SDL_GetError());
+		delete track;
+		return nullptr;
+	}
+	return track;
+}
+
+
+// ============================================================================
+// ============================================================================
+void AudioSystem::FreeMusic(MusicTrack* track)
+{
+	if (track)
+	{
+		Mix_FreeMusic(track->mMusic);
+		delete track;
+	}
+}
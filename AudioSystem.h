@@ -0,0 +1,135 @@
+#pragma once
+#include <atomic>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "SDL/SDL_mixer.h"
+#include "SPSCQueue.h"
+
+// Which voices to cut when every channel is busy: a new sound takes over
+// the channel of the lowest priority (then oldest) voice at or below its
+// own priority, or is dropped if there is none
+enum AudioPriority
+{
+	AudioPriorityLow,
+	AudioPriorityNormal,
+	AudioPriorityHigh
+};
+
+// Owns every SDL_mixer call made after startup. The game thread only
+// queues commands; a thread of the audio system's own applies them, so
+// playing, pausing and stopping sounds never waits on the mixer's lock.
+// Everything public is for the game thread only.
+class AudioSystem
+{
+public:
+	// A sound started by Play, for pausing or stopping it later. 0 is none.
+	typedef unsigned int VoiceId;
+
+	AudioSystem();
+	~AudioSystem();
+
+	// Allocate numVoices mixer channels (the most sounds playing at once)
+	// and start the command thread. Call after Mix_OpenAudio.
+	void Initialize(int numVoices);
+
+	// Apply every queued command, stop the thread and silence everything.
+	// Call before freeing any chunk that might be playing.
+	void Shutdown();
+
+	// Returns at once, even if the voice ends up dropped
+	VoiceId Play(Mix_Chunk* chunk, int loops = 0,
+				 AudioPriority priority = AudioPriorityNormal);
+
+	// Only queues anything when the voice's state actually changes, so it
+	// can be called every frame
+	void SetPaused(VoiceId voice, bool paused);
+
+	void Stop(VoiceId voice);
+
+	// Wait for the audio thread to apply everything queued so far, so no
+	// queued command still points at a chunk about to be freed
+	void Flush();
+
+	// Music streams from its file as it plays rather than being decoded up
+	// front. Starting a different track fades the current one out over
+	// fadeMS and then fades the new one in; the same track keeps playing.
+	void PlayMusic(const std::string& fileName, int fadeMS);
+
+private:
+	AudioSystem(const AudioSystem&) = delete;
+	AudioSystem& operator=(const AudioSystem&) = delete;
+
+	// A streaming music track. SDL_mixer reads a loose track from disk and a
+	// packed one from the pack's mapping, or from mFile if it had to be
+	// decompressed, which then has to stay alive while it plays.
+	struct MusicTrack
+	{
+		Mix_Music* mMusic;
+		std::vector<char> mFile;
+	};
+	static MusicTrack* LoadMusic(const std::string& fileName);
+	static void FreeMusic(MusicTrack* track);
+
+	enum CommandType
+	{
+		CommandPlay,
+		CommandPause,
+		CommandResume,
+		CommandStop,
+		CommandPlayMusic
+	};
+
+	struct Command
+	{
+		CommandType mType;
+		VoiceId mVoice;
+		Mix_Chunk* mChunk;
+		int mLoops;
+		AudioPriority mPriority;
+		MusicTrack* mMusic;
+		int mFadeMS;
+	};
+
+	void Send(const Command& command);
+
+	// Audio thread
+	void ThreadLoop();
+	void Execute(const Command& command);
+	// Channel to play a new voice on, or -1 to drop it
+	int ChooseChannel(AudioPriority priority);
+	// Channel the voice is playing on, or -1 if it has ended
+	int FindVoice(VoiceId voice) const;
+	// Start the queued track once the old one has faded out
+	void UpdateMusic();
+
+	SPSCQueue<Command> mCommands;
+	std::thread mThread;
+	std::atomic<bool> mStopping;
+
+	// Commands queued (game thread) and applied (audio thread), for Flush
+	unsigned int mNumSent;
+	std::atomic<unsigned int> mNumApplied;
+
+	// Game thread state
+	VoiceId mNextVoice;
+	std::unordered_map<VoiceId, bool> mPaused;
+	std::string mMusicName;
+	unsigned int mNumDropped;
+
+	// Audio thread state: what each mixer channel is playing
+	struct Channel
+	{
+		VoiceId mVoice;
+		AudioPriority mPriority;
+		unsigned int mStartOrder;
+	};
+	std::vector<Channel> mChannels;
+	unsigned int mStartOrder;
+
+	// Playing (or fading out), and waiting for it to finish fading
+	MusicTrack* mMusic;
+	MusicTrack* mNextMusic;
+	int mMusicFadeMS;
+};
@@ -3,19 +3,33 @@
 #include "MeshComponent.h"
 #include "Renderer.h"
 #include "CollisionComponent.h"
+#include "Pool.h"
+
+// Backing storage for every Block
+static Pool sBlockPool(sizeof(Block), 1024, MemoryActors);
+
+const char* const Block::MeshFile = "Assets/Cube.gpmesh";
+const float Block::DefaultScale = 64.0f;
 
 
 // ============================================================================
 // ============================================================================
 Block::Block(Game* game)
 :Actor(game)
+,mBlockIndex(0)
 {
-	mMesh = new MeshComponent(this);
-	mMesh->SetMesh(mGame->GetRenderer()->GetMesh("Assets/Cube.gpmesh"));
-	mScale = 64.0f;
-	mCollision = new CollisionComponent(this);
-	mCollision->SetSize(1.0f, 1.0f, 1.0f);
-	mGame->AddBlock(this);
+	SetScale(DefaultScale);
+	CreateComponents(mGame->GetRenderer()->GetMesh(MeshFile));
+}
+
+
+// ============================================================================
+// ============================================================================
+Block::Block(Game* game, size_t transformIndex, Mesh* mesh)
+:Actor(game, transformIndex)
+,mBlockIndex(0)
+{
+	CreateComponents(mesh);
 }
 
 
@@ -25,3 +39,31 @@ Block::~Block()
 {
 	mGame->RemoveBlock(this);
 }
+
+
+// ============================================================================
+// ============================================================================
+void* Block::operator new(size_t size)
+{
+	return sBlockPool.Allocate(size);
+}
+
+
+// ============================================================================
+// ============================================================================
+void Block::operator delete(void* ptr, size_t size)
+{
+	sBlockPool.Free(ptr, size);
+}
+
+
+// ============================================================================
+// ============================================================================
+void Block::CreateComponents(Mesh* mesh)
+{
+	mMesh = new MeshComponent(this);
+	mMesh->SetMesh(mesh);
+	mCollision = new CollisionComponent(this);
+	mCollision->SetSize(1.0f, 1.0f, 1.0f);
+	mGame->AddBlock(this);
+}
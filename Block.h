@@ -5,5 +5,29 @@ class Block : public Actor
 {
 public:
 	Block(class Game* game);
+	
+	// For level loads, which place the transform and look up the mesh ahead
+	// of time for a whole batch of blocks
+	Block(class Game* game, size_t transformIndex, class Mesh* mesh);
 	virtual ~Block();
+	
+	// Mesh every block uses (so a level's assets can be requested ahead of time)
+	static const char* const MeshFile;
+	
+	// Scale a block gets when the level doesn't give one
+	static const float DefaultScale;
+	
+	// Slot in Game's block list
+	size_t GetBlockIndex() const { return mBlockIndex; }
+	void SetBlockIndex(size_t index) { mBlockIndex = index; }
+	
+	// Blocks come from a pool so a level's blocks are contiguous in memory
+	static void* operator new(size_t size);
+	static void operator delete(void* ptr, size_t size);
+	
+private:
+	// Components, shared by both constructors
+	void CreateComponents(class Mesh* mesh);
+	
+	size_t mBlockIndex;
 };
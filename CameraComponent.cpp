@@ -30,11 +30,11 @@ void CameraComponent::Update(float deltaTime)
 		mPitchAngle = Math::PiOver4;
 	}
 	
-	Matrix4 yaw = Matrix4::CreateRotationZ(mOwner->GetRotation());
-	Matrix4 pitch = Matrix4::CreateRotationY(mPitchAngle);
+	Affine3x4 yaw = Affine3x4::CreateRotationZ(mOwner->GetRotation());
+	Affine3x4 pitch = Affine3x4::CreateRotationY(mPitchAngle);
 	
-	Matrix4 rotation = pitch * yaw;
-	Vector3 forward = Vector3::Transform(Vector3::UnitX, rotation);
+	Affine3x4 rotation = pitch * yaw;
+	Vector3 forward = rotation.TransformVector(Vector3::UnitX);
 	Vector3 pos = mOwner->GetPosition();
 	Vector3 target = forward + pos;
 	
@@ -6,6 +6,13 @@
 #include "MeshComponent.h"
 #include "Renderer.h"
 #include "HUD.h"
+#include "Pool.h"
+#include "AudioSystem.h"
+
+// Backing storage for every Checkpoint
+static Pool sCheckpointPool(sizeof(Checkpoint), 256, MemoryActors);
+
+const char* const Checkpoint::MeshFile = "Assets/Checkpoint.gpmesh";
 
 
 // ============================================================================
@@ -19,7 +26,8 @@ Checkpoint::Checkpoint(class Game* game)
 	mCollision = new CollisionComponent(this);
 	mCollision->SetSize(25.0f, 25.0f, 25.0f);
 	mMesh = new MeshComponent(this);
-	mMesh->SetMesh(mGame->GetRenderer()->GetMesh("Assets/Checkpoint.gpmesh"));
+	mMesh->SetMesh(mGame->GetRenderer()->GetMesh(MeshFile));
+	mSound = mGame->GetSoundId("Assets/Sounds/Checkpoint.wav");
 }
 
 
@@ -37,7 +45,7 @@ void Checkpoint::UpdateActor(float deltaTime)
 		}
 		
 		// Active checkpoint
-		Checkpoint* cp = queue.front();
+		Checkpoint* cp = GetGame()->GetActiveCheckpoint();
 		
 		// Update this' mTextTime and if the current checkpoint string has been
 		// shown for more than 5 seconds, erase it from the screen
@@ -69,13 +77,13 @@ void Checkpoint::UpdateActor(float deltaTime)
 		{
 			// Update respawn position to be this checkpoint, remove from queue
 			GetGame()->GetPlayer()->SetRespawnPos(cp->GetPosition());
-			GetGame()->mDeadCheckpoints.push_back(cp);
+			cp->SetState(EDead);
 			queue.pop();
 			
 			// Set the new active checkpoint to blue
 			if (!queue.empty())
 			{
-				queue.front()->mMesh->SetTextureIndex(0);
+				GetGame()->GetActiveCheckpoint()->mMesh->SetTextureIndex(0);
 				GetGame()->GetHUD()->UpdateCheckpointText(cp->mCheckpointString);
 			}
 			else
@@ -85,9 +93,7 @@ void Checkpoint::UpdateActor(float deltaTime)
 			}
 			
 			// Play sound
-			Mix_PlayChannel(-1,
-							mGame->GetSound("Assets/Sounds/Checkpoint.wav"),
-							0);
+			mGame->GetAudio()->Play(mGame->GetSound(mSound), 0, AudioPriorityHigh);
 			
 			// If checkpoint has a level string, set the next level
 			if (cp->mLevelString != "")
@@ -101,3 +107,19 @@ void Checkpoint::UpdateActor(float deltaTime)
 		mMesh->Update(deltaTime);
 	}
 }
+
+
+// ============================================================================
+// ============================================================================
+void* Checkpoint::operator new(size_t size)
+{
+	return sCheckpointPool.Allocate(size);
+}
+
+
+// ============================================================================
+// ============================================================================
+void Checkpoint::operator delete(void* ptr, size_t size)
+{
+	sCheckpointPool.Free(ptr, size);
+}
@@ -1,18 +1,27 @@
 #pragma once
 #include "Actor.h"
+#include "AssetId.h"
 #include <string>
 class Checkpoint : public Actor
 {
 public:
 	Checkpoint(class Game* game);
 	void UpdateActor(float deltaTime) override;
+	
+	// Mesh every checkpoint uses (so a level's assets can be requested ahead of time)
+	static const char* const MeshFile;
 	void SetLevelString(const std::string& level) { mLevelString = level; }
 	void SetCheckpointString(const std::string& string) { mCheckpointString = string; }
 	
+	// Pool allocated, like the other level actors
+	static void* operator new(size_t size);
+	static void operator delete(void* ptr, size_t size);
+	
 	float mTextTime;
 
 private:
 	std::string mLevelString;
 	std::string mCheckpointString;
+	AssetId mSound;
 };
 
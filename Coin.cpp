@@ -5,6 +5,13 @@
 #include "MeshComponent.h"
 #include "Renderer.h"
 #include "HUD.h"
+#include "Pool.h"
+#include "AudioSystem.h"
+
+// Backing storage for every Coin
+static Pool sCoinPool(sizeof(Coin), 256, MemoryActors);
+
+const char* const Coin::MeshFile = "Assets/Coin.gpmesh";
 
 
 // ============================================================================
@@ -16,7 +23,8 @@ Coin::Coin(class Game* game)
 	mCollision = new CollisionComponent(this);
 	mCollision->SetSize(100.0f, 100.0f, 100.0f);
 	mMesh = new MeshComponent(this);
-	mMesh->SetMesh(mGame->GetRenderer()->GetMesh("Assets/Coin.gpmesh"));
+	mMesh->SetMesh(mGame->GetRenderer()->GetMesh(MeshFile));
+	mSound = mGame->GetSoundId("Assets/Sounds/Coin.wav");
 }
 
 
@@ -29,7 +37,7 @@ void Coin::UpdateActor(float deltaTime)
 	if (GetCollision()->Intersect(player->GetCollision()))
 	{
 		SetState(State::EDead);
-		Mix_PlayChannel(-1, mGame->GetSound("Assets/Sounds/Coin.wav"), 0);
+		mGame->GetAudio()->Play(mGame->GetSound(mSound));
 		
 		// Update coin text
 		GetGame()->GetHUD()->UpdateCoinCount();
@@ -39,3 +47,19 @@ void Coin::UpdateActor(float deltaTime)
 	mRotation += Math::Pi * deltaTime;
 	SetRotation(mRotation);
 }
+
+
+// ============================================================================
+// ============================================================================
+void* Coin::operator new(size_t size)
+{
+	return sCoinPool.Allocate(size);
+}
+
+
+// ============================================================================
+// ============================================================================
+void Coin::operator delete(void* ptr, size_t size)
+{
+	sCoinPool.Free(ptr, size);
+}
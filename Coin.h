@@ -1,5 +1,6 @@
 #pragma once
 #include "Actor.h"
+#include "AssetId.h"
 
 class Coin : public Actor
 {
@@ -7,6 +8,14 @@ public:
 	Coin(class Game* game);
 	void UpdateActor(float deltaTime) override;
 	
+	// Mesh every coin uses (so a level's assets can be requested ahead of time)
+	static const char* const MeshFile;
+	
+	// Pool allocated, like the other level actors
+	static void* operator new(size_t size);
+	static void operator delete(void* ptr, size_t size);
+	
 private:
 	float mRotation;
+	AssetId mSound;
 };
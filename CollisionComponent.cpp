@@ -1,5 +1,9 @@
 #include "CollisionComponent.h"
 #include "Actor.h"
+#include "Pool.h"
+
+// Backing storage for every CollisionComponent
+static Pool sCollisionComponentPool(sizeof(CollisionComponent), 1024, MemoryActors);
 
 
 // ============================================================================
@@ -68,8 +72,23 @@ Vector3 CollisionComponent::GetMax() const
 
 // ============================================================================
 // ============================================================================
-const Vector3& CollisionComponent::GetCenter() const
+Vector3 CollisionComponent::GetCenter() const
 {
 	return mOwner->GetPosition();
 }
 
+
+// ============================================================================
+// ============================================================================
+void* CollisionComponent::operator new(size_t size)
+{
+	return sCollisionComponentPool.Allocate(size);
+}
+
+
+// ============================================================================
+// ============================================================================
+void CollisionComponent::operator delete(void* ptr, size_t size)
+{
+	sCollisionComponentPool.Free(ptr, size);
+}
@@ -7,6 +7,10 @@ class CollisionComponent : public Component
 public:
 	CollisionComponent(class Actor* owner);
 	~CollisionComponent();
+	
+	// Pool allocated so collision checks touch contiguous memory
+	static void* operator new(size_t size);
+	static void operator delete(void* ptr, size_t size);
 
 	// Set width/height of this box
 	void SetSize(float width, float height, float depth)
@@ -24,7 +28,7 @@ public:
 	Vector3 GetMax() const;
 
 	// Get width, height, center of box
-	const Vector3& GetCenter() const;
+	Vector3 GetCenter() const;
 	float GetWidth() const { return mWidth; }
 	float GetHeight() const { return mHeight; }
 	float GetDepth() const { return mDepth; }
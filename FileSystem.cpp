@@ -0,0 +1,80 @@
+#include "FileSystem.h"
+#include "AssetPack.h"
+#include <cstdio>
+#include <SDL/SDL_log.h>
+
+AssetPack* FileSystem::sPack = nullptr;
+
+
+// ============================================================================
+// One fread straight into the buffer: no stream buffering, no copies
+// ============================================================================
+bool FileSystem::ReadFile(const std::string& fileName, std::vector<char>& buffer)
+{
+	if (sPack)
+	{
+		if (const AssetPackEntry* entry = sPack->Find(fileName))
+		{
+			const size_t size = static_cast<size_t>(entry->mSize);
+			buffer.resize(size + 1);
+			buffer[size] = '\0';
+			return sPack->Extract(*entry, reinterpret_cast<unsigned char*>(buffer.data()));
+		}
+	}
+
+	FILE* file = fopen(fileName.c_str(), "rb");
+	if (!file)
+	{
+		SDL_Log("File not found: %s", fileName.c_str());
+		return false;
+	}
+
+	long size = -1;
+	if (fseek(file, 0, SEEK_END) == 0)
+	{
+		size = ftell(file);
+		fseek(file, 0, SEEK_SET);
+	}
+	if (size < 0)
+	{
+		SDL_Log("Can't get the size of %s", fileName.c_str());
+		fclose(file);
+		return false;
+	}
+
+	buffer.resize(static_cast<size_t>(size) + 1);
+	const size_t read = fread(buffer.data(), 1, static_cast<size_t>(size), file);
+	fclose(file);
+	if (read != static_cast<size_t>(size))
+	{
+		SDL_Log("Failed reading %s", fileName.c_str());
+		return false;
+	}
+	buffer[read] = '\0';
+	return true;
+}
+
+
+// ============================================================================
+// ============================================================================
+bool FileSystem::Mount(const std::string& packFile)
+{
+	Unmount();
+	AssetPack* pack = new AssetPack();
+	if (!pack->Open(packFile))
+	{
+		delete pack;
+		return false;
+	}
+	sPack = pack;
+	return true;
+}
+
+
+// ============================================================================
+// ============================================================================
+void FileSystem::Unmount()
+{
+	delete sPack;
+	sPack = nullptr;
+}
@@ -0,0 +1,29 @@
+#pragma once
+#include <string>
+#include <vector>
+
+// Every asset read goes through here (or MappedFile, which asks here
+// first). While a pack is mounted, files it holds are served from it and
+// anything else falls through to the loose file on disk.
+class FileSystem
+{
+public:
+	// Read a whole file into buffer, replacing what was there, with a NUL
+	// after the last byte so it can be used as a C string or parsed in
+	// place. The buffer keeps its capacity, so reusing one across files
+	// stops allocating once it's big enough. Logs and returns false if the
+	// file can't be read.
+	static bool ReadFile(const std::string& fileName, std::vector<char>& buffer);
+
+	// Serve files from an asset pack ahead of the loose files. Returns
+	// false, without logging, if there is no pack. Mount before any loads
+	// start and unmount after they've all finished; lookups aren't locked.
+	static bool Mount(const std::string& packFile);
+	static void Unmount();
+
+	// The mounted pack, or nullptr
+	static const class AssetPack* GetPack() { return sPack; }
+
+private:
+	static class AssetPack* sPack;
+};
@@ -2,6 +2,8 @@
 #include "Texture.h"
 #include <vector>
 #include "Game.h"
+#include "FileSystem.h"
+#include "MemoryTracker.h"
 
 Font::Font()
 {
@@ -27,9 +29,19 @@ bool Font::Load(const std::string& fileName)
 		72
 	};
 	
+	if (!FileSystem::ReadFile(fileName, mFile))
+	{
+		mFile.clear();
+		return false;
+	}
+	// Only the file is counted. FreeType's faces and SDL_ttf's glyph caches
+	// are allocated inside those libraries, where we can't see them.
+	MemoryTracker::Add(MemoryFonts, mFile.capacity());
+	
 	for (auto& size : fontSizes)
 	{
-		TTF_Font* font = TTF_OpenFont(fileName.c_str(), size);
+		SDL_RWops* rw = SDL_RWFromConstMem(mFile.data(), static_cast<int>(mFile.size() - 1));
+		TTF_Font* font = TTF_OpenFontRW(rw, 1, size);
 		if (font == nullptr)
 		{
 			SDL_Log("Failed to load font %s in size %d", fileName.c_str(), size);
@@ -46,6 +58,12 @@ void Font::Unload()
 	{
 		TTF_CloseFont(font.second);
 	}
+	mFontData.clear();
+	if (!mFile.empty())
+	{
+		MemoryTracker::Remove(MemoryFonts, mFile.capacity());
+		std::vector<char>().swap(mFile);
+	}
 }
 
 Texture* Font::RenderText(const std::string& text,
@@ -1,6 +1,7 @@
 #pragma once
 #include <string>
 #include <unordered_map>
+#include <vector>
 #include <SDL/SDL_ttf.h>
 #include "Math.h"
 
@@ -21,4 +22,8 @@ public:
 private:
 	// Map of point sizes to font data
 	std::unordered_map<int, TTF_Font*> mFontData;
+	
+	// The font file, read once and shared by every size. SDL_ttf reads
+	// glyphs from it as they're needed, so it has to outlive the fonts.
+	std::vector<char> mFile;
 };
@@ -0,0 +1,91 @@
+#include "FrameAllocator.h"
+#include "MemoryTracker.h"
+#include <SDL/SDL_log.h>
+#include <cstdlib>
+#include <cstdint>
+
+
+// ============================================================================
+// ============================================================================
+FrameAllocator::FrameAllocator(size_t bytesPerFrame)
+	:mCapacity(bytesPerFrame)
+	,mOffset(0)
+	,mPeak(0)
+	,mCurrent(0)
+{
+	mBuffers[0] = static_cast<unsigned char*>(::operator new(mCapacity));
+	mBuffers[1] = static_cast<unsigned char*>(::operator new(mCapacity));
+	MemoryTracker::Add(MemoryFrame, mCapacity * 2);
+}
+
+
+// ============================================================================
+// ============================================================================
+FrameAllocator::~FrameAllocator()
+{
+	FreeOverflow(0);
+	FreeOverflow(1);
+	::operator delete(mBuffers[0]);
+	::operator delete(mBuffers[1]);
+	MemoryTracker::Remove(MemoryFrame, mCapacity * 2);
+}
+
+
+// ============================================================================
+// ============================================================================
+void FrameAllocator::BeginFrame()
+{
+	mCurrent = 1 - mCurrent;
+	mOffset = 0;
+	FreeOverflow(mCurrent);
+}
+
+
+// ============================================================================
+// Bump the offset up to the next aligned address. If the arena is full, fall
+// back to the heap and remember the pointer so it's freed with this buffer.
+// ============================================================================
+void* FrameAllocator::Allocate(size_t size, size_t alignment)
+{
+	const uintptr_t base = reinterpret_cast<uintptr_t>(mBuffers[mCurrent]);
+	const uintptr_t aligned =
+		(base + mOffset + alignment - 1) & ~(static_cast<uintptr_t>(alignment) - 1);
+	const size_t newOffset = static_cast<size_t>(aligned - base) + size;
+
+	if (newOffset > mCapacity)
+	{
+		if (mOverflow[mCurrent].empty())
+		{
+			SDL_Log("Frame allocator full (%u bytes), falling back to the heap",
+					static_cast<unsigned>(mCapacity));
+		}
+		// ::operator new only promises max_align_t alignment, so pad the
+		// block and round up for anything stricter
+		const size_t padding =
+			(alignment > alignof(std::max_align_t)) ? alignment - 1 : 0;
+		void* mem = ::operator new(size + padding);
+		mOverflow[mCurrent].emplace_back(mem);
+		const uintptr_t raw = reinterpret_cast<uintptr_t>(mem);
+		return reinterpret_cast<void*>(
+			(raw + padding) & ~(static_cast<uintptr_t>(alignment) - 1));
+	}
+
+	mOffset = newOffset;
+	if (mOffset > mPeak)
+	{
+		mPeak = mOffset;
+	}
+	return reinterpret_cast<void*>(aligned);
+}
+
+
+// ============================================================================
+// ============================================================================
+void FrameAllocator::FreeOverflow(int buffer)
+{
+	for (auto mem : mOverflow[buffer])
+	{
+		::operator delete(mem);
+	}
+	mOverflow[buffer].clear();
+}
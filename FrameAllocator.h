@@ -0,0 +1,93 @@
+#pragma once
+#include <cstddef>
+#include <new>
+#include <vector>
+#include <string>
+
+// Double-buffered linear allocator for memory that only lives for a frame.
+// Allocations are a pointer bump; nothing is freed individually. BeginFrame
+// flips to the other buffer and resets it, so anything allocated last frame
+// stays valid until the end of this one.
+class FrameAllocator
+{
+public:
+	FrameAllocator(size_t bytesPerFrame);
+	~FrameAllocator();
+
+	// Flip buffers and reset the new current one (call once per frame)
+	void BeginFrame();
+
+	// Get memory that is valid until the next-next BeginFrame
+	void* Allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+
+	// Bytes used in the current frame, and the high water mark so far
+	size_t GetBytesUsed() const { return mOffset; }
+	size_t GetPeakBytesUsed() const { return mPeak; }
+	size_t GetCapacity() const { return mCapacity; }
+
+private:
+	// Free any overflow allocations made into the given buffer
+	void FreeOverflow(int buffer);
+
+	// Two arenas, we hand out of mBuffers[mCurrent]
+	unsigned char* mBuffers[2];
+
+	// Heap allocations made once the arena is full
+	std::vector<void*> mOverflow[2];
+
+	size_t mCapacity;
+	size_t mOffset;
+	size_t mPeak;
+	int mCurrent;
+};
+
+// STL adapter so standard containers can draw from a FrameAllocator.
+// Deallocate is a no-op, the memory goes away when the frame is recycled.
+template <typename T>
+class FrameStdAllocator
+{
+public:
+	typedef T value_type;
+
+	FrameStdAllocator(FrameAllocator* frame)
+		:mFrame(frame)
+	{}
+
+	template <typename U>
+	FrameStdAllocator(const FrameStdAllocator<U>& other)
+		:mFrame(other.GetFrameAllocator())
+	{}
+
+	T* allocate(size_t n)
+	{
+		return static_cast<T*>(mFrame->Allocate(n * sizeof(T), alignof(T)));
+	}
+
+	void deallocate(T* /*p*/, size_t /*n*/)
+	{
+	}
+
+	FrameAllocator* GetFrameAllocator() const { return mFrame; }
+
+	template <typename U>
+	bool operator==(const FrameStdAllocator<U>& other) const
+	{
+		return mFrame == other.GetFrameAllocator();
+	}
+
+	template <typename U>
+	bool operator!=(const FrameStdAllocator<U>& other) const
+	{
+		return mFrame != other.GetFrameAllocator();
+	}
+
+private:
+	FrameAllocator* mFrame;
+};
+
+// Containers for per-frame scratch data
+template <typename T>
+using FrameVector = std::vector<T, FrameStdAllocator<T>>;
+
+typedef std::basic_string<char, std::char_traits<char>,
+	FrameStdAllocator<char>> FrameString;
@@ -6,11 +6,22 @@
 #include "MeshComponent.h"
 #include "Checkpoint.h"
 #include "Arrow.h"
+#include "Player.h"
 #include "HUD.h"
+#include "FrameAllocator.h"
+#include "ScopedTimer.h"
+#include "TransformSystem.h"
+#include "ThreadPool.h"
+#include "SoundBinary.h"
+#include "AssetPath.h"
+#include "FileSystem.h"
+#include "AudioSystem.h"
+#include "MemoryTracker.h"
 #include "SDL/SDL_mixer.h"
 #include <SDL/SDL_ttf.h>
 #include <fstream>
-#include <algorithm>
+#include <cstring>
+#include <chrono>
 
 // Game Window Settings
 static const float sWindowHeight = 1024.0f;
@@ -22,23 +33,38 @@ static const float sFrameDelay = 16.0f;
 static const float sSmallestDeltaTime = 0.05f;
 static const float sDenominator = 1000.0f;
 
+// Size of each of the two per-frame scratch buffers
+static const size_t sFrameAllocatorSize = 1024 * 1024;
+
 // Sound options
 static const int sFrequency = 44100;
 static const int sNumChannels = 2;
 static const int sChunkSize = 2048;
+static const int sMusicFadeMS = 1000;
+// Most sounds playing at once; past that the audio system steals voices
+static const int sNumVoices = 16;
 
 
 // ============================================================================
 // Basic construction for the game object that uses only an initialization list
 // ============================================================================
 Game::Game()
-	:mPlayer(nullptr)
+	:mAssetScope(AssetRefs::SessionScope)
+	,mNextAssetScope(AssetRefs::SessionScope + 1)
+	,mFreeSlot(0)
 	,mRenderer(nullptr)
+	,mFrameAllocator(nullptr)
+	,mThreadPool(nullptr)
+	,mTransforms(nullptr)
 	,mHUD(nullptr)
+	,mAudio(nullptr)
 	,mTicksCount(0)
 	,mLastCheckpointTimer(0.0f)
 	,mIsRunning(true)
 {
+	// Reserve slot 0 so a null handle never resolves to an actor
+	ActorSlot nullSlot = { nullptr, 0, 0 };
+	mActorSlots.emplace_back(nullSlot);
 }
 
 
@@ -53,6 +79,10 @@ bool Game::Initialize()
 		return false;
 	}
 
+	mFrameAllocator = new FrameAllocator(sFrameAllocatorSize);
+	mThreadPool = new ThreadPool();
+	mTransforms = new TransformSystem();
+
 	mRenderer = new Renderer(this);
 	if (!mRenderer->Initialize(sWindowHeight, sWindowWidth))
 	{
@@ -65,6 +95,8 @@ bool Game::Initialize()
 		SDL_Log("Unable to initialize SDL Audio: %s", SDL_GetError());
 		return false;
 	}
+	mAudio = new AudioSystem();
+	mAudio->Initialize(sNumVoices);
 	
 	if (SDL_SetRelativeMouseMode(SDL_TRUE))
 	{
@@ -84,7 +116,12 @@ bool Game::Initialize()
 		return false;
 	}
 
-	if (!LoadData())
+	bool loaded = false;
+	{
+		ScopedTimer timer("Startup load");
+		loaded = LoadData();
+	}
+	if (!loaded)
 	{
 		SDL_Log("Unable to load the level: %s", SDL_GetError());
 		return false;
@@ -94,12 +131,42 @@ bool Game::Initialize()
 }
 
 
+// ============================================================================
+// The same systems Initialize creates, less the ones that need a window
+// ============================================================================
+void Game::InitializeHeadless()
+{
+	mFrameAllocator = new FrameAllocator(sFrameAllocatorSize);
+	mThreadPool = new ThreadPool();
+	mTransforms = new TransformSystem();
+	mRenderer = new Renderer(this);
+}
+
+
+// ============================================================================
+// Nothing was uploaded, so the renderer's assets only need freeing
+// ============================================================================
+void Game::ShutdownHeadless()
+{
+	UnloadData();
+	delete mThreadPool;
+	mThreadPool = nullptr;
+	mRenderer->UnloadData();
+	delete mRenderer;
+	delete mTransforms;
+	delete mFrameAllocator;
+}
+
+
 // ============================================================================
 // ============================================================================
 void Game::RunLoop()
 {
 	while (mIsRunning)
 	{
+		// Recycle the scratch memory from two frames ago
+		mFrameAllocator->BeginFrame();
+
 		// Step 1: Process all received input since the last frame
 		ProcessInput();
 
@@ -129,6 +196,13 @@ void Game::ProcessInput()
 			case SDL_QUIT:
 				mIsRunning = false;
 				break;
+			case SDL_KEYDOWN:
+				if (event.key.keysym.scancode == SDL_SCANCODE_F1 && !event.key.repeat)
+				{
+					LogAssetMemory();
+					MemoryTracker::Dump("on request");
+				}
+				break;
 		}
 	}
 	
@@ -151,6 +225,9 @@ void Game::ProcessInput()
 // ============================================================================
 void Game::UpdateGame()
 {
+	// Pick up any level staged in the background
+	UpdateStagedLevels();
+
 	// Compute delta time
 	// Wait until 16ms has elapsed since last frame (hard cap on FPS)
 	while (!SDL_TICKS_PASSED(SDL_GetTicks(), mTicksCount + sFrameDelay)) {}
@@ -161,7 +238,8 @@ void Game::UpdateGame()
 	
 	// Make copy of actor vector
 	// (iterate over this in case any new actors are created)
-	std::vector<Actor*> copy = mActors;
+	const FrameStdAllocator<Actor*> frameAlloc(mFrameAllocator);
+	FrameVector<Actor*> copy(mActors.begin(), mActors.end(), frameAlloc);
 	
 	// Update all actors
 	for (auto actor : copy)
@@ -172,29 +250,20 @@ void Game::UpdateGame()
 	// Update the HUD
 	mHUD->Update(deltaTime);
 
-	// Add any dead actors to a temp vector
-	std::vector<Actor*> deadActors;
-	for (auto actor : mActors)
+	// Sync point: delete every actor that died this frame (which will remove
+	// them from mActors). Index loop since a destructor may kill more actors.
+	for (size_t i = 0; i < mPendingDestroy.size(); i++)
 	{
-		if (actor->GetState() == Actor::EDead)
+		Actor* actor = GetActor(mPendingDestroy[i]);
+		if (actor)
 		{
-			deadActors.emplace_back(actor);
+			delete actor;
 		}
 	}
-
-	// Delete any of the dead actors (which will remove them from mActors)
-	for (auto actor : deadActors)
-	{
-		delete actor;
-	}
+	mPendingDestroy.clear();
 	
-	// Mark any checkpoints the player collided with for deletion
-	for (auto cp : mDeadCheckpoints)
-	{
-		cp->SetState(Actor::EDead);
-		mDeadCheckpoints.erase(std::find(mDeadCheckpoints.begin(),
-										 mDeadCheckpoints.end(), cp));
-	}
+	// Rebuild the world matrices of anything that moved this frame
+	mTransforms->Update();
 }
 
 
@@ -211,13 +280,13 @@ void Game::GenerateOutput()
 // ============================================================================
 bool Game::LoadData()
 {
-	// Load sounds
-	GetSound("Assets/Sounds/Checkpoint.wav");
-	GetSound("Assets/Sounds/Coin.wav");
-	GetSound("Assets/Sounds/Jump.wav");
-	GetSound("Assets/Sounds/Land.wav");
-	GetSound("Assets/Sounds/Music.ogg");
-	GetSound("Assets/Sounds/Running.wav");
+	// Load sounds in the background while the level loads. Every level
+	// uses these, so they're taken for the session.
+	GetSoundId("Assets/Sounds/Checkpoint.wav");
+	GetSoundId("Assets/Sounds/Coin.wav");
+	GetSoundId("Assets/Sounds/Jump.wav");
+	GetSoundId("Assets/Sounds/Land.wav");
+	GetSoundId("Assets/Sounds/Running.wav");
 	
 	Matrix4 mat4 =
 		Matrix4::CreatePerspectiveFOV(sFovY, sWindowHeight, sWindowWidth, 
@@ -228,23 +297,25 @@ bool Game::LoadData()
 	mRenderer->SetViewMatrix(mat4);
 	
 	// Level file
-	if (!LevelLoader::Load(this, "Assets/Tutorial.json"))
+	BeginLevelScope();
+	if (!LoadLevel("Assets/Tutorial.json"))
 	{
 		SDL_Log("Unable to load level: %s", SDL_GetError());
 		return false;
 	}
 	
 	// Set first checkpoint to blue (0)
-	mCheckpoints.front()->GetMesh()->SetTextureIndex(0);
+	GetActiveCheckpoint()->GetMesh()->SetTextureIndex(0);
 	
 	// Arrow pointing towards active checkpoint
 	Arrow* arrow = new Arrow(this);
 	
 	// Start the level music, loop forever
-	Mix_PlayChannel(-1, GetSound("Assets/Sounds/Music.ogg"), -1);
+	mAudio->PlayMusic("Assets/Sounds/Music.ogg", sMusicFadeMS);
 	
 	// HUD
 	mHUD = new HUD(this);
+	MemoryTracker::Dump(("loaded " + mLevel).c_str());
 	return true;
 }
 
@@ -254,12 +325,8 @@ bool Game::LoadData()
 void Game::UnloadData()
 {
 	// Delete actors
-	// Because ~Actor calls RemoveActor, have to use a different style loop
-	while (!mActors.empty())
-	{
-		delete mActors.back();
-	}
-	mActors.clear();
+	DestroyAllActors();
+	ClearStagedLevels();
 
 	// Destroy textures
 	for (auto i : mTextures)
@@ -268,35 +335,220 @@ void Game::UnloadData()
 	}
 	mTextures.clear();
 
-	// Destroy sounds
-	for (auto s : mSounds)
+	// Stop the audio thread first, it may still be playing any of the sounds
+	if (mAudio)
 	{
-		Mix_FreeChunk(s.second);
+		mAudio->Shutdown();
+	}
+
+	// Destroy sounds, waiting out any still loading
+	for (auto& s : mSounds)
+	{
+		Mix_Chunk* chunk = s.get();
+		if (chunk)
+		{
+			MemoryTracker::Remove(MemorySounds, chunk->alen);
+			Mix_FreeChunk(chunk);
+		}
 	}
 	mSounds.clear();
+	mSoundIds.clear();
+	mSoundRefs.clear();
+	mScopeSounds.clear();
 }
 
 
 // ============================================================================
 // ============================================================================
-Mix_Chunk* Game::GetSound(const std::string& fileName)
+AssetId Game::GetSoundId(const std::string& fileName)
 {
-	Mix_Chunk* chunk = nullptr;
-	auto it = mSounds.find(fileName);
-	if (it != mSounds.end())
+	AssetId id;
+	auto it = mSoundIds.find(fileName);
+	if (it != mSoundIds.end())
 	{
-		chunk = it->second;
+		id = it->second;
 	}
 	else
 	{
-		chunk = Mix_LoadWAV(fileName.c_str());
-		if (!chunk)
+		id = AssetId(static_cast<unsigned int>(mSounds.size()));
+		mSounds.emplace_back(mThreadPool->Async([fileName]() {
+			return LoadSound(fileName);
+		}).share());
+		mSoundRefs.emplace_back();
+		mSoundIds.emplace(fileName, id);
+	}
+
+	if (mSoundRefs[id.GetIndex()].AddScopeRef(mAssetScope))
+	{
+		ScopeRef<AssetId> ref = { mAssetScope, id };
+		mScopeSounds.emplace_back(ref);
+	}
+	return id;
+}
+
+
+// ============================================================================
+// ============================================================================
+unsigned int Game::BeginLevelScope()
+{
+	const unsigned int previous = mAssetScope;
+	mAssetScope = mNextAssetScope++;
+	mRenderer->SetAssetScope(mAssetScope);
+	return previous;
+}
+
+
+// ============================================================================
+// A sound is only freed once it has finished loading, and after the audio
+// thread has caught up, since a queued play may still point at it
+// ============================================================================
+void Game::ReleaseLevelScope(unsigned int scope)
+{
+	if (scope == AssetRefs::SessionScope)
+	{
+		return;
+	}
+	mRenderer->ReleaseAssetScope(scope);
+
+	for (size_t i = 0; i < mScopeSounds.size(); )
+	{
+		if (mScopeSounds[i].mScope == scope)
 		{
-			SDL_Log("Failed to load sound file %s", fileName.c_str());
-			return nullptr;
+			mSoundRefs[mScopeSounds[i].mAsset.GetIndex()].mCount--;
+			mScopeSounds[i] = mScopeSounds.back();
+			mScopeSounds.pop_back();
 		}
-		mSounds.emplace(fileName, chunk);
+		else
+		{
+			i++;
+		}
+	}
+
+	unsigned int numSounds = 0;
+	for (size_t i = 0; i < mSounds.size(); i++)
+	{
+		if (mSoundRefs[i].mCount > 0 ||
+			mSounds[i].wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+		{
+			continue;
+		}
+		Mix_Chunk* chunk = mSounds[i].get();
+		if (chunk == nullptr)
+		{
+			continue;
+		}
+		if (numSounds == 0)
+		{
+			mAudio->Flush();
+		}
+		// Halts any channel still playing it
+		MemoryTracker::Remove(MemorySounds, chunk->alen);
+		Mix_FreeChunk(chunk);
+		std::promise<Mix_Chunk*> evicted;
+		evicted.set_value(nullptr);
+		mSounds[i] = evicted.get_future().share();
+		for (auto it = mSoundIds.begin(); it != mSoundIds.end(); ++it)
+		{
+			if (it->second.GetIndex() == i)
+			{
+				mSoundIds.erase(it);
+				break;
+			}
+		}
+		numSounds++;
+	}
+	if (numSounds > 0)
+	{
+		SDL_Log("Evicted %u sounds", numSounds);
+	}
+}
+
+
+// ============================================================================
+// Sounds still loading aren't counted
+// ============================================================================
+void Game::LogAssetMemory()
+{
+	SDL_Log("Asset memory:");
+	mRenderer->LogAssetMemory();
+	unsigned int numSounds = 0;
+	size_t soundBytes = 0;
+	for (auto& s : mSounds)
+	{
+		if (s.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+		{
+			continue;
+		}
+		Mix_Chunk* chunk = s.get();
+		if (chunk)
+		{
+			numSounds++;
+			soundBytes += chunk->alen;
+		}
+	}
+	SDL_Log("  sounds   %4u  %8.1f KB RAM", numSounds, soundBytes / 1024.0);
+}
+
+
+// ============================================================================
+// ============================================================================
+Mix_Chunk* Game::LoadSound(const std::string& fileName)
+{
+	Mix_Chunk* chunk = LoadCookedSound(fileName);
+	std::vector<char> file;
+	if (!chunk && FileSystem::ReadFile(fileName, file))
+	{
+		// Mix_LoadWAV_RW decodes the whole sound, so the file can go after
+		chunk = Mix_LoadWAV_RW(SDL_RWFromConstMem(file.data(),
+												  static_cast<int>(file.size() - 1)), 1);
+	}
+	if (!chunk)
+	{
+		SDL_Log("Failed to load sound file %s", fileName.c_str());
+	}
+	else
+	{
+		MemoryTracker::Add(MemorySounds, chunk->alen);
+	}
+	return chunk;
+}
+
+
+// ============================================================================
+// A cooked sound is only usable if the mixer opened with the format it was
+// decoded to. The chunk must own its samples, so they're copied out of the
+// mapping into SDL_malloc memory that Mix_FreeChunk releases.
+// ============================================================================
+Mix_Chunk* Game::LoadCookedSound(const std::string& fileName)
+{
+	const std::string cooked = AssetPath::GetCooked(fileName, AssetPath::SoundSuffix);
+	SoundBinary binary;
+	if (cooked.empty() || !binary.Open(cooked))
+	{
+		return nullptr;
+	}
+
+	int frequency = 0;
+	Uint16 format = 0;
+	int channels = 0;
+	Mix_QuerySpec(&frequency, &format, &channels);
+	if (binary.GetFrequency() != frequency || binary.GetFormat() != format ||
+		binary.GetChannels() != channels)
+	{
+		SDL_Log("Cooked sound %s doesn't match the mixer format, recook it",
+				cooked.c_str());
+		return nullptr;
+	}
+
+	Uint8* samples = static_cast<Uint8*>(SDL_malloc(binary.GetNumBytes()));
+	memcpy(samples, binary.GetSamples(), binary.GetNumBytes());
+	Mix_Chunk* chunk = Mix_QuickLoad_RAW(samples, binary.GetNumBytes());
+	if (!chunk)
+	{
+		SDL_free(samples);
+		return nullptr;
 	}
+	chunk->allocated = 1;
 	return chunk;
 }
 
@@ -306,9 +558,16 @@ Mix_Chunk* Game::GetSound(const std::string& fileName)
 void Game::Shutdown()
 {
 	UnloadData();
+	// Stop the loaders before the renderer they upload to goes away
+	delete mThreadPool;
+	mThreadPool = nullptr;
+	delete mAudio;
+	mAudio = nullptr;
 	Mix_CloseAudio();
 	mRenderer->Shutdown();
 	delete mRenderer;
+	delete mTransforms;
+	delete mFrameAllocator;
 	SDL_Quit();
 }
 
@@ -317,34 +576,245 @@ void Game::Shutdown()
 // ============================================================================
 void Game::AddActor(Actor* actor)
 {
+	actor->SetGameIndex(mActors.size());
 	mActors.emplace_back(actor);
+
+	// Hand out a handle table slot, reusing a free one if there is one
+	unsigned int index = mFreeSlot;
+	if (index != 0)
+	{
+		mFreeSlot = mActorSlots[index].mNextFree;
+	}
+	else
+	{
+		index = static_cast<unsigned int>(mActorSlots.size());
+		ActorSlot slot = { nullptr, 1, 0 };
+		mActorSlots.emplace_back(slot);
+	}
+	mActorSlots[index].mActor = actor;
+	actor->SetHandle(ActorHandle(index, mActorSlots[index].mGeneration));
 }
 
 
 // ============================================================================
+// Swap the last actor into this one's slot and pop off the end. If the slot
+// doesn't hold this actor, the list was already cleared in bulk.
 // ============================================================================
 void Game::RemoveActor(Actor* actor)
 {
-	auto it = std::find(mActors.begin(), mActors.end(), actor);
-	if (it != mActors.end())
+	ReleaseHandle(actor->GetHandle());
+
+	const size_t index = actor->GetGameIndex();
+	if (index < mActors.size() && mActors[index] == actor)
 	{
-		// Swap to end of vector and pop off (avoid erasing copies)
-		auto it2 = mActors.end() - 1;
-		std::iter_swap(it, it2);
+		Actor* last = mActors.back();
+		mActors[index] = last;
+		last->SetGameIndex(index);
 		mActors.pop_back();
 	}
 }
 
 
 // ============================================================================
+// Every actor has a transform and a mesh, so size those along with the lists
+// ============================================================================
+void Game::ReserveActors(size_t numActors, size_t numBlocks)
+{
+	const size_t total = mActors.size() + numActors;
+	mActors.reserve(total);
+	mActorSlots.reserve(mActorSlots.size() + numActors);
+	mBlocks.reserve(mBlocks.size() + numBlocks);
+	mTransforms->Reserve(mTransforms->GetNumTransforms() + numActors);
+	mRenderer->ReserveMeshComps(total);
+}
+
+
+// ============================================================================
+// ============================================================================
+void Game::AddBlock(Block* block)
+{
+	block->SetBlockIndex(mBlocks.size());
+	mBlocks.emplace_back(block);
+}
+
+
+// ============================================================================
+// Same swap and pop as RemoveActor
 // ============================================================================
 void Game::RemoveBlock(Block* block)
 {
-	auto it = std::find(mBlocks.begin(), mBlocks.end(), block);
-	if (it != mBlocks.end())
+	const size_t index = block->GetBlockIndex();
+	if (index < mBlocks.size() && mBlocks[index] == block)
+	{
+		Block* last = mBlocks.back();
+		mBlocks[index] = last;
+		last->SetBlockIndex(index);
+		mBlocks.pop_back();
+	}
+}
+
+
+// ============================================================================
+// Take the whole actor list and clear the block/mesh registries up front, so
+// the destructors' remove calls are no-ops and teardown is linear
+// ============================================================================
+void Game::DestroyAllActors()
+{
+	std::vector<Actor*> actors;
+	actors.swap(mActors);
+	mBlocks.clear();
+	mRenderer->ClearMeshComps();
+	mTransforms->Clear();
+	mPendingDestroy.clear();
+
+	for (auto actor : actors)
+	{
+		delete actor;
+	}
+}
+
+
+// ============================================================================
+// The staged read is swapped in if it's there (waiting for it if it's still
+// running). Staged levels that weren't picked are stale and dropped.
+// ============================================================================
+bool Game::LoadLevel(const std::string& fileName)
+{
+	LevelSource* source = nullptr;
+	auto it = mStagedLevels.find(fileName);
+	if (it != mStagedLevels.end())
+	{
+		StagedLevel& staged = it->second;
+		source = staged.mFuture.valid() ? staged.mFuture.get() : staged.mSource;
+		staged.mSource = nullptr;
+		mStagedLevels.erase(it);
+	}
+	ClearStagedLevels();
+
+	if (source == nullptr)
+	{
+		source = LevelLoader::Read(fileName);
+		if (source == nullptr)
+		{
+			return false;
+		}
+	}
+
+	const LevelView view = source->GetView();
+	LevelLoader::Instantiate(this, view);
+	mLevel = fileName;
+
+	std::vector<std::string> linked;
+	LevelLoader::GetLinkedLevels(view, linked);
+	for (const auto& level : linked)
+	{
+		if (mStagedLevels.find(level) == mStagedLevels.end())
+		{
+			StagedLevel staged;
+			// The renderer's caches are thread safe, so the level's assets
+			// are requested from the worker as soon as it has been read
+			staged.mFuture = mThreadPool->Async([this, level]() {
+				LevelSource* source = LevelLoader::Read(level);
+				if (source)
+				{
+					LevelLoader::Prewarm(this, source->GetView());
+				}
+				return source;
+			});
+			staged.mSource = nullptr;
+			mStagedLevels.emplace(level, std::move(staged));
+		}
+	}
+
+	delete source;
+	return true;
+}
+
+
+// ============================================================================
+// ============================================================================
+void Game::UpdateStagedLevels()
+{
+	for (auto& it : mStagedLevels)
+	{
+		StagedLevel& staged = it.second;
+		if (staged.mFuture.valid() &&
+			staged.mFuture.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+		{
+			staged.mSource = staged.mFuture.get();
+		}
+	}
+}
+
+
+// ============================================================================
+// ============================================================================
+void Game::ClearStagedLevels()
+{
+	for (auto& it : mStagedLevels)
+	{
+		StagedLevel& staged = it.second;
+		delete (staged.mFuture.valid() ? staged.mFuture.get() : staged.mSource);
+	}
+	mStagedLevels.clear();
+}
+
+
+// ============================================================================
+// ============================================================================
+void Game::DestroyActor(Actor* actor)
+{
+	mPendingDestroy.emplace_back(actor->GetHandle());
+}
+
+
+// ============================================================================
+// Bump the generation (skipping 0, which means null) so outstanding handles
+// stop resolving, and push the slot onto the free list
+// ============================================================================
+void Game::ReleaseHandle(ActorHandle handle)
+{
+	ActorSlot& slot = mActorSlots[handle.GetIndex()];
+	if (handle.IsNull() || slot.mGeneration != handle.GetGeneration())
+	{
+		return;
+	}
+
+	slot.mActor = nullptr;
+	if (++slot.mGeneration == 0)
+	{
+		slot.mGeneration = 1;
+	}
+	slot.mNextFree = mFreeSlot;
+	mFreeSlot = handle.GetIndex();
+}
+
+
+// ============================================================================
+// ============================================================================
+Player* Game::GetPlayer() const
+{
+	return GetActor<Player>(mPlayer);
+}
+
+
+// ============================================================================
+// ============================================================================
+void Game::SetPlayer(Player* player)
+{
+	mPlayer = player->GetHandle();
+}
+
+
+// ============================================================================
+// ============================================================================
+Checkpoint* Game::GetActiveCheckpoint() const
+{
+	if (mCheckpoints.empty())
 	{
-		mBlocks.erase(it);
+		return nullptr;
 	}
+	return GetActor<Checkpoint>(mCheckpoints.front());
 }
 
 
@@ -352,10 +822,17 @@ void Game::RemoveBlock(Block* block)
 // ============================================================================
 bool Game::LoadNextLevel()
 {
+	// The whole transition is one frame's hitch
+	const bool staged = mStagedLevels.find(mNextLevel) != mStagedLevels.end();
+	ScopedTimer transitionTimer(staged ? "Level transition (staged)" :
+								"Level transition (not staged)");
+	
+	MemoryTracker::Dump(("unloading " + mLevel).c_str());
+	
 	// Delete all the actors in the current level
-	while (!mActors.empty())
 	{
-		delete mActors.back();
+		ScopedTimer timer("Level teardown");
+		DestroyAllActors();
 	}
 	
 	// Clear out the checkpoint queue (just in case)
@@ -364,19 +841,31 @@ bool Game::LoadNextLevel()
 		mCheckpoints.pop();
 	}
 	
-	// Call LevelLoader::Load on mNextLevel
-	if (!LevelLoader::Load(this, mNextLevel))
+	// Build mNextLevel
+	const unsigned int previousScope = BeginLevelScope();
 	{
-		SDL_Log("Unable to load next level: %s", SDL_GetError());
-		return false;
+		ScopedTimer timer("Level load");
+		if (!LoadLevel(mNextLevel))
+		{
+			SDL_Log("Unable to load next level: %s", SDL_GetError());
+			return false;
+		}
 	}
 	
 	// Activate the first checkpoint
-	mCheckpoints.front()->GetMesh()->SetTextureIndex(0);
+	GetActiveCheckpoint()->GetMesh()->SetTextureIndex(0);
 	
 	// Allocate a new Arrow actor (since the old one got deleted)
 	Arrow* arrow = new Arrow(this);
 	
+	// Only now that everything in the new level has its assets can the
+	// ones only the old level used go
+	{
+		ScopedTimer timer("Asset eviction");
+		ReleaseLevelScope(previousScope);
+	}
+	MemoryTracker::Dump(("loaded " + mLevel).c_str());
+	
 	// mNextLevel.clear() (so we don’t try to change the level again on the next frame)
 	mNextLevel.clear();
 	return true;
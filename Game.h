@@ -5,7 +5,11 @@
 #include <string>
 #include <vector>
 #include <queue>
+#include <future>
 #include "Math.h"
+#include "ActorHandle.h"
+#include "AssetId.h"
+#include "AssetRefs.h"
 
 class Game
 {
@@ -15,28 +19,81 @@ public:
 	void RunLoop();
 	void Shutdown();
 
+	// Only what building and tearing down levels needs, for Tools/LevelBench:
+	// no window, GL, audio or input. Meshes and textures are read on the
+	// thread pool but never uploaded.
+	void InitializeHeadless();
+	void ShutdownHeadless();
+
+	// Delete every actor, clearing the registries in one pass first
+	void DestroyAllActors();
+
 	// Actors
 	void AddActor(class Actor* actor);
 	void RemoveActor(class Actor* actor);
+	
+	// Make room for this many more actors (of which numBlocks are blocks)
+	// before a level creates them
+	void ReserveActors(size_t numActors, size_t numBlocks);
+	
+	// Resolve a handle, or nullptr if that actor has been destroyed
+	class Actor* GetActor(ActorHandle handle) const
+	{
+		const ActorSlot& slot = mActorSlots[handle.GetIndex()];
+		return (slot.mGeneration == handle.GetGeneration()) ? slot.mActor : nullptr;
+	}
+	
+	template <typename T>
+	T* GetActor(ActorHandle handle) const
+	{
+		return static_cast<T*>(GetActor(handle));
+	}
+	
+	// Queue an actor to be deleted at the end of this frame's update
+	void DestroyActor(class Actor* actor);
+
+	// Id for a sound (the cooked <fileName>.pcm if there is one), starting
+	// it loading on the thread pool the first time it's asked for. Hashes
+	// the name, so look ids up when creating things, not every frame. The
+	// current level scope takes a reference on it (see AssetRefs).
+	AssetId GetSoundId(const std::string& fileName);
+	
+	// Waits if the sound is still loading. nullptr for a null id or a sound
+	// that failed to load or has been evicted.
+	Mix_Chunk* GetSound(AssetId id)
+	{
+		return id.IsNull() ? nullptr : mSounds[id.GetIndex()].get();
+	}
 
-	// Sound
-	Mix_Chunk* GetSound(const std::string& fileName);
+	// Every sound and music call goes through here rather than to SDL_mixer
+	class AudioSystem* GetAudio() const { return mAudio; }
 
 	// Rendenrer
 	class Renderer* GetRenderer() {	return mRenderer; }
 	
+	// Every actor's position/rotation/scale and world matrix
+	class TransformSystem* GetTransforms() const { return mTransforms; }
+	
+	// Scratch memory that is recycled every frame
+	class FrameAllocator* GetFrameAllocator() const { return mFrameAllocator; }
+	
+	// Worker threads for loading
+	class ThreadPool* GetThreadPool() const { return mThreadPool; }
+	
 	// Blocks
-	void AddBlock(class Block *block) { mBlocks.emplace_back(block); }
+	void AddBlock(class Block* block);
 	void RemoveBlock(class Block* block);
-	std::vector<class Block*> GetBlocks() const { return mBlocks; }
+	const std::vector<class Block*>& GetBlocks() const { return mBlocks; }
 	
 	// Player
-	class Player* GetPlayer() const { return mPlayer; }
-	void SetPlayer(class Player* player) { mPlayer = player; }
+	class Player* GetPlayer() const;
+	void SetPlayer(class Player* player);
 	
 	// Queue of checkpoints
-	std::queue<class Checkpoint*> mCheckpoints;
-	std::vector<class Checkpoint*> mDeadCheckpoints;
+	std::queue<ActorHandle> mCheckpoints;
+	
+	// Front of the checkpoint queue (nullptr if there isn't one)
+	class Checkpoint* GetActiveCheckpoint() const;
 	
 	// Level
 	void SetNextLevel(const std::string& level) { mNextLevel = level; }
@@ -44,6 +101,10 @@ public:
 	// HUD
 	class HUD* GetHUD() const { return mHUD; }
 	
+	// Count and size of every loaded texture, mesh and sound (on F1, along
+	// with the MemoryTracker's figures)
+	void LogAssetMemory();
+	
 	// Checkpoints
 	float GetLastCheckpointTimer() { return mLastCheckpointTimer; }
 	void AddToLastCheckpointTimer(float time) { mLastCheckpointTimer += time; }
@@ -56,19 +117,91 @@ private:
 	bool LoadData();
 	void UnloadData();
 	bool LoadNextLevel();
-
-	// Hash table of textures / sounds
+	
+	// Load a level, taking its staged copy if there is one, then start
+	// staging the levels its checkpoints lead to
+	bool LoadLevel(const std::string& fileName);
+	
+	// Make a new scope current for the next level's assets, returning the
+	// one it replaces
+	unsigned int BeginLevelScope();
+	
+	// Drop a level's asset references once the next level is built, then
+	// evict the textures, meshes and sounds nothing uses any more
+	void ReleaseLevelScope(unsigned int scope);
+	
+	// Collect staged levels whose read has finished
+	void UpdateStagedLevels();
+	
+	// Drop every staged level (waiting out reads still in flight)
+	void ClearStagedLevels();
+	
+	// Load a sound's pre-decoded samples, or nullptr if it isn't cooked
+	static Mix_Chunk* LoadCookedSound(const std::string& fileName);
+	
+	// Cooked or source, run on a worker
+	static Mix_Chunk* LoadSound(const std::string& fileName);
+	
+	// Hash table of textures
 	std::unordered_map<std::string, SDL_Texture*> mTextures;
-	std::unordered_map<std::string, Mix_Chunk*> mSounds;
+	
+	// Sounds indexed by AssetId, and the ids by name
+	std::vector<std::shared_future<Mix_Chunk*>> mSounds;
+	std::unordered_map<std::string, AssetId> mSoundIds;
+	
+	// References on each sound, and the ones each scope holds. An evicted
+	// sound's slot is left resolving to nullptr and never reused, so stale
+	// ids stay harmless.
+	std::vector<AssetRefs> mSoundRefs;
+	std::vector<ScopeRef<AssetId>> mScopeSounds;
+	
+	// Current level scope, and the next one to hand out
+	unsigned int mAssetScope;
+	unsigned int mNextAssetScope;
+	
+
+	// Free a handle table slot, invalidating every handle to it
+	void ReleaseHandle(ActorHandle handle);
 
 	// All the actors / blocks in the game
 	std::vector<class Actor*> mActors;
 	std::vector<class Block*> mBlocks;
 	
+	// Handle table. Slot 0 is never handed out, so null handles resolve to
+	// nullptr without a bounds check.
+	struct ActorSlot
+	{
+		class Actor* mActor;
+		unsigned int mGeneration;
+		unsigned int mNextFree;
+	};
+	std::vector<ActorSlot> mActorSlots;
+	unsigned int mFreeSlot;
+	
+	// Actors that died this frame
+	std::vector<ActorHandle> mPendingDestroy;
+	
 	std::string mNextLevel;
-	class Player* mPlayer;
+	
+	// The level being played
+	std::string mLevel;
+	
+	// Levels reachable from the current one, read on the thread pool while
+	// it's being played so the transition only has to build actors
+	struct StagedLevel
+	{
+		std::future<struct LevelSource*> mFuture;
+		// Set once the future has been collected
+		struct LevelSource* mSource;
+	};
+	std::unordered_map<std::string, StagedLevel> mStagedLevels;
+	ActorHandle mPlayer;
 	class Renderer* mRenderer;
+	class FrameAllocator* mFrameAllocator;
+	class ThreadPool* mThreadPool;
+	class TransformSystem* mTransforms;
 	class HUD* mHUD;
+	class AudioSystem* mAudio;
 	Uint32 mTicksCount;
 	float mLastCheckpointTimer;
 	bool mIsRunning;
@@ -4,9 +4,15 @@
 #include "Game.h"
 #include "Renderer.h"
 #include "Font.h"
+#include "FrameAllocator.h"
 #include <sstream>
 #include <iomanip>
 #include <math.h>
+#include <stdio.h>
+
+// Where the timer and coin count sit, relative to the screen center
+static constexpr Vector2 sTimerOffset(-420.0f, -315.0f);
+static constexpr Vector2 sCoinOffset(-449.0f, -285.0f);
 
 
 // ============================================================================
@@ -54,10 +60,6 @@ void HUD::Update(float deltaTime)
 	mTimerText->Unload();
 	delete mTimerText;
 	
-	// For the new mTimerText
-	std::string time;
-	std::stringstream ss;
-	
 	// Split the lhs and rhs of mTimer
 	float flhs = 0.0f;
 	float frhs = 0.0f;
@@ -80,29 +82,12 @@ void HUD::Update(float deltaTime)
 		sec %= 60;
 	}
 	
-	// If we need to add leading 0-s
-	const bool minZeros = (min < 10) ? true : false;
-	const bool secZeros = (sec < 10) ? true : false;
-	const bool msZeros = (ms < 10) ? true : false;
-	
-	if (minZeros)
-	{
-		ss << "0";
-	}
-	ss << min << ":";
-	
-	if (secZeros)
-	{
-		ss << "0";
-	}
-	ss << sec << ".";
-	
-	if (msZeros)
-	{
-		ss << "0";
-	}
-	ss << ms;
-	time = ss.str();
+	// Format mm:ss.ms (with leading 0-s) into this frame's scratch memory
+	// rather than building a stringstream on the heap every tick
+	const size_t timeSize = 16;
+	char* time = static_cast<char*>(
+		mGame->GetFrameAllocator()->Allocate(timeSize, 1));
+	snprintf(time, timeSize, "%02d:%02d.%02d", min, sec, ms);
 	mTimerText = mFont->RenderText(time);
 }
 
@@ -139,8 +124,8 @@ void HUD::UpdateCheckpointText(const std::string& text)
 // ============================================================================
 void HUD::Draw(Shader* shader)
 {
-	DrawTexture(shader, mTimerText, Vector2(-420.0f, -315.0f));
-	DrawTexture(shader, mCoinText, Vector2(-449.0f, -285.0f));
+	DrawTexture(shader, mTimerText, sTimerOffset);
+	DrawTexture(shader, mCoinText, sCoinOffset);
 	DrawTexture(shader, mCheckpointText, Vector2::Zero);
 }
 
@@ -150,19 +135,17 @@ void HUD::Draw(Shader* shader)
 void HUD::DrawTexture(class Shader* shader, class Texture* texture,
 					  const Vector2& offset, float scale)
 {
-	// Scale the quad by the width/height of texture
-	Matrix4 scaleMat = Matrix4::CreateScale(
+	// Scale the quad by the width/height of texture, then translate to
+	// position on screen
+	Affine3x4 world = Affine3x4::CreateScale(
 		static_cast<float>(texture->GetWidth()) * scale,
 		static_cast<float>(texture->GetHeight()) * scale,
 		1.0f);
-	
-	// Translate to position on screen
-	Matrix4 transMat =
-		Matrix4::CreateTranslation(Vector3(offset.x, offset.y, 0.0f));
+	world.mat[3][0] = offset.x;
+	world.mat[3][1] = offset.y;
 	
 	// Set world transform
-	Matrix4 world = scaleMat * transMat;
-	shader->SetMatrixUniform("uWorldTransform", world);
+	shader->SetAffineUniform("uWorldTransform", world);
 	
 	// Set current texture
 	texture->SetActive();
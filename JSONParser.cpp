@@ -0,0 +1,113 @@
+#include "JSONParser.h"
+#include "FileSystem.h"
+#include "MemoryTracker.h"
+#include <rapidjson/error/en.h>
+#include <SDL/SDL_log.h>
+
+// Starting pool size. Meshes and levels here need a few hundred KB at most.
+static const size_t sInitialPoolSize = 256 * 1024;
+
+
+// ============================================================================
+// ============================================================================
+JSONParser::JSONParser()
+	:mAllocator(nullptr)
+	,mDocument(nullptr)
+	,mTrackedBytes(0)
+{
+	ResizePool(sInitialPoolSize);
+	TrackMemory();
+}
+
+
+// ============================================================================
+// ============================================================================
+JSONParser::~JSONParser()
+{
+	delete mDocument;
+	delete mAllocator;
+	if (mTrackedBytes > 0)
+	{
+		MemoryTracker::Remove(MemoryJSON, mTrackedBytes);
+	}
+}
+
+
+// ============================================================================
+// ============================================================================
+void JSONParser::ResizePool(size_t poolSize)
+{
+	delete mDocument;
+	delete mAllocator;
+	mPoolBuffer.resize(poolSize);
+	mAllocator = new rapidjson::MemoryPoolAllocator<>(mPoolBuffer.data(),
+													  mPoolBuffer.size());
+	mDocument = new rapidjson::Document(mAllocator);
+}
+
+
+// ============================================================================
+// The previous document is thrown away by resetting its pool. If that
+// document overflowed the pool buffer, grow the buffer to fit it first.
+// ============================================================================
+const rapidjson::Document* JSONParser::Parse(const std::string& fileName)
+{
+	if (!FileSystem::ReadFile(fileName, mFileBuffer))
+	{
+		return nullptr;
+	}
+
+	const size_t lastCapacity = mAllocator->Capacity();
+	if (lastCapacity > mPoolBuffer.size())
+	{
+		ResizePool(lastCapacity);
+	}
+	else
+	{
+		mDocument->SetNull();
+		mAllocator->Clear();
+	}
+
+	mDocument->ParseInsitu(mFileBuffer.data());
+	TrackMemory();
+	if (mDocument->HasParseError())
+	{
+		SDL_Log("%s is not valid JSON: %s (offset %u)", fileName.c_str(),
+				rapidjson::GetParseError_En(mDocument->GetParseError()),
+				static_cast<unsigned>(mDocument->GetErrorOffset()));
+		return nullptr;
+	}
+	return mDocument;
+}
+
+
+// ============================================================================
+// A document that outgrew the pool buffer holds extra chunks from the heap,
+// which the allocator's capacity counts on top of the buffer
+// ============================================================================
+void JSONParser::TrackMemory()
+{
+	const size_t poolBytes = mAllocator->Capacity() > mPoolBuffer.size() ?
+		mAllocator->Capacity() : mPoolBuffer.size();
+	const size_t bytes = mFileBuffer.capacity() + poolBytes;
+	if (bytes != mTrackedBytes)
+	{
+		// Nothing's tracked before the first parse, and removing 0 bytes
+		// would still count an allocation freed
+		if (mTrackedBytes > 0)
+		{
+			MemoryTracker::Remove(MemoryJSON, mTrackedBytes);
+		}
+		MemoryTracker::Add(MemoryJSON, bytes);
+		mTrackedBytes = bytes;
+	}
+}
+
+
+// ============================================================================
+// ============================================================================
+JSONParser& JSONParser::Get()
+{
+	static thread_local JSONParser sParser;
+	return sParser;
+}
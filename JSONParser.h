@@ -0,0 +1,42 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <rapidjson/document.h>
+
+// Parses JSON files in place (rapidjson's ParseInsitu), so string values
+// point into the file buffer instead of being copied. The file buffer and
+// the document's memory pool are both kept between parses: the pool is
+// resized to the largest document seen, so once warmed up a parse allocates
+// nothing. Not thread safe, each thread uses its own (Get).
+class JSONParser
+{
+public:
+	JSONParser();
+	~JSONParser();
+
+	// Read and parse fileName. The result, strings included, is valid until
+	// the next Parse. Logs and returns nullptr if the file can't be read or
+	// isn't valid JSON.
+	const rapidjson::Document* Parse(const std::string& fileName);
+
+	// This thread's parser
+	static JSONParser& Get();
+
+private:
+	JSONParser(const JSONParser&) = delete;
+	JSONParser& operator=(const JSONParser&) = delete;
+
+	// Recreate the document over a pool of at least poolSize bytes
+	void ResizePool(size_t poolSize);
+
+	// Report the buffers' current size to the MemoryTracker
+	void TrackMemory();
+
+	std::vector<char> mFileBuffer;
+	std::vector<char> mPoolBuffer;
+	rapidjson::MemoryPoolAllocator<>* mAllocator;
+	rapidjson::Document* mDocument;
+
+	// Bytes last reported to the MemoryTracker
+	size_t mTrackedBytes;
+};
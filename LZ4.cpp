@@ -0,0 +1,211 @@
+#include "LZ4.h"
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+// Format limits: matches are at least 4 bytes, the last 5 bytes are always
+// literals and the last match starts at least 12 bytes from the end
+static const size_t sMinMatch = 4;
+static const size_t sLastLiterals = 5;
+static const size_t sMatchFindLimit = 12;
+static const size_t sMaxOffset = 65535;
+
+static const unsigned int sHashBits = 16;
+
+static uint32_t Read32(const unsigned char* p)
+{
+	uint32_t value;
+	memcpy(&value, p, sizeof(value));
+	return value;
+}
+
+static unsigned int Hash(uint32_t sequence)
+{
+	return (sequence * 2654435761U) >> (32 - sHashBits);
+}
+
+// A length field: the 4 bits in the token, then 255s and a remainder byte
+static unsigned char* WriteLength(unsigned char* out, size_t length)
+{
+	for (length -= 15; length >= 255; length -= 255)
+	{
+		*out++ = 255;
+	}
+	*out++ = static_cast<unsigned char>(length);
+	return out;
+}
+
+static bool ReadLength(const unsigned char* src, size_t srcSize, size_t& ip,
+					   size_t& length)
+{
+	unsigned char byte;
+	do
+	{
+		if (ip >= srcSize)
+		{
+			return false;
+		}
+		byte = src[ip++];
+		length += byte;
+	} while (byte == 255);
+	return true;
+}
+
+static unsigned char* WriteLiterals(unsigned char* out, unsigned char* token,
+									const unsigned char* literals, size_t count)
+{
+	*token = static_cast<unsigned char>((count < 15 ? count : 15) << 4);
+	if (count >= 15)
+	{
+		out = WriteLength(out, count);
+	}
+	if (count > 0)
+	{
+		memcpy(out, literals, count);
+	}
+	return out + count;
+}
+
+
+// ============================================================================
+// ============================================================================
+size_t LZ4::GetMaxCompressedSize(size_t srcSize)
+{
+	return srcSize + srcSize / 255 + 16;
+}
+
+
+// ============================================================================
+// Greedy: take the first 4 byte match the hash table offers and extend it
+// as far as it goes
+// ============================================================================
+size_t LZ4::Compress(const unsigned char* src, size_t srcSize, unsigned char* dst)
+{
+	unsigned char* out = dst;
+	size_t anchor = 0;
+
+	if (srcSize > sMatchFindLimit)
+	{
+		// Positions + 1, so 0 means empty
+		std::vector<uint32_t> table(static_cast<size_t>(1) << sHashBits, 0);
+		const size_t matchEnd = srcSize - sLastLiterals;
+		const size_t lastStart = srcSize - sMatchFindLimit;
+
+		size_t ip = 0;
+		while (ip <= lastStart)
+		{
+			const uint32_t sequence = Read32(src + ip);
+			const unsigned int hash = Hash(sequence);
+			const size_t candidate = table[hash];
+			table[hash] = static_cast<uint32_t>(ip + 1);
+			if (candidate == 0 || ip - (candidate - 1) > sMaxOffset ||
+				Read32(src + candidate - 1) != sequence)
+			{
+				ip++;
+				continue;
+			}
+
+			const size_t ref = candidate - 1;
+			size_t length = sMinMatch;
+			while (ip + length < matchEnd && src[ref + length] == src[ip + length])
+			{
+				length++;
+			}
+
+			unsigned char* token = out++;
+			out = WriteLiterals(out, token, src + anchor, ip - anchor);
+			const size_t offset = ip - ref;
+			*out++ = static_cast<unsigned char>(offset);
+			*out++ = static_cast<unsigned char>(offset >> 8);
+			const size_t matchCode = length - sMinMatch;
+			*token |= static_cast<unsigned char>(matchCode < 15 ? matchCode : 15);
+			if (matchCode >= 15)
+			{
+				out = WriteLength(out, matchCode);
+			}
+
+			ip += length;
+			anchor = ip;
+		}
+	}
+
+	// Whatever is left goes out as a final literal-only sequence
+	unsigned char* token = out++;
+	out = WriteLiterals(out, token, src + anchor, srcSize - anchor);
+	return static_cast<size_t>(out - dst);
+}
+
+
+// ============================================================================
+// ============================================================================
+bool LZ4::Decompress(const unsigned char* src, size_t srcSize,
+					 unsigned char* dst, size_t dstSize)
+{
+	size_t ip = 0;
+	size_t op = 0;
+	while (ip < srcSize)
+	{
+		const unsigned char token = src[ip++];
+
+		size_t literals = token >> 4;
+		if (literals == 15 && !ReadLength(src, srcSize, ip, literals))
+		{
+			return false;
+		}
+		if (literals > srcSize - ip || literals > dstSize - op)
+		{
+			return false;
+		}
+		if (literals > 0)
+		{
+			memcpy(dst + op, src + ip, literals);
+		}
+		ip += literals;
+		op += literals;
+
+		// The last sequence has no match
+		if (ip == srcSize)
+		{
+			break;
+		}
+
+		if (srcSize - ip < 2)
+		{
+			return false;
+		}
+		const size_t offset = src[ip] | (static_cast<size_t>(src[ip + 1]) << 8);
+		ip += 2;
+		if (offset == 0 || offset > op)
+		{
+			return false;
+		}
+
+		size_t length = token & 15;
+		if (length == 15 && !ReadLength(src, srcSize, ip, length))
+		{
+			return false;
+		}
+		length += sMinMatch;
+		if (length > dstSize - op)
+		{
+			return false;
+		}
+
+		// Matches may overlap their own output (a run), which memcpy can't do
+		unsigned char* out = dst + op;
+		const unsigned char* match = out - offset;
+		if (offset >= length)
+		{
+			memcpy(out, match, length);
+		}
+		else
+		{
+			for (size_t i = 0; i < length; i++)
+			{
+				out[i] = match[i];
+			}
+		}
+		op += length;
+	}
+	return op == dstSize;
+}
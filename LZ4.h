@@ -0,0 +1,23 @@
+#pragma once
+#include <cstddef>
+
+// LZ4 block format (no frame header or checksums), so packed entries stay
+// readable by the reference liblz4. Decompression is a tight copy loop that
+// runs at memory speed; the compressor is a simple greedy one, since it only
+// runs offline when a pack is built.
+class LZ4
+{
+public:
+	// Largest output Compress can produce for srcSize bytes
+	static size_t GetMaxCompressedSize(size_t srcSize);
+
+	// Compress src into dst, which must hold GetMaxCompressedSize(srcSize)
+	// bytes. Returns the compressed size.
+	static size_t Compress(const unsigned char* src, size_t srcSize,
+						   unsigned char* dst);
+
+	// Decompress exactly dstSize bytes. Returns false on malformed input,
+	// without ever reading or writing out of bounds.
+	static bool Decompress(const unsigned char* src, size_t srcSize,
+						   unsigned char* dst, size_t dstSize);
+};
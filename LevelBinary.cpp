@@ -0,0 +1,382 @@
+#include "LevelBinary.h"
+#include "JSONParser.h"
+#include <fstream>
+#include <cstring>
+#include <SDL/SDL_log.h>
+
+const char LevelBinary::Magic[4] = { 'G', 'P', 'L', 'V' };
+
+// The arrays are read in place, so Vector3 must be exactly three floats and
+// the file layout must not drift
+static_assert(sizeof(Vector3) == 3 * sizeof(float), "Vector3 must be packed");
+static_assert(sizeof(LevelActorRecord) == 40, "LevelActorRecord layout changed");
+static_assert(sizeof(LevelBinaryHeader) == 48, "LevelBinaryHeader layout changed");
+
+// Sections start on 16 byte boundaries
+static const uint32_t sSectionAlignment = 16;
+
+static uint32_t AlignUp(uint32_t offset)
+{
+	return (offset + sSectionAlignment - 1) & ~(sSectionAlignment - 1);
+}
+
+
+// ============================================================================
+// ============================================================================
+const char* LevelView::GetString(uint32_t offset) const
+{
+	if (offset == LevelBinary::NoString || offset >= mStringsSize)
+	{
+		return nullptr;
+	}
+	return mStrings + offset;
+}
+
+
+// ============================================================================
+// ============================================================================
+uint32_t LevelData::AddString(const std::string& str)
+{
+	const uint32_t offset = static_cast<uint32_t>(mStrings.size());
+	mStrings += str;
+	mStrings.push_back('\0');
+	return offset;
+}
+
+
+// ============================================================================
+// ============================================================================
+LevelView LevelData::GetView() const
+{
+	LevelView view;
+	view.mNumBlocks = mBlockPositions.size();
+	view.mBlockPositions = mBlockPositions.data();
+	view.mBlockScales = mBlockScales.data();
+	view.mBlockRotations = mBlockRotations.data();
+	view.mBlockTextures = mBlockTextures.data();
+	view.mBlockFlags = mBlockFlags.data();
+	view.mNumActors = mActors.size();
+	view.mActors = mActors.data();
+	view.mStrings = mStrings.data();
+	view.mStringsSize = mStrings.size();
+	return view;
+}
+
+
+// ============================================================================
+// ============================================================================
+LevelBinary::LevelBinary()
+{
+	memset(&mView, 0, sizeof(mView));
+}
+
+
+// ============================================================================
+// Check every section against the file size before pointing into it
+// ============================================================================
+bool LevelBinary::Open(const std::string& fileName)
+{
+	Close();
+	if (!mFile.Open(fileName))
+	{
+		return false;
+	}
+
+	const unsigned char* data = mFile.GetData();
+	const uint64_t size = mFile.GetSize();
+	if (size < sizeof(LevelBinaryHeader))
+	{
+		SDL_Log("Level %s is too small to be a compiled level", fileName.c_str());
+		Close();
+		return false;
+	}
+
+	const LevelBinaryHeader* header =
+		reinterpret_cast<const LevelBinaryHeader*>(data);
+	if (memcmp(header->mMagic, Magic, sizeof(Magic)) != 0 ||
+		header->mVersion != Version)
+	{
+		SDL_Log("Level %s is not a version %u compiled level", fileName.c_str(),
+				static_cast<unsigned>(Version));
+		Close();
+		return false;
+	}
+
+	const uint64_t numBlocks = header->mNumBlocks;
+	const uint64_t numActors = header->mNumActors;
+	struct Section
+	{
+		uint32_t mOffset;
+		uint64_t mSize;
+	};
+	const Section sections[] =
+	{
+		{ header->mBlockPositionsOffset, numBlocks * sizeof(Vector3) },
+		{ header->mBlockScalesOffset, numBlocks * sizeof(float) },
+		{ header->mBlockRotationsOffset, numBlocks * sizeof(float) },
+		{ header->mBlockTexturesOffset, numBlocks * sizeof(int32_t) },
+		{ header->mBlockFlagsOffset, numBlocks * sizeof(uint8_t) },
+		{ header->mActorsOffset, numActors * sizeof(LevelActorRecord) },
+		{ header->mStringsOffset, header->mStringsSize }
+	};
+	for (const auto& section : sections)
+	{
+		if (section.mOffset % sSectionAlignment != 0 ||
+			section.mOffset + section.mSize > size)
+		{
+			SDL_Log("Level %s is truncated or corrupt", fileName.c_str());
+			Close();
+			return false;
+		}
+	}
+
+	// The string table must end in a terminator so no lookup can run off it
+	if (header->mStringsSize > 0 &&
+		data[header->mStringsOffset + header->mStringsSize - 1] != '\0')
+	{
+		SDL_Log("Level %s has a bad string table", fileName.c_str());
+		Close();
+		return false;
+	}
+
+	mView.mNumBlocks = header->mNumBlocks;
+	mView.mBlockPositions =
+		reinterpret_cast<const Vector3*>(data + header->mBlockPositionsOffset);
+	mView.mBlockScales =
+		reinterpret_cast<const float*>(data + header->mBlockScalesOffset);
+	mView.mBlockRotations =
+		reinterpret_cast<const float*>(data + header->mBlockRotationsOffset);
+	mView.mBlockTextures =
+		reinterpret_cast<const int32_t*>(data + header->mBlockTexturesOffset);
+	mView.mBlockFlags = data + header->mBlockFlagsOffset;
+	mView.mNumActors = header->mNumActors;
+	mView.mActors =
+		reinterpret_cast<const LevelActorRecord*>(data + header->mActorsOffset);
+	mView.mStrings = reinterpret_cast<const char*>(data + header->mStringsOffset);
+	mView.mStringsSize = header->mStringsSize;
+	return true;
+}
+
+
+// ============================================================================
+// ============================================================================
+void LevelBinary::Close()
+{
+	mFile.Close();
+	memset(&mView, 0, sizeof(mView));
+}
+
+
+namespace
+{
+	// Same acceptance rules as the original per-property lookups: floats
+	// must be stored as JSON doubles, textures as ints
+	bool ReadFloat(const rapidjson::Value& value, float& outFloat)
+	{
+		if (!value.IsDouble())
+		{
+			return false;
+		}
+		outFloat = value.GetFloat();
+		return true;
+	}
+
+	bool ReadVector(const rapidjson::Value& value, Vector3& outVector)
+	{
+		if (!value.IsArray() || value.Size() != 3 ||
+			!value[0].IsDouble() || !value[1].IsDouble() || !value[2].IsDouble())
+		{
+			return false;
+		}
+		outVector.x = value[0].GetFloat();
+		outVector.y = value[1].GetFloat();
+		outVector.z = value[2].GetFloat();
+		return true;
+	}
+}
+
+
+// ============================================================================
+// One pass over each actor's members, instead of a FindMember per property
+// ============================================================================
+bool LevelBinary::ParseJSON(const std::string& fileName, LevelData& outData)
+{
+	const rapidjson::Document* parsed = JSONParser::Get().Parse(fileName);
+	if (parsed == nullptr)
+	{
+		return false;
+	}
+
+	const rapidjson::Document& doc = *parsed;
+	if (!doc.IsObject())
+	{
+		SDL_Log("Level file %s is not valid JSON", fileName.c_str());
+		return false;
+	}
+
+	outData = LevelData();
+	auto actorsItr = doc.FindMember("actors");
+	if (actorsItr == doc.MemberEnd() || !actorsItr->value.IsArray())
+	{
+		return true;
+	}
+
+	const rapidjson::Value& actors = actorsItr->value;
+	for (rapidjson::SizeType i = 0; i < actors.Size(); i++)
+	{
+		const rapidjson::Value& actorValue = actors[i];
+		if (!actorValue.IsObject())
+		{
+			continue;
+		}
+
+		// Gather every property in one walk over the members
+		const char* type = nullptr;
+		uint32_t flags = 0;
+		Vector3 pos;
+		float scale = 0.0f;
+		float rot = 0.0f;
+		int32_t texture = 0;
+		const rapidjson::Value* level = nullptr;
+		const rapidjson::Value* text = nullptr;
+		for (auto m = actorValue.MemberBegin(); m != actorValue.MemberEnd(); ++m)
+		{
+			const char* name = m->name.GetString();
+			const rapidjson::Value& value = m->value;
+			if (strcmp(name, "type") == 0)
+			{
+				type = value.IsString() ? value.GetString() : nullptr;
+			}
+			else if (strcmp(name, "pos") == 0)
+			{
+				flags |= ReadVector(value, pos) ? LevelHasPos : 0;
+			}
+			else if (strcmp(name, "scale") == 0)
+			{
+				flags |= ReadFloat(value, scale) ? LevelHasScale : 0;
+			}
+			else if (strcmp(name, "rot") == 0)
+			{
+				flags |= ReadFloat(value, rot) ? LevelHasRot : 0;
+			}
+			else if (strcmp(name, "texture") == 0 && value.IsInt())
+			{
+				texture = value.GetInt();
+				flags |= LevelHasTexture;
+			}
+			else if (strcmp(name, "level") == 0 && value.IsString())
+			{
+				level = &value;
+			}
+			else if (strcmp(name, "text") == 0 && value.IsString())
+			{
+				text = &value;
+			}
+		}
+
+		if (type == nullptr)
+		{
+			continue;
+		}
+
+		if (strcmp(type, "Block") == 0)
+		{
+			outData.mBlockPositions.emplace_back(pos);
+			outData.mBlockScales.emplace_back(scale);
+			outData.mBlockRotations.emplace_back(rot);
+			outData.mBlockTextures.emplace_back(texture);
+			outData.mBlockFlags.emplace_back(static_cast<uint8_t>(flags));
+			continue;
+		}
+
+		LevelActorRecord record;
+		if (strcmp(type, "Player") == 0)
+		{
+			record.mType = LevelPlayer;
+		}
+		else if (strcmp(type, "Checkpoint") == 0)
+		{
+			record.mType = LevelCheckpoint;
+		}
+		else if (strcmp(type, "Coin") == 0)
+		{
+			record.mType = LevelCoin;
+		}
+		else
+		{
+			// Unknown types were always skipped
+			continue;
+		}
+		record.mFlags = flags;
+		record.mPos = pos;
+		record.mScale = scale;
+		record.mRot = rot;
+		record.mTexture = texture;
+		record.mLevelString = level ? outData.AddString(level->GetString()) : NoString;
+		record.mTextString = text ? outData.AddString(text->GetString()) : NoString;
+		outData.mActors.emplace_back(record);
+	}
+	return true;
+}
+
+
+// ============================================================================
+// ============================================================================
+bool LevelBinary::Write(const std::string& fileName, const LevelData& data)
+{
+	const uint32_t numBlocks = static_cast<uint32_t>(data.mBlockPositions.size());
+	const uint32_t numActors = static_cast<uint32_t>(data.mActors.size());
+
+	LevelBinaryHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.mMagic, Magic, sizeof(Magic));
+	header.mVersion = Version;
+	header.mNumBlocks = numBlocks;
+	header.mNumActors = numActors;
+
+	// Lay the sections out one after another
+	uint32_t offset = AlignUp(sizeof(LevelBinaryHeader));
+	auto place = [&offset](uint32_t bytes) {
+		const uint32_t start = offset;
+		offset = AlignUp(offset + bytes);
+		return start;
+	};
+	header.mBlockPositionsOffset = place(numBlocks * sizeof(Vector3));
+	header.mBlockScalesOffset = place(numBlocks * sizeof(float));
+	header.mBlockRotationsOffset = place(numBlocks * sizeof(float));
+	header.mBlockTexturesOffset = place(numBlocks * sizeof(int32_t));
+	header.mBlockFlagsOffset = place(numBlocks * sizeof(uint8_t));
+	header.mActorsOffset = place(numActors * sizeof(LevelActorRecord));
+	header.mStringsSize = static_cast<uint32_t>(data.mStrings.size());
+	header.mStringsOffset = place(header.mStringsSize);
+
+	std::vector<unsigned char> out(offset, 0);
+	auto copy = [&out](uint32_t at, const void* src, size_t bytes) {
+		if (bytes > 0)
+		{
+			memcpy(out.data() + at, src, bytes);
+		}
+	};
+	copy(0, &header, sizeof(header));
+	copy(header.mBlockPositionsOffset, data.mBlockPositions.data(), numBlocks * sizeof(Vector3));
+	copy(header.mBlockScalesOffset, data.mBlockScales.data(), numBlocks * sizeof(float));
+	copy(header.mBlockRotationsOffset, data.mBlockRotations.data(), numBlocks * sizeof(float));
+	copy(header.mBlockTexturesOffset, data.mBlockTextures.data(), numBlocks * sizeof(int32_t));
+	copy(header.mBlockFlagsOffset, data.mBlockFlags.data(), numBlocks * sizeof(uint8_t));
+	copy(header.mActorsOffset, data.mActors.data(), numActors * sizeof(LevelActorRecord));
+	copy(header.mStringsOffset, data.mStrings.data(), header.mStringsSize);
+
+	std::ofstream file(fileName, std::ios::binary | std::ios::trunc);
+	if (!file.is_open())
+	{
+		SDL_Log("Couldn't open %s for writing", fileName.c_str());
+		return false;
+	}
+	file.write(reinterpret_cast<const char*>(out.data()), out.size());
+	if (!file)
+	{
+		SDL_Log("Failed writing %s", fileName.c_str());
+		return false;
+	}
+	return true;
+}
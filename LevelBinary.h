@@ -0,0 +1,129 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Math.h"
+#include "MappedFile.h"
+
+// Which optional properties a level entry actually set. Anything not set is
+// left at whatever the actor's constructor chose.
+enum LevelPropertyFlags : uint8_t
+{
+	LevelHasPos = 1 << 0,
+	LevelHasScale = 1 << 1,
+	LevelHasRot = 1 << 2,
+	LevelHasTexture = 1 << 3
+};
+
+enum LevelActorType : uint32_t
+{
+	LevelPlayer,
+	LevelCheckpoint,
+	LevelCoin
+};
+
+// Every non-block actor in a level. Strings are byte offsets into the
+// level's string table, or LevelBinary::NoString.
+struct LevelActorRecord
+{
+	LevelActorType mType;
+	uint32_t mFlags;
+	Vector3 mPos;
+	float mScale;
+	float mRot;
+	int32_t mTexture;
+	uint32_t mLevelString;
+	uint32_t mTextString;
+};
+
+// Read-only view of a level, however it was loaded. Blocks (almost all of a
+// level) are stored as parallel arrays, everything else as records.
+struct LevelView
+{
+	size_t mNumBlocks;
+	const Vector3* mBlockPositions;
+	const float* mBlockScales;
+	const float* mBlockRotations;
+	const int32_t* mBlockTextures;
+	const uint8_t* mBlockFlags;
+
+	size_t mNumActors;
+	const LevelActorRecord* mActors;
+
+	const char* mStrings;
+	size_t mStringsSize;
+
+	// String table lookup (nullptr for NoString)
+	const char* GetString(uint32_t offset) const;
+};
+
+// Level contents parsed from JSON, in the same layout as the binary file
+struct LevelData
+{
+	std::vector<Vector3> mBlockPositions;
+	std::vector<float> mBlockScales;
+	std::vector<float> mBlockRotations;
+	std::vector<int32_t> mBlockTextures;
+	std::vector<uint8_t> mBlockFlags;
+
+	std::vector<LevelActorRecord> mActors;
+
+	// NUL-terminated strings back to back
+	std::string mStrings;
+
+	// Append a string to the table and return its offset
+	uint32_t AddString(const std::string& str);
+
+	LevelView GetView() const;
+};
+
+// Compiled level file (<level>.json.bin, written by Tools/LevelConvert):
+//   header
+//   block positions, scales, rotations, textures, flags  (one array each)
+//   actor records
+//   string table
+// Every section starts 16 byte aligned. Little endian. The file is memory
+// mapped and the loader reads the arrays in place.
+struct LevelBinaryHeader
+{
+	char mMagic[4];
+	uint32_t mVersion;
+	uint32_t mNumBlocks;
+	uint32_t mNumActors;
+	uint32_t mBlockPositionsOffset;
+	uint32_t mBlockScalesOffset;
+	uint32_t mBlockRotationsOffset;
+	uint32_t mBlockTexturesOffset;
+	uint32_t mBlockFlagsOffset;
+	uint32_t mActorsOffset;
+	uint32_t mStringsOffset;
+	uint32_t mStringsSize;
+};
+
+class LevelBinary
+{
+public:
+	static const char Magic[4];
+	static const uint32_t Version = 1;
+	static const uint32_t NoString = 0xFFFFFFFF;
+
+	LevelBinary();
+
+	// Map and validate a compiled level. Returns false, without logging, if
+	// the file doesn't exist so callers can fall back to the JSON source.
+	bool Open(const std::string& fileName);
+	void Close();
+
+	// Points into the mapped file, valid until Close
+	const LevelView& GetView() const { return mView; }
+
+	// Parse a level .json file
+	static bool ParseJSON(const std::string& fileName, LevelData& outData);
+
+	// Write data out in the compiled format
+	static bool Write(const std::string& fileName, const LevelData& data);
+
+private:
+	MappedFile mFile;
+	LevelView mView;
+};
@@ -1,9 +1,8 @@
 #include "LevelLoader.h"
-#include <rapidjson/document.h>
+#include "AssetPath.h"
+#include "Renderer.h"
 #include "Math.h"
 #include <SDL/SDL.h>
-#include <fstream>
-#include <sstream>
 #include "Actor.h"
 #include "MeshComponent.h"
 #include "Block.h"
@@ -11,259 +10,180 @@
 #include "Game.h"
 #include "Checkpoint.h"
 #include "Coin.h"
+#include "TransformSystem.h"
+#include "ThreadPool.h"
 
 namespace
 {
-	// Helper functions to get other types
-	bool GetFloatFromJSON(const rapidjson::Value& inObject, const char* inProperty, float& outFloat);
-	bool GetIntFromJSON(const rapidjson::Value& inObject, const char* inProperty, int& outInt);
-	bool GetStringFromJSON(const rapidjson::Value& inObject, const char* inProperty, std::string& outStr);
-	bool GetBoolFromJSON(const rapidjson::Value& inObject, const char* inProperty, bool& outBool);
-	bool GetVectorFromJSON(const rapidjson::Value& inObject, const char* inProperty, Vector3& outVector);
-	bool GetQuaternionFromJSON(const rapidjson::Value& inObject, const char* inProperty, Quaternion& outQuat);
-}
-
-bool LevelLoader::Load(class Game* game, const std::string & fileName)
-{
-	std::ifstream file(fileName);
-
-	if (!file.is_open())
+	// Blocks per job when placing a level's blocks in parallel, so each job
+	// is worth handing to a worker
+	const size_t sBlockChunkSize = 4096;
+
+	// Set whichever of the common properties the level entry gave. Anything
+	// left out keeps what the actor's constructor chose.
+	void ApplyProperties(Actor* actor, unsigned int flags, const Vector3& pos,
+						 float scale, float rot, int texture)
 	{
-		SDL_Log("Level file %s not found", fileName.c_str());
-		return false;
+		if (flags & LevelHasPos)
+		{
+			actor->SetPosition(pos);
+		}
+		if (flags & LevelHasScale)
+		{
+			actor->SetScale(scale);
+		}
+		if (flags & LevelHasRot)
+		{
+			actor->SetRotation(rot);
+		}
+		if (flags & LevelHasTexture)
+		{
+			MeshComponent* mesh = actor->GetMesh();
+			if (mesh)
+			{
+				mesh->SetTextureIndex(texture);
+			}
+		}
 	}
+}
 
-	std::stringstream fileStream;
-	fileStream << file.rdbuf();
-	std::string contents = fileStream.str();
-	rapidjson::StringStream jsonStr(contents.c_str());
-	rapidjson::Document doc;
-	doc.ParseStream(jsonStr);
+LevelView LevelSource::GetView() const
+{
+	return mIsBinary ? mBinary.GetView() : mData.GetView();
+}
 
-	if (!doc.IsObject())
+bool LevelLoader::Load(class Game* game, const std::string & fileName)
+{
+	LevelSource* source = Read(fileName);
+	if (source == nullptr)
 	{
-		SDL_Log("Level file %s is not valid JSON", fileName.c_str());
 		return false;
 	}
+	Instantiate(game, source->GetView());
+	delete source;
+	return true;
+}
 
-	// Loop through "actors" array
-	const rapidjson::Value& actors = doc["actors"];
-	if (actors.IsArray())
+LevelSource* LevelLoader::Read(const std::string& fileName)
+{
+	// A compiled level is mapped and read in place
+	LevelSource* source = new LevelSource();
+	const std::string cooked = AssetPath::GetCooked(fileName, AssetPath::LevelSuffix);
+	source->mIsBinary = !cooked.empty() && source->mBinary.Open(cooked);
+	if (!source->mIsBinary && !LevelBinary::ParseJSON(fileName, source->mData))
 	{
-		for (rapidjson::SizeType i = 0; i < actors.Size(); i++)
-		{
-			// This index should be an object
-			const rapidjson::Value& actorValue = actors[i];
-			if (actorValue.IsObject())
-			{
-				// Lookup actor type
-				std::string type = actorValue["type"].GetString();
-				Actor* actor = nullptr;
-
-				if (type == "Block")
-				{
-					Block* block = new Block(game);
-					actor = block;
-				}
-				else if (type == "Player")
-				{
-					Player* player = new Player(game);
-					actor = player;
-					Vector3 pos;
-					if (GetVectorFromJSON(actorValue, "pos", pos))
-					{
-						player->SetRespawnPos(pos);
-						game->SetPlayer(player);
-					}
-				}
-				else if (type == "Checkpoint")
-				{
-					Checkpoint* cp = new Checkpoint(game);
-					cp->GetMesh()->SetTextureIndex(1);
-					actor = cp;
-					game->mCheckpoints.push(cp);
-					std::string level;
-					std::string text;
-					if (GetStringFromJSON(actorValue, "level", level))
-					{
-						cp->SetLevelString(level);
-					}
-					if (GetStringFromJSON(actorValue, "text", text))
-					{
-						cp->SetCheckpointString(text);
-					}
-				}
-				else if (type == "Coin")
-				{
-					Coin* coin = new Coin(game);
-					actor = coin;
-				}
-
-				// Set properties of actor
-				if (actor)
-				{
-					Vector3 pos;
-					if (GetVectorFromJSON(actorValue, "pos", pos))
-					{
-						actor->SetPosition(pos);
-					}
-
-					float scale = 1.0f;
-					if (GetFloatFromJSON(actorValue, "scale", scale))
-					{
-						actor->SetScale(scale);
-					}
-
-					float rot = 0.0f;
-					if (GetFloatFromJSON(actorValue, "rot", rot))
-					{
-						actor->SetRotation(rot);
-					}
-
-					int textureIdx = 0;
-					if (GetIntFromJSON(actorValue, "texture", textureIdx))
-					{
-						MeshComponent* mesh = actor->GetMesh();
-						if (mesh)
-						{
-							mesh->SetTextureIndex(static_cast<int>(textureIdx));
-						}
-					}
-				}
-			}
-		}
+		delete source;
+		return nullptr;
 	}
-
-	return true;
+	return source;
 }
 
-namespace
+void LevelLoader::Instantiate(class Game* game, const LevelView& level)
 {
+	game->ReserveActors(level.mNumBlocks + level.mNumActors, level.mNumBlocks);
+
+	// Blocks go in two phases. Their transforms are placed straight into a
+	// range of transform slots, in chunks across the thread pool; each chunk
+	// writes only its own slots. Then the blocks are created here, taking
+	// over those slots, so the registries are only ever touched from this
+	// thread. The mesh is looked up once for all of them.
+	TransformSystem* transforms = game->GetTransforms();
+	const size_t firstSlot = transforms->AddRange(level.mNumBlocks);
+	game->GetThreadPool()->ParallelFor(level.mNumBlocks, sBlockChunkSize,
+		[transforms, firstSlot, &level](size_t begin, size_t end) {
+			for (size_t i = begin; i < end; i++)
+			{
+				const uint8_t flags = level.mBlockFlags[i];
+				transforms->Place(firstSlot + i,
+					(flags & LevelHasPos) ? level.mBlockPositions[i] : Vector3::Zero,
+					(flags & LevelHasScale) ? level.mBlockScales[i] : Block::DefaultScale,
+					(flags & LevelHasRot) ? level.mBlockRotations[i] : 0.0f);
+			}
+		});
 
-	bool GetFloatFromJSON(const rapidjson::Value& inObject, const char* inProperty, float& outFloat)
+	Mesh* blockMesh = (level.mNumBlocks > 0) ?
+		game->GetRenderer()->GetMesh(Block::MeshFile) : nullptr;
+	for (size_t i = 0; i < level.mNumBlocks; i++)
 	{
-		auto itr = inObject.FindMember(inProperty);
-		if (itr == inObject.MemberEnd())
-		{
-			return false;
-		}
-
-		auto& property = itr->value;
-		if (!property.IsDouble())
+		Block* block = new Block(game, firstSlot + i, blockMesh);
+		if (level.mBlockFlags[i] & LevelHasTexture)
 		{
-			return false;
+			block->GetMesh()->SetTextureIndex(level.mBlockTextures[i]);
 		}
-
-		outFloat = property.GetFloat();
-		return true;
 	}
 
-	bool GetIntFromJSON(const rapidjson::Value& inObject, const char* inProperty, int& outInt)
+	for (size_t i = 0; i < level.mNumActors; i++)
 	{
-		auto itr = inObject.FindMember(inProperty);
-		if (itr == inObject.MemberEnd())
+		const LevelActorRecord& record = level.mActors[i];
+		Actor* actor = nullptr;
+
+		if (record.mType == LevelPlayer)
 		{
-			return false;
+			Player* player = new Player(game);
+			actor = player;
+			if (record.mFlags & LevelHasPos)
+			{
+				player->SetRespawnPos(record.mPos);
+				game->SetPlayer(player);
+			}
 		}
-
-		auto& property = itr->value;
-		if (!property.IsInt())
+		else if (record.mType == LevelCheckpoint)
 		{
-			return false;
+			Checkpoint* cp = new Checkpoint(game);
+			cp->GetMesh()->SetTextureIndex(1);
+			actor = cp;
+			game->mCheckpoints.push(cp->GetHandle());
+			if (const char* nextLevel = level.GetString(record.mLevelString))
+			{
+				cp->SetLevelString(nextLevel);
+			}
+			if (const char* text = level.GetString(record.mTextString))
+			{
+				cp->SetCheckpointString(text);
+			}
 		}
-
-		outInt = property.GetInt();
-		return true;
-	}
-
-	bool GetStringFromJSON(const rapidjson::Value& inObject, const char* inProperty, std::string& outStr)
-	{
-		auto itr = inObject.FindMember(inProperty);
-		if (itr == inObject.MemberEnd())
+		else if (record.mType == LevelCoin)
 		{
-			return false;
+			actor = new Coin(game);
 		}
 
-		auto& property = itr->value;
-		if (!property.IsString())
+		if (actor)
 		{
-			return false;
+			ApplyProperties(actor, record.mFlags, record.mPos, record.mScale,
+							record.mRot, record.mTexture);
 		}
-
-		outStr = property.GetString();
-		return true;
 	}
+}
 
-	bool GetBoolFromJSON(const rapidjson::Value& inObject, const char* inProperty, bool& outBool)
+void LevelLoader::Prewarm(class Game* game, const LevelView& level)
+{
+	Renderer* renderer = game->GetRenderer();
+	if (level.mNumBlocks > 0)
 	{
-		auto itr = inObject.FindMember(inProperty);
-		if (itr == inObject.MemberEnd())
-		{
-			return false;
-		}
-
-		auto& property = itr->value;
-		if (!property.IsBool())
-		{
-			return false;
-		}
-
-		outBool = property.GetBool();
-		return true;
+		renderer->GetMesh(Block::MeshFile);
 	}
-
-	bool GetVectorFromJSON(const rapidjson::Value& inObject, const char* inProperty, Vector3& outVector)
+	for (size_t i = 0; i < level.mNumActors; i++)
 	{
-		auto itr = inObject.FindMember(inProperty);
-		if (itr == inObject.MemberEnd())
-		{
-			return false;
-		}
-
-		auto& property = itr->value;
-		if (!property.IsArray() || property.Size() != 3)
+		if (level.mActors[i].mType == LevelCheckpoint)
 		{
-			return false;
+			renderer->GetMesh(Checkpoint::MeshFile);
 		}
-
-		for (rapidjson::SizeType i = 0; i < 3; i++)
+		else if (level.mActors[i].mType == LevelCoin)
 		{
-			if (!property[i].IsDouble())
-			{
-				return false;
-			}
+			renderer->GetMesh(Coin::MeshFile);
 		}
-
-		outVector.x = property[0].GetFloat();
-		outVector.y = property[1].GetFloat();
-		outVector.z = property[2].GetFloat();
-
-		return true;
 	}
+}
 
-	bool GetQuaternionFromJSON(const rapidjson::Value& inObject, const char* inProperty, Quaternion& outQuat)
+void LevelLoader::GetLinkedLevels(const LevelView& level,
+								  std::vector<std::string>& outLevels)
+{
+	for (size_t i = 0; i < level.mNumActors; i++)
 	{
-		auto itr = inObject.FindMember(inProperty);
-		if (itr == inObject.MemberEnd())
-		{
-			return false;
-		}
-
-		auto& property = itr->value;
-
-		for (rapidjson::SizeType i = 0; i < 4; i++)
+		const char* nextLevel = level.GetString(level.mActors[i].mLevelString);
+		if (level.mActors[i].mType == LevelCheckpoint && nextLevel && *nextLevel)
 		{
-			if (!property[i].IsDouble())
-			{
-				return false;
-			}
+			outLevels.emplace_back(nextLevel);
 		}
-
-		outQuat.x = property[0].GetFloat();
-		outQuat.y = property[1].GetFloat();
-		outQuat.z = property[2].GetFloat();
-		outQuat.w = property[3].GetFloat();
-
-		return true;
 	}
 }
@@ -1,8 +1,37 @@
 #pragma once
 #include <string>
+#include <vector>
+#include "LevelBinary.h"
+
+// A level read into memory, ready to instantiate: a mapped compiled level,
+// or the parsed JSON
+struct LevelSource
+{
+	LevelView GetView() const;
+
+	LevelBinary mBinary;
+	LevelData mData;
+	bool mIsBinary;
+};
 
 class LevelLoader
 {
 public:
+	// Load <fileName>.bin if it has been compiled, otherwise the JSON
 	static bool Load(class Game* game, const std::string& fileName);
+
+	// The first half of Load. Only touches memory, so it can run on a loader
+	// thread. Returns nullptr on failure.
+	static LevelSource* Read(const std::string& fileName);
+
+	// Create the actors a level describes
+	static void Instantiate(class Game* game, const LevelView& level);
+
+	// Start loading the meshes (and through them the textures) a level uses.
+	// Safe to call from a worker.
+	static void Prewarm(class Game* game, const LevelView& level);
+
+	// Levels the level's checkpoints lead to
+	static void GetLinkedLevels(const LevelView& level,
+								std::vector<std::string>& outLevels);
 };
@@ -1,7 +1,48 @@
 #include "Game.h"
+#include "AssetPath.h"
+#include "FileSystem.h"
+#include "MemoryTracker.h"
+#include <SDL/SDL_log.h>
+#include <cstdlib>
+#include <cstring>
+#include <string>
 
 int main(int argc, char** argv)
 {
+	// --raw ignores cooked assets, to compare load times against a cooked run.
+	// --loose ignores the asset pack and reads the files under Assets/.
+	// --budget <name>=<MB> sets a memory budget (0 for none): a tag as the
+	// memory dumps print it, or the "ram" or "vram" total.
+	bool usePack = true;
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--raw") == 0)
+		{
+			AssetPath::SetUseCooked(false);
+		}
+		else if (strcmp(argv[i], "--loose") == 0)
+		{
+			usePack = false;
+		}
+		else if (strcmp(argv[i], "--budget") == 0 && i + 1 < argc)
+		{
+			const std::string budget = argv[++i];
+			const size_t equals = budget.find('=');
+			const double mb = (equals != std::string::npos) ?
+				atof(budget.c_str() + equals + 1) : -1.0;
+			if (mb < 0.0 || !MemoryTracker::SetBudget(budget.substr(0, equals),
+				static_cast<size_t>(mb * 1024.0 * 1024.0)))
+			{
+				SDL_Log("Ignoring memory budget %s", budget.c_str());
+			}
+		}
+	}
+
+	if (usePack && FileSystem::Mount("Assets.pak"))
+	{
+		SDL_Log("Reading assets from Assets.pak");
+	}
+
 	Game game;
 	const bool success = game.Initialize();
 	if (success)
@@ -9,5 +50,6 @@ int main(int argc, char** argv)
 		game.RunLoop();
 	}
 	game.Shutdown();
+	FileSystem::Unmount();
 	return 0;
 }
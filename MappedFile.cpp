@@ -0,0 +1,208 @@
+#include "MappedFile.h"
+#include "FileSystem.h"
+#include "AssetPack.h"
+#include <SDL/SDL_log.h>
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+
+// ============================================================================
+// ============================================================================
+MappedFile::MappedFile()
+	:mData(nullptr)
+	,mSize(0)
+	,mBuffer(nullptr)
+	,mIsPacked(false)
+#ifdef _WIN32
+	,mFile(INVALID_HANDLE_VALUE)
+	,mMapping(nullptr)
+#endif
+{
+}
+
+
+// ============================================================================
+// ============================================================================
+MappedFile::~MappedFile()
+{
+	Close();
+}
+
+
+// ============================================================================
+// ============================================================================
+bool MappedFile::Open(const std::string& fileName)
+{
+	Close();
+	return OpenPacked(fileName) || MapFile(fileName);
+}
+
+
+// ============================================================================
+// ============================================================================
+void MappedFile::Close()
+{
+	if (mBuffer)
+	{
+		delete[] mBuffer;
+		mBuffer = nullptr;
+	}
+	else if (!mIsPacked)
+	{
+		UnmapFile();
+	}
+	mData = nullptr;
+	mSize = 0;
+	mIsPacked = false;
+}
+
+
+// ============================================================================
+// ============================================================================
+bool MappedFile::OpenPacked(const std::string& fileName)
+{
+	const AssetPack* pack = FileSystem::GetPack();
+	const AssetPackEntry* entry = pack ? pack->Find(fileName) : nullptr;
+	if (entry == nullptr)
+	{
+		return false;
+	}
+
+	mSize = static_cast<size_t>(entry->mSize);
+	mData = pack->GetData(*entry);
+	if (mData == nullptr)
+	{
+		mBuffer = new unsigned char[mSize];
+		if (!pack->Extract(*entry, mBuffer))
+		{
+			Close();
+			return false;
+		}
+		mData = mBuffer;
+	}
+	else
+	{
+		mIsPacked = true;
+	}
+	return true;
+}
+
+
+#ifdef _WIN32
+// ============================================================================
+// ============================================================================
+bool MappedFile::MapFile(const std::string& fileName)
+{
+	mFile = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ,
+						nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN,
+						nullptr);
+	if (mFile == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(mFile, &size) || size.QuadPart == 0)
+	{
+		SDL_Log("Can't map empty or unreadable file %s", fileName.c_str());
+		Close();
+		return false;
+	}
+
+	mMapping = CreateFileMappingA(mFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (mMapping == nullptr)
+	{
+		SDL_Log("Failed to map %s (error %lu)", fileName.c_str(), GetLastError());
+		Close();
+		return false;
+	}
+
+	mData = static_cast<const unsigned char*>(
+		MapViewOfFile(mMapping, FILE_MAP_READ, 0, 0, 0));
+	if (mData == nullptr)
+	{
+		SDL_Log("Failed to map %s (error %lu)", fileName.c_str(), GetLastError());
+		Close();
+		return false;
+	}
+	mSize = static_cast<size_t>(size.QuadPart);
+	return true;
+}
+
+
+// ============================================================================
+// ============================================================================
+void MappedFile::UnmapFile()
+{
+	if (mData)
+	{
+		UnmapViewOfFile(mData);
+		mData = nullptr;
+	}
+	if (mMapping)
+	{
+		CloseHandle(mMapping);
+		mMapping = nullptr;
+	}
+	if (mFile != INVALID_HANDLE_VALUE)
+	{
+		CloseHandle(mFile);
+		mFile = INVALID_HANDLE_VALUE;
+	}
+	mSize = 0;
+}
+#else
+// ============================================================================
+// The descriptor can be closed straight away, the mapping keeps the file
+// ============================================================================
+bool MappedFile::MapFile(const std::string& fileName)
+{
+	const int fd = open(fileName.c_str(), O_RDONLY);
+	if (fd < 0)
+	{
+		return false;
+	}
+
+	struct stat info;
+	if (fstat(fd, &info) != 0 || info.st_size == 0)
+	{
+		SDL_Log("Can't map empty or unreadable file %s", fileName.c_str());
+		close(fd);
+		return false;
+	}
+
+	const size_t size = static_cast<size_t>(info.st_size);
+	void* data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (data == MAP_FAILED)
+	{
+		SDL_Log("Failed to map %s", fileName.c_str());
+		return false;
+	}
+
+	mData = static_cast<const unsigned char*>(data);
+	mSize = size;
+	return true;
+}
+
+
+// ============================================================================
+// ============================================================================
+void MappedFile::UnmapFile()
+{
+	if (mData)
+	{
+		munmap(const_cast<unsigned char*>(mData), mSize);
+		mData = nullptr;
+	}
+	mSize = 0;
+}
+#endif
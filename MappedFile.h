@@ -0,0 +1,48 @@
+#pragma once
+#include <cstddef>
+#include <string>
+
+// Read-only memory mapping of a whole file. The OS pages the contents in on
+// demand, so nothing is copied: GetData points straight at the file. Files
+// in the mounted asset pack (see FileSystem::Mount) point into the pack's
+// mapping instead, or at a decompressed copy if the entry is compressed.
+class MappedFile
+{
+public:
+	MappedFile();
+	~MappedFile();
+
+	// Map the file (returns false, without logging, if it doesn't exist)
+	bool Open(const std::string& fileName);
+	void Close();
+
+	bool IsOpen() const { return mData != nullptr; }
+	const unsigned char* GetData() const { return mData; }
+	size_t GetSize() const { return mSize; }
+
+private:
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	// Serve the file from the pack. Returns false if it isn't in there.
+	bool OpenPacked(const std::string& fileName);
+
+	// Map the loose file (per platform)
+	bool MapFile(const std::string& fileName);
+	void UnmapFile();
+
+	const unsigned char* mData;
+	size_t mSize;
+
+	// Decompressed pack entry, which mData points at
+	unsigned char* mBuffer;
+
+	// mData points into the mounted pack and isn't ours to unmap
+	bool mIsPacked;
+
+#ifdef _WIN32
+	// File and mapping HANDLEs
+	void* mFile;
+	void* mMapping;
+#endif
+};
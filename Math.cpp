@@ -1,5 +1,8 @@
 #include "Math.h"
 
+// Every constructor used here is constexpr, so all of these constants are
+// constant-initialized (baked into the binary, no startup code and no
+// static initialization order issues for other files that use them)
 const Vector2 Vector2::Zero(0.0f, 0.0f);
 const Vector2 Vector2::UnitX(1.0f, 0.0f);
 const Vector2 Vector2::UnitY(0.0f, 1.0f);
@@ -16,23 +19,22 @@ const Vector3 Vector3::NegUnitZ(0.0f, 0.0f, -1.0f);
 const Vector3 Vector3::Infinity(Math::Infinity, Math::Infinity, Math::Infinity);
 const Vector3 Vector3::NegInfinity(Math::NegInfinity, Math::NegInfinity, Math::NegInfinity);
 
-static float m3Ident[3][3] =
-{
-	{ 1.0f, 0.0f, 0.0f },
-	{ 0.0f, 1.0f, 0.0f },
-	{ 0.0f, 0.0f, 1.0f }
-};
-const Matrix3 Matrix3::Identity(m3Ident);
+const Matrix3 Matrix3::Identity(
+	1.0f, 0.0f, 0.0f,
+	0.0f, 1.0f, 0.0f,
+	0.0f, 0.0f, 1.0f);
 
-static float m4Ident[4][4] =
-{
-	{ 1.0f, 0.0f, 0.0f, 0.0f },
-	{ 0.0f, 1.0f, 0.0f, 0.0f },
-	{ 0.0f, 0.0f, 1.0f, 0.0f },
-	{ 0.0f, 0.0f, 0.0f, 1.0f }
-};
+const Matrix4 Matrix4::Identity(
+	1.0f, 0.0f, 0.0f, 0.0f,
+	0.0f, 1.0f, 0.0f, 0.0f,
+	0.0f, 0.0f, 1.0f, 0.0f,
+	0.0f, 0.0f, 0.0f, 1.0f);
 
-const Matrix4 Matrix4::Identity(m4Ident);
+const Affine3x4 Affine3x4::Identity(
+	1.0f, 0.0f, 0.0f,
+	0.0f, 1.0f, 0.0f,
+	0.0f, 0.0f, 1.0f,
+	0.0f, 0.0f, 0.0f);
 
 const Quaternion Quaternion::Identity(0.0f, 0.0f, 0.0f, 1.0f);
 
@@ -46,6 +48,22 @@ Vector2 Vector2::Transform(const Vector2& vec, const Matrix3& mat, float w /*= 1
 }
 
 Vector3 Vector3::Transform(const Vector3& vec, const Matrix4& mat, float w /*= 1.0f*/)
+{
+#if MATH_SIMD
+	// vec.x * row0 + vec.y * row1 + vec.z * row2 + w * row3
+	__m128 r = _mm_mul_ps(_mm_set1_ps(vec.x), _mm_loadu_ps(mat.mat[0]));
+	r = _mm_add_ps(r, _mm_mul_ps(_mm_set1_ps(vec.y), _mm_loadu_ps(mat.mat[1])));
+	r = _mm_add_ps(r, _mm_mul_ps(_mm_set1_ps(vec.z), _mm_loadu_ps(mat.mat[2])));
+	r = _mm_add_ps(r, _mm_mul_ps(_mm_set1_ps(w), _mm_loadu_ps(mat.mat[3])));
+	float out[4];
+	_mm_storeu_ps(out, r);
+	return Vector3(out[0], out[1], out[2]);
+#else
+	return TransformScalar(vec, mat, w);
+#endif
+}
+
+Vector3 Vector3::TransformScalar(const Vector3& vec, const Matrix4& mat, float w /*= 1.0f*/)
 {
 	Vector3 retVal;
 	retVal.x = vec.x * mat.mat[0][0] + vec.y * mat.mat[1][0] +
@@ -62,6 +80,17 @@ Vector3 Vector3::Transform(const Vector3& vec, const Matrix4& mat, float w /*= 1
 Vector3 Vector3::TransformWithPerspDiv(const Vector3& vec, const Matrix4& mat, float w /*= 1.0f*/)
 {
 	Vector3 retVal;
+#if MATH_SIMD
+	// Same as Transform, but keep the w lane
+	__m128 r = _mm_mul_ps(_mm_set1_ps(vec.x), _mm_loadu_ps(mat.mat[0]));
+	r = _mm_add_ps(r, _mm_mul_ps(_mm_set1_ps(vec.y), _mm_loadu_ps(mat.mat[1])));
+	r = _mm_add_ps(r, _mm_mul_ps(_mm_set1_ps(vec.z), _mm_loadu_ps(mat.mat[2])));
+	r = _mm_add_ps(r, _mm_mul_ps(_mm_set1_ps(w), _mm_loadu_ps(mat.mat[3])));
+	float out[4];
+	_mm_storeu_ps(out, r);
+	retVal.Set(out[0], out[1], out[2]);
+	float transformedW = out[3];
+#else
 	retVal.x = vec.x * mat.mat[0][0] + vec.y * mat.mat[1][0] +
 		vec.z * mat.mat[2][0] + w * mat.mat[3][0];
 	retVal.y = vec.x * mat.mat[0][1] + vec.y * mat.mat[1][1] +
@@ -70,6 +99,7 @@ Vector3 Vector3::TransformWithPerspDiv(const Vector3& vec, const Matrix4& mat, f
 		vec.z * mat.mat[2][2] + w * mat.mat[3][2];
 	float transformedW = vec.x * mat.mat[0][3] + vec.y * mat.mat[1][3] +
 		vec.z * mat.mat[2][3] + w * mat.mat[3][3];
+#endif
 	if (!Math::NearZero(Math::Abs(transformedW)))
 	{
 		transformedW = 1.0f / transformedW;
@@ -89,6 +119,98 @@ Vector3 Vector3::Transform(const Vector3& v, const Quaternion& q)
 }
 
 void Matrix4::Invert()
+{
+#if MATH_SIMD
+	// Cramer's rule on SSE registers, after Intel's "Streaming SIMD
+	// Extensions - Inverse of 4x4 Matrix" (the same method as InvertScalar).
+	// Rows are loaded transposed and interleaved the way that paper expects.
+	const float* src = GetAsFloatPtr();
+	__m128 minor0, minor1, minor2, minor3;
+	__m128 row0, row1, row2, row3;
+	__m128 det, tmp1;
+
+	tmp1 = _mm_setzero_ps();
+	row1 = _mm_setzero_ps();
+	row3 = _mm_setzero_ps();
+
+	tmp1 = _mm_loadh_pi(_mm_loadl_pi(tmp1, (const __m64*)(src)), (const __m64*)(src + 4));
+	row1 = _mm_loadh_pi(_mm_loadl_pi(row1, (const __m64*)(src + 8)), (const __m64*)(src + 12));
+	row0 = _mm_shuffle_ps(tmp1, row1, 0x88);
+	row1 = _mm_shuffle_ps(row1, tmp1, 0xDD);
+	tmp1 = _mm_loadh_pi(_mm_loadl_pi(tmp1, (const __m64*)(src + 2)), (const __m64*)(src + 6));
+	row3 = _mm_loadh_pi(_mm_loadl_pi(row3, (const __m64*)(src + 10)), (const __m64*)(src + 14));
+	row2 = _mm_shuffle_ps(tmp1, row3, 0x88);
+	row3 = _mm_shuffle_ps(row3, tmp1, 0xDD);
+
+	tmp1 = _mm_mul_ps(row2, row3);
+	tmp1 = _mm_shuffle_ps(tmp1, tmp1, 0xB1);
+	minor0 = _mm_mul_ps(row1, tmp1);
+	minor1 = _mm_mul_ps(row0, tmp1);
+	tmp1 = _mm_shuffle_ps(tmp1, tmp1, 0x4E);
+	minor0 = _mm_sub_ps(_mm_mul_ps(row1, tmp1), minor0);
+	minor1 = _mm_sub_ps(_mm_mul_ps(row0, tmp1), minor1);
+	minor1 = _mm_shuffle_ps(minor1, minor1, 0x4E);
+
+	tmp1 = _mm_mul_ps(row1, row2);
+	tmp1 = _mm_shuffle_ps(tmp1, tmp1, 0xB1);
+	minor0 = _mm_add_ps(_mm_mul_ps(row3, tmp1), minor0);
+	minor3 = _mm_mul_ps(row0, tmp1);
+	tmp1 = _mm_shuffle_ps(tmp1, tmp1, 0x4E);
+	minor0 = _mm_sub_ps(minor0, _mm_mul_ps(row3, tmp1));
+	minor3 = _mm_sub_ps(_mm_mul_ps(row0, tmp1), minor3);
+	minor3 = _mm_shuffle_ps(minor3, minor3, 0x4E);
+
+	tmp1 = _mm_mul_ps(_mm_shuffle_ps(row1, row1, 0x4E), row3);
+	tmp1 = _mm_shuffle_ps(tmp1, tmp1, 0xB1);
+	row2 = _mm_shuffle_ps(row2, row2, 0x4E);
+	minor0 = _mm_add_ps(_mm_mul_ps(row2, tmp1), minor0);
+	minor2 = _mm_mul_ps(row0, tmp1);
+	tmp1 = _mm_shuffle_ps(tmp1, tmp1, 0x4E);
+	minor0 = _mm_sub_ps(minor0, _mm_mul_ps(row2, tmp1));
+	minor2 = _mm_sub_ps(_mm_mul_ps(row0, tmp1), minor2);
+	minor2 = _mm_shuffle_ps(minor2, minor2, 0x4E);
+
+	tmp1 = _mm_mul_ps(row0, row1);
+	tmp1 = _mm_shuffle_ps(tmp1, tmp1, 0xB1);
+	minor2 = _mm_add_ps(_mm_mul_ps(row3, tmp1), minor2);
+	minor3 = _mm_sub_ps(_mm_mul_ps(row2, tmp1), minor3);
+	tmp1 = _mm_shuffle_ps(tmp1, tmp1, 0x4E);
+	minor2 = _mm_sub_ps(_mm_mul_ps(row3, tmp1), minor2);
+	minor3 = _mm_sub_ps(minor3, _mm_mul_ps(row2, tmp1));
+
+	tmp1 = _mm_mul_ps(row0, row3);
+	tmp1 = _mm_shuffle_ps(tmp1, tmp1, 0xB1);
+	minor1 = _mm_sub_ps(minor1, _mm_mul_ps(row2, tmp1));
+	minor2 = _mm_add_ps(_mm_mul_ps(row1, tmp1), minor2);
+	tmp1 = _mm_shuffle_ps(tmp1, tmp1, 0x4E);
+	minor1 = _mm_add_ps(_mm_mul_ps(row2, tmp1), minor1);
+	minor2 = _mm_sub_ps(minor2, _mm_mul_ps(row1, tmp1));
+
+	tmp1 = _mm_mul_ps(row0, row2);
+	tmp1 = _mm_shuffle_ps(tmp1, tmp1, 0xB1);
+	minor1 = _mm_add_ps(_mm_mul_ps(row3, tmp1), minor1);
+	minor3 = _mm_sub_ps(minor3, _mm_mul_ps(row1, tmp1));
+	tmp1 = _mm_shuffle_ps(tmp1, tmp1, 0x4E);
+	minor1 = _mm_sub_ps(minor1, _mm_mul_ps(row3, tmp1));
+	minor3 = _mm_add_ps(_mm_mul_ps(row1, tmp1), minor3);
+
+	// Determinant, with a real divide rather than the paper's rcp estimate
+	det = _mm_mul_ps(row0, minor0);
+	det = _mm_add_ps(_mm_shuffle_ps(det, det, 0x4E), det);
+	det = _mm_add_ss(_mm_shuffle_ps(det, det, 0xB1), det);
+	det = _mm_div_ss(_mm_set_ss(1.0f), det);
+	det = _mm_shuffle_ps(det, det, 0x00);
+
+	_mm_storeu_ps(mat[0], _mm_mul_ps(det, minor0));
+	_mm_storeu_ps(mat[1], _mm_mul_ps(det, minor1));
+	_mm_storeu_ps(mat[2], _mm_mul_ps(det, minor2));
+	_mm_storeu_ps(mat[3], _mm_mul_ps(det, minor3));
+#else
+	InvertScalar();
+#endif
+}
+
+void Matrix4::InvertScalar()
 {
 	// Thanks slow math
 	float tmp[12]; /* temp array for pairs */
@@ -205,6 +327,57 @@ void Matrix4::Invert()
 }
 
 Matrix4 Matrix4::CreateFromQuaternion(const class Quaternion& q)
+{
+#if MATH_SIMD
+	// Every entry of the top 3x3 is base +/- a1 * b1 +/- a2 * b2, where the
+	// a's come from 2q and the b's from q. Subtraction is done by flipping
+	// the sign bit and adding, which gives the same bits as the scalar code
+	// (up to the sign of an exact zero). Lane 3 is masked to 0.
+	const __m128 qv = _mm_setr_ps(q.x, q.y, q.z, q.w);
+	const __m128 q2 = _mm_add_ps(qv, qv);
+	const __m128 neg = _mm_set1_ps(-0.0f);
+	const __m128 lane3 = _mm_castsi128_ps(_mm_setr_epi32(-1, -1, -1, 0));
+	const __m128 s100 = _mm_and_ps(neg, _mm_castsi128_ps(_mm_setr_epi32(-1, 0, 0, 0)));
+	const __m128 s010 = _mm_and_ps(neg, _mm_castsi128_ps(_mm_setr_epi32(0, -1, 0, 0)));
+	const __m128 s001 = _mm_and_ps(neg, _mm_castsi128_ps(_mm_setr_epi32(0, 0, -1, 0)));
+	const __m128 s101 = _mm_or_ps(s100, s001);
+	const __m128 s110 = _mm_or_ps(s100, s010);
+	const __m128 s011 = _mm_or_ps(s010, s001);
+
+#define QSHUF(v, a, b, c) _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, c, b, a))
+#define QROW(base, a1, b1, s1, a2, b2, s2) \
+	_mm_and_ps(lane3, _mm_add_ps(_mm_add_ps(base, \
+		_mm_xor_ps(_mm_mul_ps(a1, b1), s1)), \
+		_mm_xor_ps(_mm_mul_ps(a2, b2), s2)))
+
+	// 1 - 2yy - 2zz, 2xy + 2wz, 2xz - 2wy
+	const __m128 row0 = QROW(_mm_setr_ps(1.0f, 0.0f, 0.0f, 0.0f),
+		QSHUF(q2, 1, 0, 0), QSHUF(qv, 1, 1, 2), s100,
+		QSHUF(q2, 2, 3, 3), QSHUF(qv, 2, 2, 1), s101);
+	// 2xy - 2wz, 1 - 2xx - 2zz, 2yz + 2wx
+	const __m128 row1 = QROW(_mm_setr_ps(0.0f, 1.0f, 0.0f, 0.0f),
+		QSHUF(q2, 0, 0, 1), QSHUF(qv, 1, 0, 2), s010,
+		QSHUF(q2, 3, 2, 3), QSHUF(qv, 2, 2, 0), s110);
+	// 2xz + 2wy, 2yz - 2wx, 1 - 2xx - 2yy
+	const __m128 row2 = QROW(_mm_setr_ps(0.0f, 0.0f, 1.0f, 0.0f),
+		QSHUF(q2, 0, 1, 0), QSHUF(qv, 2, 2, 0), s001,
+		QSHUF(q2, 3, 3, 1), QSHUF(qv, 1, 0, 1), s011);
+
+#undef QROW
+#undef QSHUF
+
+	Matrix4 retVal;
+	_mm_storeu_ps(retVal.mat[0], row0);
+	_mm_storeu_ps(retVal.mat[1], row1);
+	_mm_storeu_ps(retVal.mat[2], row2);
+	_mm_storeu_ps(retVal.mat[3], _mm_setr_ps(0.0f, 0.0f, 0.0f, 1.0f));
+	return retVal;
+#else
+	return CreateFromQuaternionScalar(q);
+#endif
+}
+
+Matrix4 Matrix4::CreateFromQuaternionScalar(const class Quaternion& q)
 {
 	float mat[4][4];
 	
@@ -230,3 +403,78 @@ Matrix4 Matrix4::CreateFromQuaternion(const class Quaternion& q)
 
 	return Matrix4(mat);
 }
+
+void Affine3x4::Invert()
+{
+	// Inverse of the 3x3 from its cofactors
+	const float a = mat[0][0], b = mat[0][1], c = mat[0][2];
+	const float d = mat[1][0], e = mat[1][1], f = mat[1][2];
+	const float g = mat[2][0], h = mat[2][1], i = mat[2][2];
+
+	const float c00 = e * i - f * h;
+	const float c01 = f * g - d * i;
+	const float c02 = d * h - e * g;
+	const float invDet = 1.0f / (a * c00 + b * c01 + c * c02);
+
+	float inv[3][3];
+	inv[0][0] = c00 * invDet;
+	inv[0][1] = (c * h - b * i) * invDet;
+	inv[0][2] = (b * f - c * e) * invDet;
+	inv[1][0] = c01 * invDet;
+	inv[1][1] = (a * i - c * g) * invDet;
+	inv[1][2] = (c * d - a * f) * invDet;
+	inv[2][0] = c02 * invDet;
+	inv[2][1] = (b * g - a * h) * invDet;
+	inv[2][2] = (a * e - b * d) * invDet;
+
+	// New translation is -t * inverse(3x3)
+	const Vector3 t = GetTranslation();
+	for (int j = 0; j < 3; j++)
+	{
+		mat[0][j] = inv[0][j];
+		mat[1][j] = inv[1][j];
+		mat[2][j] = inv[2][j];
+		mat[3][j] = -(t.x * inv[0][j] + t.y * inv[1][j] + t.z * inv[2][j]);
+	}
+}
+
+void Affine3x4::InvertOrthonormal()
+{
+	// Read everything up front; swapping in place makes each read depend on
+	// a store that was just issued, which is far slower than the math
+	const float r00 = mat[0][0], r01 = mat[0][1], r02 = mat[0][2];
+	const float r10 = mat[1][0], r11 = mat[1][1], r12 = mat[1][2];
+	const float r20 = mat[2][0], r21 = mat[2][1], r22 = mat[2][2];
+	const float tx = mat[3][0], ty = mat[3][1], tz = mat[3][2];
+
+	// Transpose the rotation
+	mat[0][0] = r00; mat[0][1] = r10; mat[0][2] = r20;
+	mat[1][0] = r01; mat[1][1] = r11; mat[1][2] = r21;
+	mat[2][0] = r02; mat[2][1] = r12; mat[2][2] = r22;
+
+	// New translation is -t * transpose(R)
+	mat[3][0] = -(tx * r00 + ty * r01 + tz * r02);
+	mat[3][1] = -(tx * r10 + ty * r11 + tz * r12);
+	mat[3][2] = -(tx * r20 + ty * r21 + tz * r22);
+}
+
+Affine3x4 Affine3x4::CreateWorld(float scale, float rotationZ,
+								 const Quaternion& q, const Vector3& pos)
+{
+	// Fold the z rotation into the quaternion's 3x3 and scale its rows
+	const Matrix4 r = Matrix4::CreateFromQuaternion(q);
+	const float c = Math::Cos(rotationZ) * scale;
+	const float s = Math::Sin(rotationZ) * scale;
+
+	Affine3x4 retVal;
+	for (int j = 0; j < 3; j++)
+	{
+		retVal.mat[0][j] = c * r.mat[0][j] + s * r.mat[1][j];
+		retVal.mat[1][j] = c * r.mat[1][j] - s * r.mat[0][j];
+		retVal.mat[2][j] = scale * r.mat[2][j];
+	}
+	retVal.mat[3][0] = pos.x;
+	retVal.mat[3][1] = pos.y;
+	retVal.mat[3][2] = pos.z;
+	return retVal;
+}
@@ -6,21 +6,34 @@
 #include <memory.h>
 #include <limits>
 
+// The SIMD kernels only need SSE2, which every x64 target guarantees, so
+// they're picked at compile time. They only use separate multiplies and adds
+// in the same order as the scalar code (no FMA, no dot product instructions),
+// so Matrix4 multiply and Vector3::Transform match the scalar results bit for
+// bit. Define MATH_NO_SIMD to force the scalar versions everywhere.
+#if !defined(MATH_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || \
+	(defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define MATH_SIMD 1
+#include <emmintrin.h>
+#else
+#define MATH_SIMD 0
+#endif
+
 namespace Math
 {
-	const float Pi = 3.1415926535f;
-	const float TwoPi = Pi * 2.0f;
-	const float PiOver2 = Pi / 2.0f;
-	const float PiOver4 = Pi / 4.0f;
-	const float Infinity = std::numeric_limits<float>::infinity();
-	const float NegInfinity = -std::numeric_limits<float>::infinity();
+	constexpr float Pi = 3.1415926535f;
+	constexpr float TwoPi = Pi * 2.0f;
+	constexpr float PiOver2 = Pi / 2.0f;
+	constexpr float PiOver4 = Pi / 4.0f;
+	constexpr float Infinity = std::numeric_limits<float>::infinity();
+	constexpr float NegInfinity = -std::numeric_limits<float>::infinity();
 
-	inline float ToRadians(float degrees)
+	constexpr float ToRadians(float degrees)
 	{
 		return degrees * Pi / 180.0f;
 	}
 
-	inline float ToDegrees(float radians)
+	constexpr float ToDegrees(float radians)
 	{
 		return radians * 180.0f / Pi;
 	}
@@ -38,19 +51,19 @@ namespace Math
 	}
 
 	template <typename T>
-	T Max(const T& a, const T& b)
+	constexpr T Max(const T& a, const T& b)
 	{
 		return (a < b ? b : a);
 	}
 
 	template <typename T>
-	T Min(const T& a, const T& b)
+	constexpr T Min(const T& a, const T& b)
 	{
 		return (a < b ? a : b);
 	}
 
 	template <typename T>
-	T Clamp(const T& value, const T& lower, const T& upper)
+	constexpr T Clamp(const T& value, const T& lower, const T& upper)
 	{
 		return Min(upper, Max(lower, value));
 	}
@@ -90,7 +103,7 @@ namespace Math
 		return 1.0f / Tan(angle);
 	}
 
-	inline float Lerp(float a, float b, float f)
+	constexpr float Lerp(float a, float b, float f)
 	{
 		return a + f * (b - a);
 	}
@@ -113,12 +126,12 @@ public:
 	float x;
 	float y;
 
-	Vector2()
+	constexpr Vector2()
 		:x(0.0f)
 		,y(0.0f)
 	{}
 
-	explicit Vector2(float inX, float inY)
+	constexpr explicit Vector2(float inX, float inY)
 		:x(inX)
 		,y(inY)
 	{}
@@ -131,32 +144,32 @@ public:
 	}
 
 	// Vector addition (a + b)
-	friend Vector2 operator+(const Vector2& a, const Vector2& b)
+	friend constexpr Vector2 operator+(const Vector2& a, const Vector2& b)
 	{
 		return Vector2(a.x + b.x, a.y + b.y);
 	}
 
 	// Vector subtraction (a - b)
-	friend Vector2 operator-(const Vector2& a, const Vector2& b)
+	friend constexpr Vector2 operator-(const Vector2& a, const Vector2& b)
 	{
 		return Vector2(a.x - b.x, a.y - b.y);
 	}
 
 	// Component-wise multiplication
 	// (a.x * b.x, ...)
-	friend Vector2 operator*(const Vector2& a, const Vector2& b)
+	friend constexpr Vector2 operator*(const Vector2& a, const Vector2& b)
 	{
 		return Vector2(a.x * b.x, a.y * b.y);
 	}
 
 	// Scalar multiplication
-	friend Vector2 operator*(const Vector2& vec, float scalar)
+	friend constexpr Vector2 operator*(const Vector2& vec, float scalar)
 	{
 		return Vector2(vec.x * scalar, vec.y * scalar);
 	}
 
 	// Scalar multiplication
-	friend Vector2 operator*(float scalar, const Vector2& vec)
+	friend constexpr Vector2 operator*(float scalar, const Vector2& vec)
 	{
 		return Vector2(vec.x * scalar, vec.y * scalar);
 	}
@@ -214,19 +227,19 @@ public:
 	}
 
 	// Dot product between two vectors (a dot b)
-	static float Dot(const Vector2& a, const Vector2& b)
+	static constexpr float Dot(const Vector2& a, const Vector2& b)
 	{
 		return (a.x * b.x + a.y * b.y);
 	}
 
 	// Lerp from A to B by f
-	static Vector2 Lerp(const Vector2& a, const Vector2& b, float f)
+	static constexpr Vector2 Lerp(const Vector2& a, const Vector2& b, float f)
 	{
 		return Vector2(a + f * (b - a));
 	}
 	
 	// Reflect V about (normalized) N
-	static Vector2 Reflect(const Vector2& v, const Vector2& n)
+	static constexpr Vector2 Reflect(const Vector2& v, const Vector2& n)
 	{
 		return v - 2.0f * Vector2::Dot(v, n) * n;
 	}
@@ -249,13 +262,13 @@ public:
 	float y;
 	float z;
 
-	Vector3()
+	constexpr Vector3()
 		:x(0.0f)
 		,y(0.0f)
 		,z(0.0f)
 	{}
 
-	explicit Vector3(float inX, float inY, float inZ)
+	constexpr explicit Vector3(float inX, float inY, float inZ)
 		:x(inX)
 		,y(inY)
 		,z(inZ)
@@ -276,31 +289,31 @@ public:
 	}
 
 	// Vector addition (a + b)
-	friend Vector3 operator+(const Vector3& a, const Vector3& b)
+	friend constexpr Vector3 operator+(const Vector3& a, const Vector3& b)
 	{
 		return Vector3(a.x + b.x, a.y + b.y, a.z + b.z);
 	}
 
 	// Vector subtraction (a - b)
-	friend Vector3 operator-(const Vector3& a, const Vector3& b)
+	friend constexpr Vector3 operator-(const Vector3& a, const Vector3& b)
 	{
 		return Vector3(a.x - b.x, a.y - b.y, a.z - b.z);
 	}
 
 	// Component-wise multiplication
-	friend Vector3 operator*(const Vector3& left, const Vector3& right)
+	friend constexpr Vector3 operator*(const Vector3& left, const Vector3& right)
 	{
 		return Vector3(left.x * right.x, left.y * right.y, left.z * right.z);
 	}
 
 	// Scalar multiplication
-	friend Vector3 operator*(const Vector3& vec, float scalar)
+	friend constexpr Vector3 operator*(const Vector3& vec, float scalar)
 	{
 		return Vector3(vec.x * scalar, vec.y * scalar, vec.z * scalar);
 	}
 
 	// Scalar multiplication
-	friend Vector3 operator*(float scalar, const Vector3& vec)
+	friend constexpr Vector3 operator*(float scalar, const Vector3& vec)
 	{
 		return Vector3(vec.x * scalar, vec.y * scalar, vec.z * scalar);
 	}
@@ -362,34 +375,34 @@ public:
 	}
 
 	// Dot product between two vectors (a dot b)
-	static float Dot(const Vector3& a, const Vector3& b)
+	static constexpr float Dot(const Vector3& a, const Vector3& b)
 	{
 		return (a.x * b.x + a.y * b.y + a.z * b.z);
 	}
 
 	// Cross product between two vectors (a cross b)
-	static Vector3 Cross(const Vector3& a, const Vector3& b)
+	static constexpr Vector3 Cross(const Vector3& a, const Vector3& b)
 	{
-		Vector3 temp;
-		temp.x = a.y * b.z - a.z * b.y;
-		temp.y = a.z * b.x - a.x * b.z;
-		temp.z = a.x * b.y - a.y * b.x;
-		return temp;
+		return Vector3(a.y * b.z - a.z * b.y,
+					   a.z * b.x - a.x * b.z,
+					   a.x * b.y - a.y * b.x);
 	}
 
 	// Lerp from A to B by f
-	static Vector3 Lerp(const Vector3& a, const Vector3& b, float f)
+	static constexpr Vector3 Lerp(const Vector3& a, const Vector3& b, float f)
 	{
 		return Vector3(a + f * (b - a));
 	}
 	
 	// Reflect V about (normalized) N
-	static Vector3 Reflect(const Vector3& v, const Vector3& n)
+	static constexpr Vector3 Reflect(const Vector3& v, const Vector3& n)
 	{
 		return v - 2.0f * Vector3::Dot(v, n) * n;
 	}
 
 	static Vector3 Transform(const Vector3& vec, const class Matrix4& mat, float w = 1.0f);
+	// Scalar reference version of Transform (what the SIMD path must match)
+	static Vector3 TransformScalar(const Vector3& vec, const class Matrix4& mat, float w = 1.0f);
 	// This will transform the vector and renormalize the w component
 	static Vector3 TransformWithPerspDiv(const Vector3& vec, const class Matrix4& mat, float w = 1.0f);
 
@@ -413,10 +426,20 @@ class Matrix3
 public:
 	float mat[3][3];
 
-	Matrix3()
-	{
-		*this = Matrix3::Identity;
-	}
+	constexpr Matrix3()
+		:mat{ { 1.0f, 0.0f, 0.0f },
+			  { 0.0f, 1.0f, 0.0f },
+			  { 0.0f, 0.0f, 1.0f } }
+	{}
+
+	// Element by element, row major
+	constexpr explicit Matrix3(float m00, float m01, float m02,
+							   float m10, float m11, float m12,
+							   float m20, float m21, float m22)
+		:mat{ { m00, m01, m02 },
+			  { m10, m11, m12 },
+			  { m20, m21, m22 } }
+	{}
 
 	explicit Matrix3(float inMat[3][3])
 	{
@@ -491,24 +514,21 @@ public:
 	}
 
 	// Create a scale matrix with x and y scales
-	static Matrix3 CreateScale(float xScale, float yScale)
+	static constexpr Matrix3 CreateScale(float xScale, float yScale)
 	{
-		float temp[3][3] =
-		{
-			{ xScale, 0.0f, 0.0f },
-			{ 0.0f, yScale, 0.0f },
-			{ 0.0f, 0.0f, 1.0f },
-		};
-		return Matrix3(temp);
+		return Matrix3(
+			xScale, 0.0f, 0.0f,
+			0.0f, yScale, 0.0f,
+			0.0f, 0.0f, 1.0f);
 	}
 
-	static Matrix3 CreateScale(const Vector2& scaleVector)
+	static constexpr Matrix3 CreateScale(const Vector2& scaleVector)
 	{
 		return CreateScale(scaleVector.x, scaleVector.y);
 	}
 
 	// Create a scale matrix with a uniform factor
-	static Matrix3 CreateScale(float scale)
+	static constexpr Matrix3 CreateScale(float scale)
 	{
 		return CreateScale(scale, scale);
 	}
@@ -527,15 +547,12 @@ public:
 	}
 
 	// Create a translation matrix (on the xy-plane)
-	static Matrix3 CreateTranslation(const Vector2& trans)
+	static constexpr Matrix3 CreateTranslation(const Vector2& trans)
 	{
-		float temp[3][3] =
-		{
-			{ 1.0f, 0.0f, 0.0f },
-			{ 0.0f, 1.0f, 0.0f },
-			{ trans.x, trans.y, 1.0f },
-		};
-		return Matrix3(temp);
+		return Matrix3(
+			1.0f, 0.0f, 0.0f,
+			0.0f, 1.0f, 0.0f,
+			trans.x, trans.y, 1.0f);
 	}
 
 	static const Matrix3 Identity;
@@ -547,10 +564,23 @@ class Matrix4
 public:
 	float mat[4][4];
 
-	Matrix4()
-	{
-		*this = Matrix4::Identity;
-	}
+	constexpr Matrix4()
+		:mat{ { 1.0f, 0.0f, 0.0f, 0.0f },
+			  { 0.0f, 1.0f, 0.0f, 0.0f },
+			  { 0.0f, 0.0f, 1.0f, 0.0f },
+			  { 0.0f, 0.0f, 0.0f, 1.0f } }
+	{}
+
+	// Element by element, row major
+	constexpr explicit Matrix4(float m00, float m01, float m02, float m03,
+							   float m10, float m11, float m12, float m13,
+							   float m20, float m21, float m22, float m23,
+							   float m30, float m31, float m32, float m33)
+		:mat{ { m00, m01, m02, m03 },
+			  { m10, m11, m12, m13 },
+			  { m20, m21, m22, m23 },
+			  { m30, m31, m32, m33 } }
+	{}
 
 	explicit Matrix4(float inMat[4][4])
 	{
@@ -563,8 +593,38 @@ public:
 		return reinterpret_cast<const float*>(&mat[0][0]);
 	}
 
-	// Matrix multiplication (a * b)
+	// Matrix multiplication (a * b). Stays scalar: compilers vectorize it
+	// about as well as MultiplySIMD, which MathBench has slightly slower.
 	friend Matrix4 operator*(const Matrix4& a, const Matrix4& b)
+	{
+		return MultiplyScalar(a, b);
+	}
+
+#if MATH_SIMD
+	// Each row of the result is a linear combination of b's rows:
+	// row i = a[i][0] * b0 + a[i][1] * b1 + a[i][2] * b2 + a[i][3] * b3
+	static Matrix4 MultiplySIMD(const Matrix4& a, const Matrix4& b)
+	{
+		const __m128 b0 = _mm_loadu_ps(b.mat[0]);
+		const __m128 b1 = _mm_loadu_ps(b.mat[1]);
+		const __m128 b2 = _mm_loadu_ps(b.mat[2]);
+		const __m128 b3 = _mm_loadu_ps(b.mat[3]);
+
+		Matrix4 retVal;
+		for (int i = 0; i < 4; i++)
+		{
+			__m128 row = _mm_mul_ps(_mm_set1_ps(a.mat[i][0]), b0);
+			row = _mm_add_ps(row, _mm_mul_ps(_mm_set1_ps(a.mat[i][1]), b1));
+			row = _mm_add_ps(row, _mm_mul_ps(_mm_set1_ps(a.mat[i][2]), b2));
+			row = _mm_add_ps(row, _mm_mul_ps(_mm_set1_ps(a.mat[i][3]), b3));
+			_mm_storeu_ps(retVal.mat[i], row);
+		}
+		return retVal;
+	}
+#endif
+
+	// Scalar matrix multiplication, the reference for the SIMD version
+	static Matrix4 MultiplyScalar(const Matrix4& a, const Matrix4& b)
 	{
 		Matrix4 retVal;
 		// row 0
@@ -676,11 +736,14 @@ public:
 		return *this;
 	}
 
-	// Invert the matrix - super slow
+	// Invert the matrix (SIMD when available)
 	void Invert();
+	
+	// Scalar reference version of Invert - super slow
+	void InvertScalar();
 
 	// Get the translation component of the matrix
-	Vector3 GetTranslation() const
+	constexpr Vector3 GetTranslation() const
 	{
 		return Vector3(mat[3][0], mat[3][1], mat[3][2]);
 	}
@@ -714,25 +777,22 @@ public:
 	}
 
 	// Create a scale matrix with x, y, and z scales
-	static Matrix4 CreateScale(float xScale, float yScale, float zScale)
+	static constexpr Matrix4 CreateScale(float xScale, float yScale, float zScale)
 	{
-		float temp[4][4] =
-		{
-			{ xScale, 0.0f, 0.0f, 0.0f },
-			{ 0.0f, yScale, 0.0f, 0.0f },
-			{ 0.0f, 0.0f, zScale, 0.0f },
-			{ 0.0f, 0.0f, 0.0f, 1.0f }
-		};
-		return Matrix4(temp);
+		return Matrix4(
+			xScale, 0.0f, 0.0f, 0.0f,
+			0.0f, yScale, 0.0f, 0.0f,
+			0.0f, 0.0f, zScale, 0.0f,
+			0.0f, 0.0f, 0.0f, 1.0f);
 	}
 
-	static Matrix4 CreateScale(const Vector3& scaleVector)
+	static constexpr Matrix4 CreateScale(const Vector3& scaleVector)
 	{
 		return CreateScale(scaleVector.x, scaleVector.y, scaleVector.z);
 	}
 
 	// Create a scale matrix with a uniform factor
-	static Matrix4 CreateScale(float scale)
+	static constexpr Matrix4 CreateScale(float scale)
 	{
 		return CreateScale(scale, scale, scale);
 	}
@@ -778,17 +838,15 @@ public:
 
 	// Create a rotation matrix from a quaternion
 	static Matrix4 CreateFromQuaternion(const class Quaternion& q);
+	static Matrix4 CreateFromQuaternionScalar(const class Quaternion& q);
 
-	static Matrix4 CreateTranslation(const Vector3& trans)
+	static constexpr Matrix4 CreateTranslation(const Vector3& trans)
 	{
-		float temp[4][4] =
-		{
-			{ 1.0f, 0.0f, 0.0f, 0.0f },
-			{ 0.0f, 1.0f, 0.0f, 0.0f },
-			{ 0.0f, 0.0f, 1.0f, 0.0f },
-			{ trans.x, trans.y, trans.z, 1.0f }
-		};
-		return Matrix4(temp);
+		return Matrix4(
+			1.0f, 0.0f, 0.0f, 0.0f,
+			0.0f, 1.0f, 0.0f, 0.0f,
+			0.0f, 0.0f, 1.0f, 0.0f,
+			trans.x, trans.y, trans.z, 1.0f);
 	}
 
 	static Matrix4 CreateLookAt(const Vector3& eye, const Vector3& target, const Vector3& up)
@@ -811,16 +869,13 @@ public:
 		return Matrix4(temp);
 	}
 
-	static Matrix4 CreateOrtho(float width, float height, float near, float far)
+	static constexpr Matrix4 CreateOrtho(float width, float height, float near, float far)
 	{
-		float temp[4][4] =
-		{
-			{ 2.0f / width, 0.0f, 0.0f, 0.0f },
-			{ 0.0f, 2.0f / height, 0.0f, 0.0f },
-			{ 0.0f, 0.0f, 1.0f / (far - near), 0.0f },
-			{ 0.0f, 0.0f, near / (near - far), 1.0f }
-		};
-		return Matrix4(temp);
+		return Matrix4(
+			2.0f / width, 0.0f, 0.0f, 0.0f,
+			0.0f, 2.0f / height, 0.0f, 0.0f,
+			0.0f, 0.0f, 1.0f / (far - near), 0.0f,
+			0.0f, 0.0f, near / (near - far), 1.0f);
 	}
 
 	static Matrix4 CreatePerspectiveFOV(float fovY, float width, float height, float near, float far)
@@ -838,16 +893,13 @@ public:
 	}
 
 	// Create "Simple" View-Projection Matrix from Chapter 6
-	static Matrix4 CreateSimpleViewProj(float width, float height)
+	static constexpr Matrix4 CreateSimpleViewProj(float width, float height)
 	{
-		float temp[4][4] =
-		{
-			{ 2.0f/width, 0.0f, 0.0f, 0.0f },
-			{ 0.0f, 2.0f/height, 0.0f, 0.0f },
-			{ 0.0f, 0.0f, 1.0f, 0.0f },
-			{ 0.0f, 0.0f, 1.0f, 1.0f }
-		};
-		return Matrix4(temp);
+		return Matrix4(
+			2.0f/width, 0.0f, 0.0f, 0.0f,
+			0.0f, 2.0f/height, 0.0f, 0.0f,
+			0.0f, 0.0f, 1.0f, 0.0f,
+			0.0f, 0.0f, 1.0f, 1.0f);
 	}
 	
 	static const Matrix4 Identity;
@@ -862,17 +914,21 @@ public:
 	float z;
 	float w;
 
-	Quaternion()
-	{
-		*this = Quaternion::Identity;
-	}
+	constexpr Quaternion()
+		:x(0.0f)
+		,y(0.0f)
+		,z(0.0f)
+		,w(1.0f)
+	{}
 
 	// This directly sets the quaternion components --
 	// don't use for axis/angle
-	explicit Quaternion(float inX, float inY, float inZ, float inW)
-	{
-		Set(inX, inY, inZ, inW);
-	}
+	constexpr explicit Quaternion(float inX, float inY, float inZ, float inW)
+		:x(inX)
+		,y(inY)
+		,z(inZ)
+		,w(inW)
+	{}
 
 	// Construct the quaternion from an axis and angle
 	// It is assumed that axis is already normalized,
@@ -991,16 +1047,262 @@ public:
 	static const Quaternion Identity;
 };
 
+// Affine transform stored as the top 4x3 of a row-vector Matrix4. The last
+// column of an affine Matrix4 is always (0, 0, 0, 1), so it isn't stored:
+// rows 0-2 are the linear part and row 3 is the translation. 48 bytes
+// instead of 64, and composing/inverting skips the work on that column.
+class Affine3x4
+{
+public:
+	float mat[4][3];
+
+	constexpr Affine3x4()
+		:mat{ { 1.0f, 0.0f, 0.0f },
+			  { 0.0f, 1.0f, 0.0f },
+			  { 0.0f, 0.0f, 1.0f },
+			  { 0.0f, 0.0f, 0.0f } }
+	{}
+
+	// Element by element: the three rows of the linear part, then the
+	// translation
+	constexpr explicit Affine3x4(float m00, float m01, float m02,
+								 float m10, float m11, float m12,
+								 float m20, float m21, float m22,
+								 float tx, float ty, float tz)
+		:mat{ { m00, m01, m02 },
+			  { m10, m11, m12 },
+			  { m20, m21, m22 },
+			  { tx, ty, tz } }
+	{}
+
+	explicit Affine3x4(float inMat[4][3])
+	{
+		memcpy(mat, inMat, 12 * sizeof(float));
+	}
+
+	// Drop the last column of a Matrix4 (assumed to be 0, 0, 0, 1)
+	explicit Affine3x4(const Matrix4& m)
+	{
+		for (int i = 0; i < 4; i++)
+		{
+			mat[i][0] = m.mat[i][0];
+			mat[i][1] = m.mat[i][1];
+			mat[i][2] = m.mat[i][2];
+		}
+	}
+
+	// Cast to a const float pointer
+	const float* GetAsFloatPtr() const
+	{
+		return reinterpret_cast<const float*>(&mat[0][0]);
+	}
+
+	// Expand back out to a full Matrix4
+	Matrix4 ToMatrix4() const
+	{
+		float temp[4][4] =
+		{
+			{ mat[0][0], mat[0][1], mat[0][2], 0.0f },
+			{ mat[1][0], mat[1][1], mat[1][2], 0.0f },
+			{ mat[2][0], mat[2][1], mat[2][2], 0.0f },
+			{ mat[3][0], mat[3][1], mat[3][2], 1.0f }
+		};
+		return Matrix4(temp);
+	}
+
+	// Compose (a then b)
+	friend Affine3x4 operator*(const Affine3x4& a, const Affine3x4& b)
+	{
+#if MATH_SIMD
+		return ComposeSIMD(a, b);
+#else
+		return ComposeScalar(a, b);
+#endif
+	}
+
+#if MATH_SIMD
+	// Matrix4::MultiplySIMD's row combination on 3-wide rows. The 12 floats
+	// of each matrix are moved as three 4-float vectors, so the rows
+	// straddle vector boundaries and get shuffled into and out of place.
+	static Affine3x4 ComposeSIMD(const Affine3x4& a, const Affine3x4& b)
+	{
+		// b's rows, each with a junk fourth lane
+		const __m128 bv2 = _mm_loadu_ps(&b.mat[2][2]);
+		const __m128 b0 = _mm_loadu_ps(b.mat[0]);
+		const __m128 b1 = _mm_loadu_ps(b.mat[1]);
+		const __m128 b2 = _mm_loadu_ps(b.mat[2]);
+		const __m128 b3 = _mm_shuffle_ps(bv2, bv2, _MM_SHUFFLE(3, 3, 2, 1));
+
+		// a as (a00 a01 a02 a10) (a11 a12 a20 a21) (a22 a30 a31 a32)
+		const __m128 a0 = _mm_loadu_ps(&a.mat[0][0]);
+		const __m128 a1 = _mm_loadu_ps(&a.mat[1][1]);
+		const __m128 a2 = _mm_loadu_ps(&a.mat[2][2]);
+#define MATH_SPLAT(v, i) _mm_shuffle_ps(v, v, _MM_SHUFFLE(i, i, i, i))
+		__m128 r0 = _mm_mul_ps(MATH_SPLAT(a0, 0), b0);
+		r0 = _mm_add_ps(r0, _mm_mul_ps(MATH_SPLAT(a0, 1), b1));
+		r0 = _mm_add_ps(r0, _mm_mul_ps(MATH_SPLAT(a0, 2), b2));
+		__m128 r1 = _mm_mul_ps(MATH_SPLAT(a0, 3), b0);
+		r1 = _mm_add_ps(r1, _mm_mul_ps(MATH_SPLAT(a1, 0), b1));
+		r1 = _mm_add_ps(r1, _mm_mul_ps(MATH_SPLAT(a1, 1), b2));
+		__m128 r2 = _mm_mul_ps(MATH_SPLAT(a1, 2), b0);
+		r2 = _mm_add_ps(r2, _mm_mul_ps(MATH_SPLAT(a1, 3), b1));
+		r2 = _mm_add_ps(r2, _mm_mul_ps(MATH_SPLAT(a2, 0), b2));
+		__m128 r3 = _mm_mul_ps(MATH_SPLAT(a2, 1), b0);
+		r3 = _mm_add_ps(r3, _mm_mul_ps(MATH_SPLAT(a2, 2), b1));
+		r3 = _mm_add_ps(r3, _mm_mul_ps(MATH_SPLAT(a2, 3), b2));
+		r3 = _mm_add_ps(r3, b3);
+#undef MATH_SPLAT
+
+		// Pack the rows back into three contiguous vectors
+		const __m128 t0 = _mm_shuffle_ps(r0, r1, _MM_SHUFFLE(0, 0, 2, 2));
+		const __m128 t2 = _mm_shuffle_ps(r2, r3, _MM_SHUFFLE(0, 0, 2, 2));
+		Affine3x4 retVal;
+		_mm_storeu_ps(&retVal.mat[0][0], _mm_shuffle_ps(r0, t0, _MM_SHUFFLE(2, 0, 1, 0)));
+		_mm_storeu_ps(&retVal.mat[1][1], _mm_shuffle_ps(r1, r2, _MM_SHUFFLE(1, 0, 2, 1)));
+		_mm_storeu_ps(&retVal.mat[2][2], _mm_shuffle_ps(t2, r3, _MM_SHUFFLE(2, 1, 2, 0)));
+		return retVal;
+	}
+#endif
+
+	// Scalar compose, the reference for the SIMD version
+	static Affine3x4 ComposeScalar(const Affine3x4& a, const Affine3x4& b)
+	{
+		// Build into a local so nothing is read back from a partly written
+		// result (that defeats store forwarding and triples the cost)
+		float temp[4][3];
+		for (int i = 0; i < 4; i++)
+		{
+			const float x = a.mat[i][0];
+			const float y = a.mat[i][1];
+			const float z = a.mat[i][2];
+			temp[i][0] = x * b.mat[0][0] + y * b.mat[1][0] + z * b.mat[2][0];
+			temp[i][1] = x * b.mat[0][1] + y * b.mat[1][1] + z * b.mat[2][1];
+			temp[i][2] = x * b.mat[0][2] + y * b.mat[1][2] + z * b.mat[2][2];
+		}
+		temp[3][0] += b.mat[3][0];
+		temp[3][1] += b.mat[3][1];
+		temp[3][2] += b.mat[3][2];
+		return Affine3x4(temp);
+	}
+
+	Affine3x4& operator*=(const Affine3x4& right)
+	{
+		*this = *this * right;
+		return *this;
+	}
+
+	// General 4x4 times affine. The affine's implicit last column means the
+	// result's last column is just a's, so that column is copied not summed.
+	friend Matrix4 operator*(const Matrix4& a, const Affine3x4& b)
+	{
+		Matrix4 retVal;
+		for (int i = 0; i < 4; i++)
+		{
+			for (int j = 0; j < 3; j++)
+			{
+				retVal.mat[i][j] =
+					a.mat[i][0] * b.mat[0][j] +
+					a.mat[i][1] * b.mat[1][j] +
+					a.mat[i][2] * b.mat[2][j] +
+					a.mat[i][3] * b.mat[3][j];
+			}
+			retVal.mat[i][3] = a.mat[i][3];
+		}
+		return retVal;
+	}
+
+	// Invert any affine transform (3x3 cofactor inverse plus translation)
+	void Invert();
+
+	// Invert a transform whose 3x3 is a pure rotation (such as a look-at
+	// view matrix): transpose the rotation and rotate the negated translation
+	void InvertOrthonormal();
+
+	// Transform a point (uses the translation)
+	Vector3 TransformPoint(const Vector3& v) const
+	{
+		return Vector3(
+			v.x * mat[0][0] + v.y * mat[1][0] + v.z * mat[2][0] + mat[3][0],
+			v.x * mat[0][1] + v.y * mat[1][1] + v.z * mat[2][1] + mat[3][1],
+			v.x * mat[0][2] + v.y * mat[1][2] + v.z * mat[2][2] + mat[3][2]);
+	}
+
+	// Transform a direction (ignores the translation)
+	Vector3 TransformVector(const Vector3& v) const
+	{
+		return Vector3(
+			v.x * mat[0][0] + v.y * mat[1][0] + v.z * mat[2][0],
+			v.x * mat[0][1] + v.y * mat[1][1] + v.z * mat[2][1],
+			v.x * mat[0][2] + v.y * mat[1][2] + v.z * mat[2][2]);
+	}
+
+	constexpr Vector3 GetTranslation() const
+	{
+		return Vector3(mat[3][0], mat[3][1], mat[3][2]);
+	}
+
+	static constexpr Affine3x4 CreateScale(float xScale, float yScale, float zScale)
+	{
+		return Affine3x4(
+			xScale, 0.0f, 0.0f,
+			0.0f, yScale, 0.0f,
+			0.0f, 0.0f, zScale,
+			0.0f, 0.0f, 0.0f);
+	}
+
+	// Rotation about y-axis
+	static Affine3x4 CreateRotationY(float theta)
+	{
+		float temp[4][3] =
+		{
+			{ Math::Cos(theta), 0.0f, -Math::Sin(theta) },
+			{ 0.0f, 1.0f, 0.0f },
+			{ Math::Sin(theta), 0.0f, Math::Cos(theta) },
+			{ 0.0f, 0.0f, 0.0f }
+		};
+		return Affine3x4(temp);
+	}
+
+	// Rotation about z-axis
+	static Affine3x4 CreateRotationZ(float theta)
+	{
+		float temp[4][3] =
+		{
+			{ Math::Cos(theta), Math::Sin(theta), 0.0f },
+			{ -Math::Sin(theta), Math::Cos(theta), 0.0f },
+			{ 0.0f, 0.0f, 1.0f },
+			{ 0.0f, 0.0f, 0.0f }
+		};
+		return Affine3x4(temp);
+	}
+
+	static constexpr Affine3x4 CreateTranslation(const Vector3& trans)
+	{
+		return Affine3x4(
+			1.0f, 0.0f, 0.0f,
+			0.0f, 1.0f, 0.0f,
+			0.0f, 0.0f, 1.0f,
+			trans.x, trans.y, trans.z);
+	}
+
+	// Scale, then rotate about z, then by quaternion, then translate (the
+	// order actors use), without building any intermediate matrices
+	static Affine3x4 CreateWorld(float scale, float rotationZ,
+								 const class Quaternion& q, const Vector3& pos);
+
+	static const Affine3x4 Identity;
+};
+
 namespace Color
 {
-	static const Vector3 Black(0.0f, 0.0f, 0.0f);
-	static const Vector3 White(1.0f, 1.0f, 1.0f);
-	static const Vector3 Red(1.0f, 0.0f, 0.0f);
-	static const Vector3 Green(0.0f, 1.0f, 0.0f);
-	static const Vector3 Blue(0.0f, 0.0f, 1.0f);
-	static const Vector3 Yellow(1.0f, 1.0f, 0.0f);
-	static const Vector3 LightYellow(1.0f, 1.0f, 0.88f);
-	static const Vector3 LightBlue(0.68f, 0.85f, 0.9f);
-	static const Vector3 LightPink(1.0f, 0.71f, 0.76f);
-	static const Vector3 LightGreen(0.56f, 0.93f, 0.56f);
+	constexpr Vector3 Black(0.0f, 0.0f, 0.0f);
+	constexpr Vector3 White(1.0f, 1.0f, 1.0f);
+	constexpr Vector3 Red(1.0f, 0.0f, 0.0f);
+	constexpr Vector3 Green(0.0f, 1.0f, 0.0f);
+	constexpr Vector3 Blue(0.0f, 0.0f, 1.0f);
+	constexpr Vector3 Yellow(1.0f, 1.0f, 0.0f);
+	constexpr Vector3 LightYellow(1.0f, 1.0f, 0.88f);
+	constexpr Vector3 LightBlue(0.68f, 0.85f, 0.9f);
+	constexpr Vector3 LightPink(1.0f, 0.71f, 0.76f);
+	constexpr Vector3 LightGreen(0.56f, 0.93f, 0.56f);
 }
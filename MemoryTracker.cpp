@@ -0,0 +1,165 @@
+#include "MemoryTracker.h"
+#include <SDL/SDL_log.h>
+
+static const size_t sMB = 1024 * 1024;
+
+enum MemoryKind
+{
+	MemoryRAM,
+	MemoryVRAM
+};
+
+struct TagInfo
+{
+	const char* mName;
+	MemoryKind mKind;
+};
+
+// Indexed by MemoryTag
+static const TagInfo sTagInfo[NumMemoryTags] = {
+	{ "textures", MemoryVRAM },
+	{ "vertexbuffers", MemoryVRAM },
+	{ "staging", MemoryVRAM },
+	{ "sounds", MemoryRAM },
+	{ "fonts", MemoryRAM },
+	{ "actors", MemoryRAM },
+	{ "json", MemoryRAM },
+	{ "frame", MemoryRAM },
+};
+
+static const char* sKindNames[2] = { "ram", "vram" };
+
+// Default budgets, a little over what the shipped levels need with
+// compressed textures. Override them with --budget <name>=<MB>.
+MemoryTracker::Counter MemoryTracker::sTags[NumMemoryTags] = {
+	{ {0}, {0}, {0}, 64 * sMB },
+	{ {0}, {0}, {0}, 16 * sMB },
+	{ {0}, {0}, {0}, 40 * sMB },
+	{ {0}, {0}, {0}, 32 * sMB },
+	{ {0}, {0}, {0}, 4 * sMB },
+	{ {0}, {0}, {0}, 8 * sMB },
+	{ {0}, {0}, {0}, 4 * sMB },
+	{ {0}, {0}, {0}, 4 * sMB },
+};
+
+MemoryTracker::Counter MemoryTracker::sTotals[2] = {
+	{ {0}, {0}, {0}, 128 * sMB },
+	{ {0}, {0}, {0}, 128 * sMB },
+};
+
+
+// ============================================================================
+// ============================================================================
+void MemoryTracker::Add(MemoryTag tag, size_t bytes)
+{
+	const TagInfo& info = sTagInfo[tag];
+	Grow(sTags[tag], info.mName, bytes);
+	Grow(sTotals[info.mKind], sKindNames[info.mKind], bytes);
+}
+
+
+// ============================================================================
+// ============================================================================
+void MemoryTracker::Remove(MemoryTag tag, size_t bytes)
+{
+	Shrink(sTags[tag], bytes);
+	Shrink(sTotals[sTagInfo[tag].mKind], bytes);
+}
+
+
+// ============================================================================
+// Only the allocation that crosses the budget warns, so a tag sitting over
+// it doesn't log on every load
+// ============================================================================
+void MemoryTracker::Grow(Counter& counter, const char* name, size_t bytes)
+{
+	counter.mCount++;
+	const size_t before = counter.mBytes.fetch_add(bytes);
+	const size_t after = before + bytes;
+
+	size_t peak = counter.mPeak.load();
+	while (after > peak && !counter.mPeak.compare_exchange_weak(peak, after))
+	{
+	}
+
+	if (counter.mBudget > 0 && before <= counter.mBudget && after > counter.mBudget)
+	{
+		SDL_Log("Memory budget exceeded: %s at %.1f MB of %.1f MB", name,
+				after / static_cast<double>(sMB),
+				counter.mBudget / static_cast<double>(sMB));
+	}
+}
+
+
+// ============================================================================
+// ============================================================================
+void MemoryTracker::Shrink(Counter& counter, size_t bytes)
+{
+	counter.mCount--;
+	counter.mBytes -= bytes;
+}
+
+
+// ============================================================================
+// ============================================================================
+bool MemoryTracker::SetBudget(const std::string& name, size_t bytes)
+{
+	for (int i = 0; i < NumMemoryTags; i++)
+	{
+		if (name == sTagInfo[i].mName)
+		{
+			sTags[i].mBudget = bytes;
+			return true;
+		}
+	}
+	for (int i = 0; i < 2; i++)
+	{
+		if (name == sKindNames[i])
+		{
+			sTotals[i].mBudget = bytes;
+			return true;
+		}
+	}
+	return false;
+}
+
+
+// ============================================================================
+// ============================================================================
+static void LogCounter(const char* name, const char* kind, size_t bytes,
+					   size_t peak, size_t count, size_t budget)
+{
+	const double mb = static_cast<double>(sMB);
+	if (budget > 0)
+	{
+		SDL_Log("  %-14s %-4s %8.2f MB  peak %8.2f MB  %6u allocs  budget %7.1f MB%s",
+				name, kind, bytes / mb, peak / mb, static_cast<unsigned>(count),
+				budget / mb, bytes > budget ? "  OVER" : "");
+	}
+	else
+	{
+		SDL_Log("  %-14s %-4s %8.2f MB  peak %8.2f MB  %6u allocs", name, kind,
+				bytes / mb, peak / mb, static_cast<unsigned>(count));
+	}
+}
+
+
+// ============================================================================
+// ============================================================================
+void MemoryTracker::Dump(const char* label)
+{
+	SDL_Log("Tracked memory (%s):", label);
+	for (int i = 0; i < NumMemoryTags; i++)
+	{
+		const Counter& counter = sTags[i];
+		LogCounter(sTagInfo[i].mName, sKindNames[sTagInfo[i].mKind],
+				   counter.mBytes.load(), counter.mPeak.load(),
+				   counter.mCount.load(), counter.mBudget);
+	}
+	for (int i = 0; i < 2; i++)
+	{
+		const Counter& counter = sTotals[i];
+		LogCounter("total", sKindNames[i], counter.mBytes.load(),
+				   counter.mPeak.load(), counter.mCount.load(), counter.mBudget);
+	}
+}
@@ -0,0 +1,61 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <string>
+
+// What a tracked allocation is for. Each tag lives in either RAM or VRAM.
+enum MemoryTag
+{
+	MemoryTextures,			// VRAM, GL textures (text included)
+	MemoryVertexBuffers,	// VRAM, VertexArray vertex and index buffers
+	MemoryStaging,			// VRAM, mapped pixel buffers for texture uploads
+	MemorySounds,			// RAM, decoded sound chunks
+	MemoryFonts,			// RAM, font files shared by every point size
+	MemoryActors,			// RAM, pooled actors and components
+	MemoryJSON,				// RAM, parser file buffers and document pools
+	MemoryFrame,			// RAM, per-frame scratch buffers
+	NumMemoryTags
+};
+
+// Running byte counts per subsystem, so we can see where memory goes and
+// size the hardware we ship on. The owners of the big allocations report
+// them here rather than every allocation going through a hook. VRAM figures
+// are estimates from sizes and formats, since GL doesn't say what the driver
+// actually allocates. Each tag and each of the RAM and VRAM totals can have
+// a budget; going over one logs a warning. Add and Remove can be called
+// from any thread.
+class MemoryTracker
+{
+public:
+	static void Add(MemoryTag tag, size_t bytes);
+	static void Remove(MemoryTag tag, size_t bytes);
+
+	// Bytes held now and the most held at once so far
+	static size_t GetBytes(MemoryTag tag) { return sTags[tag].mBytes.load(); }
+	static size_t GetPeakBytes(MemoryTag tag) { return sTags[tag].mPeak.load(); }
+
+	// Budget a tag by its name (as Dump prints it), or the "ram" or "vram"
+	// total. 0 means no budget. Set budgets before loading starts, they
+	// aren't synchronized. Returns false if there's no such name.
+	static bool SetBudget(const std::string& name, size_t bytes);
+
+	// Log every tag and the totals, flagging anything over budget
+	static void Dump(const char* label);
+
+private:
+	struct Counter
+	{
+		std::atomic<size_t> mBytes;
+		std::atomic<size_t> mPeak;
+		std::atomic<size_t> mCount;
+		size_t mBudget;
+	};
+
+	// Add to a counter and warn if that took it over budget
+	static void Grow(Counter& counter, const char* name, size_t bytes);
+	static void Shrink(Counter& counter, size_t bytes);
+
+	static Counter sTags[NumMemoryTags];
+	// RAM, VRAM
+	static Counter sTotals[2];
+};
@@ -2,11 +2,7 @@
 #include "Renderer.h"
 #include "Texture.h"
 #include "VertexArray.h"
-#include <fstream>
-#include <sstream>
-#include <rapidjson/document.h>
-#include <SDL/SDL_log.h>
-#include "Math.h"
+#include "AssetPath.h"
 
 
 // ============================================================================
@@ -14,6 +10,7 @@
 Mesh::Mesh()
 	:mVertexArray(nullptr)
 	,mRadius(0.0f)
+	,mFailed(false)
 {
 }
 
@@ -27,132 +24,143 @@ Mesh::~Mesh()
 
 // ============================================================================
 // ============================================================================
-bool Mesh::Load(const std::string & fileName, Renderer* renderer)
+size_t MeshSource::GetUploadBytes() const
 {
-	std::ifstream file(fileName);
-	if (!file.is_open())
+	if (mIsBinary)
 	{
-		SDL_Log("File not found: Mesh %s", fileName.c_str());
-		return false;
+		return mBinary.GetNumVerts() * MeshBinary::VertexSize * sizeof(float) +
+			mBinary.GetNumIndices() * sizeof(unsigned int);
 	}
+	return mData.mVertices.size() * sizeof(float) +
+		mData.mIndices.size() * sizeof(unsigned int);
+}
 
-	std::stringstream fileStream;
-	fileStream << file.rdbuf();
-	std::string contents = fileStream.str();
-	rapidjson::StringStream jsonStr(contents.c_str());
-	rapidjson::Document doc;
-	doc.ParseStream(jsonStr);
 
-	if (!doc.IsObject())
+// ============================================================================
+// ============================================================================
+bool Mesh::Load(const std::string & fileName, Renderer* renderer)
+{
+	MeshSource* source = Read(fileName);
+	if (source == nullptr)
 	{
-		SDL_Log("Mesh %s is not valid json", fileName.c_str());
 		return false;
 	}
+	Upload(*source, renderer);
+	delete source;
+	return true;
+}
 
-	int ver = doc["version"].GetInt();
 
-	// Check the version
-	if (ver != 1)
+// ============================================================================
+// Prefer the compiled <file>.bin: it's memory mapped and its vertex/index
+// blobs go straight to GL. Otherwise parse the .gpmesh JSON.
+// ============================================================================
+MeshSource* Mesh::Read(const std::string& fileName)
+{
+	MeshSource* source = new MeshSource();
+	const std::string cooked = AssetPath::GetCooked(fileName, AssetPath::MeshSuffix);
+	source->mIsBinary = !cooked.empty() && source->mBinary.Open(cooked);
+	if (!source->mIsBinary && !MeshBinary::ParseJSON(fileName, source->mData))
 	{
-		SDL_Log("Mesh %s not version 1", fileName.c_str());
-		return false;
+		delete source;
+		return nullptr;
 	}
+	return source;
+}
 
-	mShaderName = doc["shader"].GetString();
-
-	// Skip the vertex format/shader for now
-	// (This is changed in a later chapter's code)
-	size_t vertSize = 8;
 
-	// Load textures
-	const rapidjson::Value& textures = doc["textures"];
-	if (!textures.IsArray() || textures.Size() < 1)
+// ============================================================================
+// ============================================================================
+std::vector<std::string> Mesh::GetTextureNames(const MeshSource& source)
+{
+	if (!source.mIsBinary)
 	{
-		SDL_Log("Mesh %s has no textures, there should be at least one", fileName.c_str());
-		return false;
+		return source.mData.mTextures;
+	}
+	std::vector<std::string> names;
+	for (size_t i = 0; i < source.mBinary.GetNumTextures(); i++)
+	{
+		names.emplace_back(source.mBinary.GetTextureName(i));
 	}
+	return names;
+}
+
 
-	for (rapidjson::SizeType i = 0; i < textures.Size(); i++)
+// ============================================================================
+// ============================================================================
+void Mesh::Upload(const MeshSource& source, Renderer* renderer)
+{
+	if (source.mIsBinary)
 	{
-		// Is this texture already loaded?
-		std::string texName = textures[i].GetString();
-		Texture* t = renderer->GetTexture(texName);
-		if (t == nullptr)
+		const MeshBinary& binary = source.mBinary;
+		mShaderName = binary.GetShaderName();
+		mRadius = binary.GetRadius();
+		for (size_t i = 0; i < binary.GetNumTextures(); i++)
 		{
-			// If it's null, use the default texture
-			t = renderer->GetTexture("Assets/Default.png");
+			AddTexture(binary.GetTextureName(i), renderer);
 		}
-		mTextures.emplace_back(t);
+		mVertexArray = new VertexArray(binary.GetVertices(), binary.GetNumVerts(),
+									   binary.GetIndices(), binary.GetNumIndices());
+		return;
 	}
 
-	// Load in the vertices
-	const rapidjson::Value& vertsJson = doc["vertices"];
-	if (!vertsJson.IsArray() || vertsJson.Size() < 1)
+	const MeshData& data = source.mData;
+	mShaderName = data.mShaderName;
+	mRadius = data.mRadius;
+	for (const auto& texName : data.mTextures)
 	{
-		SDL_Log("Mesh %s has no vertices", fileName.c_str());
-		return false;
+		AddTexture(texName, renderer);
 	}
 
-	std::vector<float> vertices;
-	vertices.reserve(vertsJson.Size() * vertSize);
-	mRadius = 0.0f;
-	for (rapidjson::SizeType i = 0; i < vertsJson.Size(); i++)
-	{
-		// For now, just assume we have 8 elements
-		const rapidjson::Value& vert = vertsJson[i];
-		if (!vert.IsArray() || vert.Size() != 8)
-		{
-			SDL_Log("Unexpected vertex format for %s", fileName.c_str());
-			return false;
-		}
+	// Now create a vertex array
+	mVertexArray =
+		new VertexArray(data.mVertices.data(),
+						static_cast<unsigned>(data.mVertices.size()) / MeshBinary::VertexSize,
+						data.mIndices.data(),
+						static_cast<unsigned>(data.mIndices.size()));
+}
 
-		Vector3 pos(vert[0].GetDouble(), vert[1].GetDouble(), vert[2].GetDouble());
-		mRadius = Math::Max(mRadius, pos.LengthSq());
 
-		// Add the floats
-		for (rapidjson::SizeType i = 0; i < vert.Size(); i++)
-		{
-			vertices.emplace_back(static_cast<float>(vert[i].GetDouble()));
-		}
-	}
+// ============================================================================
+// ============================================================================
+void Mesh::AddTexture(const std::string& texName, Renderer* renderer)
+{
+	mTextures.emplace_back(renderer->GetMeshTexture(texName));
+}
 
-	// We were computing length squared earlier
-	mRadius = Math::Sqrt(mRadius);
 
-	// Load in the indices
-	const rapidjson::Value& indJson = doc["indices"];
-	if (!indJson.IsArray() || indJson.Size() < 1)
+// ============================================================================
+// ============================================================================
+bool Mesh::IsLoaded() const
+{
+	if (mVertexArray == nullptr)
 	{
-		SDL_Log("Mesh %s has no indices", fileName.c_str());
 		return false;
 	}
-
-	std::vector<unsigned int> indices;
-	indices.reserve(indJson.Size() * 3);
-	for (rapidjson::SizeType i = 0; i < indJson.Size(); i++)
+	for (const Texture* t : mTextures)
 	{
-		const rapidjson::Value& ind = indJson[i];
-		if (!ind.IsArray() || ind.Size() != 3)
+		if (!t->IsLoaded() && !t->IsFailed())
 		{
-			SDL_Log("Invalid indices for %s", fileName.c_str());
 			return false;
 		}
-
-		indices.emplace_back(ind[0].GetUint());
-		indices.emplace_back(ind[1].GetUint());
-		indices.emplace_back(ind[2].GetUint());
 	}
-
-	// Now create a vertex array
-	mVertexArray =
-		new VertexArray(vertices.data(),
-						static_cast<unsigned>(vertices.size()) / vertSize,
-						indices.data(),
-						static_cast<unsigned>(indices.size()));
 	return true;
 }
 
 
+// ============================================================================
+// ============================================================================
+size_t Mesh::GetVRAMBytes() const
+{
+	if (mVertexArray == nullptr)
+	{
+		return 0;
+	}
+	return mVertexArray->GetNumVerts() * MeshBinary::VertexSize * sizeof(float) +
+		mVertexArray->GetNumIndices() * sizeof(unsigned int);
+}
+
+
 // ============================================================================
 // ============================================================================
 void Mesh::Unload()
@@ -1,6 +1,20 @@
 #pragma once
 #include <vector>
 #include <string>
+#include "MeshBinary.h"
+#include "AssetRefs.h"
+
+// A mesh read into memory, waiting for its GL upload: a mapped compiled
+// mesh, or the parsed JSON
+struct MeshSource
+{
+	// Bytes the upload will copy to GL
+	size_t GetUploadBytes() const;
+
+	MeshBinary mBinary;
+	MeshData mData;
+	bool mIsBinary;
+};
 
 class Mesh
 {
@@ -10,12 +24,38 @@ public:
 	// Load/unload mesh
 	bool Load(const std::string& fileName, class Renderer* renderer);
 	void Unload();
+
+	// The two halves of Load. Read only touches memory, so it can run on a
+	// loader thread (nullptr on failure); Upload creates the GL buffers and
+	// looks up the textures, so it must run on the GL thread.
+	static MeshSource* Read(const std::string& fileName);
+	void Upload(const MeshSource& source, class Renderer* renderer);
 	
-	// Get the vertex array associated with this mesh
+	// Get the vertex array associated with this mesh (nullptr until uploaded)
 	class VertexArray* GetVertexArray() { return mVertexArray; }
+
+	// Uploaded, and every one of its textures uploaded or failed
+	bool IsLoaded() const;
+
+	// Set on the GL thread when the read failed. The mesh never gets a
+	// vertex array, but is done loading and can be evicted.
+	void SetFailed() { mFailed = true; }
+	bool IsFailed() const { return mFailed; }
+
+	// Names of the textures the source refers to, so they can be requested
+	// before the mesh itself is uploaded
+	static std::vector<std::string> GetTextureNames(const MeshSource& source);
 	
 	// Get a texture from specified index
 	class Texture* GetTexture(size_t index);
+	size_t GetNumTextures() const { return mTextures.size(); }
+
+	// Size of the vertex and index buffers, 0 until uploaded
+	size_t GetVRAMBytes() const;
+
+	// Managed by the renderer, under its cache lock. The mesh holds a
+	// reference on each of its textures.
+	AssetRefs& GetRefs() { return mRefs; }
 	
 	// Get name of shader
 	const std::string& GetShaderName() const { return mShaderName; }
@@ -24,6 +64,9 @@ public:
 	float GetRadius() const { return mRadius; }
 	
 private:
+	// Look up a texture by name and add it
+	void AddTexture(const std::string& texName, class Renderer* renderer);
+	
 	// Textures associated with this mesh
 	std::vector<class Texture*> mTextures;
 	
@@ -35,4 +78,8 @@ private:
 	
 	// Stores object space bounding sphere radius
 	float mRadius;
+
+	bool mFailed;
+
+	AssetRefs mRefs;
 };
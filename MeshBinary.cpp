@@ -0,0 +1,282 @@
+#include "MeshBinary.h"
+#include "JSONParser.h"
+#include <fstream>
+#include <cstring>
+#include <SDL/SDL_log.h>
+#include "Math.h"
+
+const char MeshBinary::Magic[4] = { 'G', 'P', 'M', 'B' };
+
+static_assert(sizeof(MeshBinaryHeader) == 48, "MeshBinaryHeader layout changed");
+
+// Blobs start on 16 byte boundaries so they can be read in place
+static const uint32_t sBlobAlignment = 16;
+
+static uint32_t AlignUp(uint32_t offset)
+{
+	return (offset + sBlobAlignment - 1) & ~(sBlobAlignment - 1);
+}
+
+
+// ============================================================================
+// ============================================================================
+MeshBinary::MeshBinary()
+	:mHeader(nullptr)
+	,mVertices(nullptr)
+	,mIndices(nullptr)
+{
+}
+
+
+// ============================================================================
+// Everything in the header is checked against the file size before use, so
+// a truncated or stale file is rejected instead of read out of bounds.
+// ============================================================================
+bool MeshBinary::Open(const std::string& fileName)
+{
+	Close();
+	if (!mFile.Open(fileName))
+	{
+		return false;
+	}
+
+	const unsigned char* data = mFile.GetData();
+	const size_t size = mFile.GetSize();
+	if (size < sizeof(MeshBinaryHeader))
+	{
+		SDL_Log("Mesh %s is too small to be a compiled mesh", fileName.c_str());
+		Close();
+		return false;
+	}
+
+	const MeshBinaryHeader* header =
+		reinterpret_cast<const MeshBinaryHeader*>(data);
+	if (memcmp(header->mMagic, Magic, sizeof(Magic)) != 0 ||
+		header->mVersion != Version)
+	{
+		SDL_Log("Mesh %s is not a version %u compiled mesh", fileName.c_str(),
+				static_cast<unsigned>(Version));
+		Close();
+		return false;
+	}
+
+	if (header->mVertexSize != VertexSize)
+	{
+		SDL_Log("Mesh %s has %u floats per vertex, expected %u", fileName.c_str(),
+				static_cast<unsigned>(header->mVertexSize),
+				static_cast<unsigned>(VertexSize));
+		Close();
+		return false;
+	}
+
+	const uint64_t vertexBytes =
+		static_cast<uint64_t>(header->mNumVerts) * VertexSize * sizeof(float);
+	const uint64_t indexBytes =
+		static_cast<uint64_t>(header->mNumIndices) * sizeof(uint32_t);
+	if (static_cast<uint64_t>(header->mStringTableOffset) + header->mStringTableSize > size ||
+		static_cast<uint64_t>(header->mVertexOffset) + vertexBytes > size ||
+		static_cast<uint64_t>(header->mIndexOffset) + indexBytes > size ||
+		header->mVertexOffset % sBlobAlignment != 0 ||
+		header->mIndexOffset % sBlobAlignment != 0)
+	{
+		SDL_Log("Mesh %s is truncated or corrupt", fileName.c_str());
+		Close();
+		return false;
+	}
+
+	// Split the string table: shader name, then one entry per texture
+	const char* str = reinterpret_cast<const char*>(data + header->mStringTableOffset);
+	const char* strEnd = str + header->mStringTableSize;
+	while (str < strEnd)
+	{
+		const char* nul = static_cast<const char*>(memchr(str, '\0', strEnd - str));
+		if (nul == nullptr)
+		{
+			break;
+		}
+		mStrings.emplace_back(str);
+		str = nul + 1;
+	}
+	if (mStrings.size() != header->mNumTextures + 1)
+	{
+		SDL_Log("Mesh %s has a bad string table", fileName.c_str());
+		Close();
+		return false;
+	}
+
+	mHeader = header;
+	mVertices = reinterpret_cast<const float*>(data + header->mVertexOffset);
+	mIndices = reinterpret_cast<const unsigned int*>(data + header->mIndexOffset);
+	return true;
+}
+
+
+// ============================================================================
+// ============================================================================
+void MeshBinary::Close()
+{
+	mFile.Close();
+	mHeader = nullptr;
+	mStrings.clear();
+	mVertices = nullptr;
+	mIndices = nullptr;
+}
+
+
+// ============================================================================
+// ============================================================================
+bool MeshBinary::ParseJSON(const std::string& fileName, MeshData& outData)
+{
+	const rapidjson::Document* parsed = JSONParser::Get().Parse(fileName);
+	if (parsed == nullptr)
+	{
+		return false;
+	}
+
+	const rapidjson::Document& doc = *parsed;
+	if (!doc.IsObject())
+	{
+		SDL_Log("Mesh %s is not valid json", fileName.c_str());
+		return false;
+	}
+
+	int ver = doc["version"].GetInt();
+
+	// Check the version
+	if (ver != 1)
+	{
+		SDL_Log("Mesh %s not version 1", fileName.c_str());
+		return false;
+	}
+
+	outData.mShaderName = doc["shader"].GetString();
+
+	// Texture names
+	const rapidjson::Value& textures = doc["textures"];
+	if (!textures.IsArray() || textures.Size() < 1)
+	{
+		SDL_Log("Mesh %s has no textures, there should be at least one", fileName.c_str());
+		return false;
+	}
+
+	outData.mTextures.clear();
+	for (rapidjson::SizeType i = 0; i < textures.Size(); i++)
+	{
+		outData.mTextures.emplace_back(textures[i].GetString());
+	}
+
+	// Load in the vertices
+	const rapidjson::Value& vertsJson = doc["vertices"];
+	if (!vertsJson.IsArray() || vertsJson.Size() < 1)
+	{
+		SDL_Log("Mesh %s has no vertices", fileName.c_str());
+		return false;
+	}
+
+	std::vector<float>& vertices = outData.mVertices;
+	vertices.clear();
+	vertices.reserve(vertsJson.Size() * VertexSize);
+	float radiusSq = 0.0f;
+	for (rapidjson::SizeType i = 0; i < vertsJson.Size(); i++)
+	{
+		// For now, just assume we have 8 elements
+		const rapidjson::Value& vert = vertsJson[i];
+		if (!vert.IsArray() || vert.Size() != VertexSize)
+		{
+			SDL_Log("Unexpected vertex format for %s", fileName.c_str());
+			return false;
+		}
+
+		Vector3 pos(vert[0].GetDouble(), vert[1].GetDouble(), vert[2].GetDouble());
+		radiusSq = Math::Max(radiusSq, pos.LengthSq());
+
+		// Add the floats
+		for (rapidjson::SizeType j = 0; j < vert.Size(); j++)
+		{
+			vertices.emplace_back(static_cast<float>(vert[j].GetDouble()));
+		}
+	}
+
+	// We were computing length squared
+	outData.mRadius = Math::Sqrt(radiusSq);
+
+	// Load in the indices
+	const rapidjson::Value& indJson = doc["indices"];
+	if (!indJson.IsArray() || indJson.Size() < 1)
+	{
+		SDL_Log("Mesh %s has no indices", fileName.c_str());
+		return false;
+	}
+
+	std::vector<unsigned int>& indices = outData.mIndices;
+	indices.clear();
+	indices.reserve(indJson.Size() * 3);
+	for (rapidjson::SizeType i = 0; i < indJson.Size(); i++)
+	{
+		const rapidjson::Value& ind = indJson[i];
+		if (!ind.IsArray() || ind.Size() != 3)
+		{
+			SDL_Log("Invalid indices for %s", fileName.c_str());
+			return false;
+		}
+
+		indices.emplace_back(ind[0].GetUint());
+		indices.emplace_back(ind[1].GetUint());
+		indices.emplace_back(ind[2].GetUint());
+	}
+	return true;
+}
+
+
+// ============================================================================
+// ============================================================================
+bool MeshBinary::Write(const std::string& fileName, const MeshData& data)
+{
+	// String table
+	std::string strings = data.mShaderName;
+	strings.push_back('\0');
+	for (const auto& tex : data.mTextures)
+	{
+		strings += tex;
+		strings.push_back('\0');
+	}
+
+	MeshBinaryHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.mMagic, Magic, sizeof(Magic));
+	header.mVersion = Version;
+	header.mVertexSize = VertexSize;
+	header.mNumVerts = static_cast<uint32_t>(data.mVertices.size() / VertexSize);
+	header.mNumIndices = static_cast<uint32_t>(data.mIndices.size());
+	header.mNumTextures = static_cast<uint32_t>(data.mTextures.size());
+	header.mRadius = data.mRadius;
+	header.mStringTableOffset = sizeof(MeshBinaryHeader);
+	header.mStringTableSize = static_cast<uint32_t>(strings.size());
+	header.mVertexOffset = AlignUp(header.mStringTableOffset + header.mStringTableSize);
+	const uint32_t vertexBytes =
+		header.mNumVerts * VertexSize * static_cast<uint32_t>(sizeof(float));
+	header.mIndexOffset = AlignUp(header.mVertexOffset + vertexBytes);
+	const uint32_t indexBytes =
+		header.mNumIndices * static_cast<uint32_t>(sizeof(uint32_t));
+
+	// Lay the whole file out in memory, padding included, then write once
+	std::vector<unsigned char> out(header.mIndexOffset + indexBytes, 0);
+	memcpy(out.data(), &header, sizeof(header));
+	memcpy(out.data() + header.mStringTableOffset, strings.data(), strings.size());
+	memcpy(out.data() + header.mVertexOffset, data.mVertices.data(), vertexBytes);
+	memcpy(out.data() + header.mIndexOffset, data.mIndices.data(), indexBytes);
+
+	std::ofstream file(fileName, std::ios::binary | std::ios::trunc);
+	if (!file.is_open())
+	{
+		SDL_Log("Couldn't open %s for writing", fileName.c_str());
+		return false;
+	}
+	file.write(reinterpret_cast<const char*>(out.data()), out.size());
+	if (!file)
+	{
+		SDL_Log("Failed writing %s", fileName.c_str());
+		return false;
+	}
+	return true;
+}
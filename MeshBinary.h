@@ -0,0 +1,84 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "MappedFile.h"
+
+// CPU-side contents of a mesh, independent of GL. This is what the .gpmesh
+// JSON parses into and what the binary format is written from.
+struct MeshData
+{
+	std::string mShaderName;
+	std::vector<std::string> mTextures;
+
+	// Object space bounding sphere radius (centered on the origin)
+	float mRadius;
+
+	// Interleaved position/normal/uv, MeshBinary::VertexSize floats each
+	std::vector<float> mVertices;
+	std::vector<unsigned int> mIndices;
+};
+
+// Compiled mesh file (<name>.gpmesh.bin, written by Tools/MeshConvert):
+//   header
+//   string table: shader name, then each texture name, all NUL terminated
+//   vertex blob:  numVerts * vertexSize floats (16 byte aligned)
+//   index blob:   numIndices uint32s (16 byte aligned)
+// Little endian. A loaded file is memory mapped and the vertex/index blobs are
+// handed to GL directly, nothing is parsed or copied.
+struct MeshBinaryHeader
+{
+	char mMagic[4];
+	uint32_t mVersion;
+	uint32_t mVertexSize;
+	uint32_t mNumVerts;
+	uint32_t mNumIndices;
+	uint32_t mNumTextures;
+	float mRadius;
+	uint32_t mStringTableOffset;
+	uint32_t mStringTableSize;
+	uint32_t mVertexOffset;
+	uint32_t mIndexOffset;
+	uint32_t mReserved;
+};
+
+class MeshBinary
+{
+public:
+	static const char Magic[4];
+	static const uint32_t Version = 1;
+
+	// Floats per vertex (position, normal, uv), what VertexArray expects
+	static const uint32_t VertexSize = 8;
+
+	MeshBinary();
+
+	// Map and validate a compiled mesh. Returns false, without logging, if
+	// the file doesn't exist so callers can fall back to the JSON source.
+	bool Open(const std::string& fileName);
+	void Close();
+
+	const char* GetShaderName() const { return mStrings.empty() ? "" : mStrings[0]; }
+	size_t GetNumTextures() const { return mStrings.empty() ? 0 : mStrings.size() - 1; }
+	const char* GetTextureName(size_t index) const { return mStrings[index + 1]; }
+	float GetRadius() const { return mHeader->mRadius; }
+
+	// These point into the mapped file and are valid until Close
+	const float* GetVertices() const { return mVertices; }
+	unsigned int GetNumVerts() const { return mHeader->mNumVerts; }
+	const unsigned int* GetIndices() const { return mIndices; }
+	unsigned int GetNumIndices() const { return mHeader->mNumIndices; }
+
+	// Parse a .gpmesh (JSON) file
+	static bool ParseJSON(const std::string& fileName, MeshData& outData);
+
+	// Write data out in the compiled format
+	static bool Write(const std::string& fileName, const MeshData& data);
+
+private:
+	MappedFile mFile;
+	const MeshBinaryHeader* mHeader;
+	std::vector<const char*> mStrings;
+	const float* mVertices;
+	const unsigned int* mIndices;
+};
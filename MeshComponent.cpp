@@ -6,6 +6,10 @@
 #include "Renderer.h"
 #include "Texture.h"
 #include "VertexArray.h"
+#include "Pool.h"
+
+// Backing storage for every MeshComponent
+static Pool sMeshComponentPool(sizeof(MeshComponent), 1024, MemoryActors);
 
 
 // ============================================================================
@@ -14,6 +18,7 @@ MeshComponent::MeshComponent(Actor* owner)
 	:Component(owner)
 	,mMesh(nullptr)
 	,mTextureIndex(0)
+	,mRendererIndex(0)
 {
 	mOwner->GetGame()->GetRenderer()->AddMeshComp(this);
 }
@@ -31,14 +36,19 @@ MeshComponent::~MeshComponent()
 // ============================================================================
 void MeshComponent::Draw(Shader* shader)
 {
-	if (mMesh)
+	// The mesh may still be loading
+	if (mMesh && mMesh->GetVertexArray())
 	{
 		// Set the world transform
-		shader->SetMatrixUniform("uWorldTransform", 
+		shader->SetAffineUniform("uWorldTransform",
 			mOwner->GetWorldTransform());
 		
 		// Set the active texture
 		Texture* t = mMesh->GetTexture(mTextureIndex);
+		if (t && !t->IsLoaded())
+		{
+			t = mOwner->GetGame()->GetRenderer()->GetPlaceholderTexture();
+		}
 		if (t)
 		{
 			t->SetActive();
@@ -55,3 +65,19 @@ void MeshComponent::Draw(Shader* shader)
 					   nullptr);
 	}
 }
+
+
+// ============================================================================
+// ============================================================================
+void* MeshComponent::operator new(size_t size)
+{
+	return sMeshComponentPool.Allocate(size);
+}
+
+
+// ============================================================================
+// ============================================================================
+void MeshComponent::operator delete(void* ptr, size_t size)
+{
+	sMeshComponentPool.Free(ptr, size);
+}
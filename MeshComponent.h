@@ -8,6 +8,10 @@ public:
 	MeshComponent(class Actor* owner);
 	~MeshComponent();
 	
+	// Mesh components come from a pool so the renderer walks contiguous memory
+	static void* operator new(size_t size);
+	static void operator delete(void* ptr, size_t size);
+	
 	// Draw this mesh component
 	virtual void Draw(class Shader* shader);
 	
@@ -15,7 +19,12 @@ public:
 	virtual void SetMesh(class Mesh* mesh) { mMesh = mesh; }
 	void SetTextureIndex(size_t index) { mTextureIndex = index; }
 	
+	// Slot in the renderer's mesh component list
+	size_t GetRendererIndex() const { return mRendererIndex; }
+	void SetRendererIndex(size_t index) { mRendererIndex = index; }
+	
 protected:
 	class Mesh* mMesh;
 	size_t mTextureIndex;
+	size_t mRendererIndex;
 };
@@ -0,0 +1,134 @@
+#include "PixelBufferPool.h"
+#include "MemoryTracker.h"
+#include <GL/glew.h>
+#include <SDL/SDL_log.h>
+
+
+// ============================================================================
+// ============================================================================
+PixelBufferPool::PixelBufferPool()
+	:mBufferSize(0)
+{
+}
+
+
+// ============================================================================
+// ============================================================================
+PixelBufferPool::~PixelBufferPool()
+{
+}
+
+
+// ============================================================================
+// ============================================================================
+bool PixelBufferPool::Initialize(size_t numBuffers, size_t bufferSize)
+{
+	mBufferSize = bufferSize;
+	mBuffers.resize(numBuffers);
+	for (auto& buffer : mBuffers)
+	{
+		glGenBuffers(1, &buffer.mBufferID);
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer.mBufferID);
+		glBufferData(GL_PIXEL_UNPACK_BUFFER, static_cast<GLsizeiptr>(mBufferSize),
+					 nullptr, GL_STREAM_DRAW);
+		MemoryTracker::Add(MemoryStaging, mBufferSize);
+		buffer.mData = Map();
+		if (buffer.mData == nullptr)
+		{
+			SDL_Log("Failed to map a %u byte pixel buffer",
+					static_cast<unsigned>(mBufferSize));
+			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+			Shutdown();
+			return false;
+		}
+	}
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+	for (auto& buffer : mBuffers)
+	{
+		mFree.emplace_back(&buffer);
+	}
+	return true;
+}
+
+
+// ============================================================================
+// Deleting a buffer unmaps it, so it doesn't matter which are in use
+// ============================================================================
+void PixelBufferPool::Shutdown()
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+	for (auto& buffer : mBuffers)
+	{
+		// Buffers past one that failed to map were never created
+		if (buffer.mBufferID != 0)
+		{
+			glDeleteBuffers(1, &buffer.mBufferID);
+			MemoryTracker::Remove(MemoryStaging, mBufferSize);
+		}
+	}
+	mBuffers.clear();
+	mFree.clear();
+}
+
+
+// ============================================================================
+// ============================================================================
+PixelBufferPool::Buffer* PixelBufferPool::Acquire(size_t bytes)
+{
+	if (bytes > mBufferSize)
+	{
+		return nullptr;
+	}
+	std::lock_guard<std::mutex> lock(mMutex);
+	if (mFree.empty())
+	{
+		return nullptr;
+	}
+	Buffer* buffer = mFree.back();
+	mFree.pop_back();
+	return buffer;
+}
+
+
+// ============================================================================
+// ============================================================================
+void PixelBufferPool::Bind(Buffer* buffer)
+{
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer->mBufferID);
+	if (glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER) == GL_FALSE)
+	{
+		// The contents were lost (e.g. a mode switch); the upload reads junk
+		// but the texture still gets made
+		SDL_Log("Pixel buffer %u was corrupted while mapped", buffer->mBufferID);
+	}
+	buffer->mData = nullptr;
+}
+
+
+// ============================================================================
+// A buffer that won't map again is dropped from the pool for good
+// ============================================================================
+void PixelBufferPool::Release(Buffer* buffer)
+{
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer->mBufferID);
+	buffer->mData = Map();
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+	if (buffer->mData == nullptr)
+	{
+		SDL_Log("Failed to remap pixel buffer %u", buffer->mBufferID);
+		return;
+	}
+	std::lock_guard<std::mutex> lock(mMutex);
+	mFree.emplace_back(buffer);
+}
+
+
+// ============================================================================
+// ============================================================================
+unsigned char* PixelBufferPool::Map()
+{
+	return static_cast<unsigned char*>(
+		glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, static_cast<GLsizeiptr>(mBufferSize),
+						 GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT));
+}
@@ -0,0 +1,53 @@
+#pragma once
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+// Pixel unpack buffers (PBOs) that stay mapped while they're free, so loader
+// threads can write texture data straight into driver memory. An upload
+// from a bound buffer returns at once and the driver does the transfer in
+// the background, where one from client memory copies before returning.
+class PixelBufferPool
+{
+public:
+	struct Buffer
+	{
+		unsigned int mBufferID;
+		unsigned char* mData;
+	};
+
+	PixelBufferPool();
+	~PixelBufferPool();
+
+	// Create and map numBuffers buffers of bufferSize bytes. GL thread only.
+	bool Initialize(size_t numBuffers, size_t bufferSize);
+	void Shutdown();
+
+	// A free mapped buffer with room for bytes, or nullptr if they're all in
+	// use or bytes is too big; the caller then uploads from its own memory.
+	// Safe to call from any thread.
+	Buffer* Acquire(size_t bytes);
+
+	// Unmap the buffer and bind it to GL_PIXEL_UNPACK_BUFFER, after which
+	// texture uploads take offsets into it. GL thread only.
+	void Bind(Buffer* buffer);
+
+	// Unbind and map the buffer again for the next load. Mapping with
+	// invalidate lets the driver hand out fresh storage, so this doesn't wait
+	// for the upload still reading the old one. GL thread only.
+	void Release(Buffer* buffer);
+
+	size_t GetBufferSize() const { return mBufferSize; }
+
+private:
+	PixelBufferPool(const PixelBufferPool&) = delete;
+	PixelBufferPool& operator=(const PixelBufferPool&) = delete;
+
+	// Map a bound buffer, nullptr on failure
+	unsigned char* Map();
+
+	std::vector<Buffer> mBuffers;
+	std::vector<Buffer*> mFree;
+	std::mutex mMutex;
+	size_t mBufferSize;
+};
@@ -5,6 +5,7 @@
 #include "Game.h"
 #include "CollisionComponent.h"
 #include "CameraComponent.h"
+#include "AudioSystem.h"
 #include <SDL/SDL.h>
 
 
@@ -22,11 +23,16 @@ PlayerMove::PlayerMove(class Actor* owner)
 ,mWallRunTimer(0.0f)
 ,mPlayedSound(false)
 {
+	Game* game = mOwner->GetGame();
+	mJumpSound = game->GetSoundId("Assets/Sounds/Jump.wav");
+	mLandSound = game->GetSoundId("Assets/Sounds/Land.wav");
+	// Loops for as long as the player exists, paused whenever they aren't
+	// running. High priority so a burst of coins can't steal its voice.
+	AudioSystem* audio = game->GetAudio();
 	mRunningSFX =
-		Mix_PlayChannel(-1,
-						mOwner->GetGame()->GetSound("Assets/Sounds/Running.wav"),
-						-1);
-	Mix_Pause(mRunningSFX);
+		audio->Play(game->GetSound(game->GetSoundId("Assets/Sounds/Running.wav")),
+					-1, AudioPriorityHigh);
+	audio->SetPaused(mRunningSFX, true);
 	ChangeState(MoveState::Falling);
 }
 
@@ -35,7 +41,7 @@ PlayerMove::PlayerMove(class Actor* owner)
 // ============================================================================
 PlayerMove::~PlayerMove()
 {
-	Mix_HaltChannel(mRunningSFX);
+	mOwner->GetGame()->GetAudio()->Stop(mRunningSFX);
 }
 
 
@@ -54,16 +60,11 @@ void PlayerMove::Update(float deltaTime)
 	}
 	
 	// Sound
-	if ((mCurrentState == MoveState::OnGround && mVelocity.Length() > 50.0f) ||
+	const bool running =
+		(mCurrentState == MoveState::OnGround && mVelocity.Length() > 50.0f) ||
 		 mCurrentState == MoveState::WallClimb ||
-		 mCurrentState == MoveState::WallRun)
-	{
-		Mix_Resume(mRunningSFX);
-	}
-	else
-	{
-		Mix_Pause(mRunningSFX);
-	}
+		 mCurrentState == MoveState::WallRun;
+	mOwner->GetGame()->GetAudio()->SetPaused(mRunningSFX, !running);
 	
 	switch (mCurrentState)
 	{
@@ -191,9 +192,8 @@ void PlayerMove::UpdateJump(float deltaTime)
 	// Only play the jump sound once per jump
 	if (!mPlayedSound)
 	{
-		Mix_PlayChannel(-1,
-						mOwner->GetGame()->GetSound("Assets/Sounds/Jump.wav"),
-						0);
+		Game* game = mOwner->GetGame();
+		game->GetAudio()->Play(game->GetSound(mJumpSound));
 		mPlayedSound = true;
 	}
 	
@@ -252,9 +252,8 @@ void PlayerMove::UpdateFalling(float deltaTime)
 			CollSide::Top)
 		{
 			mVelocity.z = 0.0f;
-			Mix_PlayChannel(-1,
-							mOwner->GetGame()->GetSound("Assets/Sounds/Land.wav"),
-							0);
+			Game* game = mOwner->GetGame();
+			game->GetAudio()->Play(game->GetSound(mLandSound));
 			ChangeState(MoveState::OnGround);
 		}
 	}
@@ -327,7 +326,7 @@ void PlayerMove::UpdateWallRun(float deltaTime)
 	
 	// Fix collision on all blocks
 	bool doneRunning = false;
-	auto blocks = mOwner->GetGame()->GetBlocks();
+	const auto& blocks = mOwner->GetGame()->GetBlocks();
 	for (auto& block : blocks)
 	{
 		FixCollision(mOwner->GetCollision(), block->GetCollision());
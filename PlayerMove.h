@@ -1,6 +1,8 @@
 #pragma once
 #include "MoveComponent.h"
 #include "Math.h"
+#include "AssetId.h"
+#include "AudioSystem.h"
 
 class PlayerMove : public MoveComponent
 {
@@ -52,7 +54,9 @@ protected:
 	float mMass;
 	float mWallClimbTimer;
 	float mWallRunTimer;
-	int mRunningSFX;
+	AudioSystem::VoiceId mRunningSFX;
+	AssetId mJumpSound;
+	AssetId mLandSound;
 	bool mSpacePressed;
 	bool mPlayedSound;
 };
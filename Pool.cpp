@@ -0,0 +1,101 @@
+#include "Pool.h"
+#include <new>
+
+bool Pool::sBypass = false;
+
+
+// ============================================================================
+// Round the block size up so every block stays suitably aligned and can
+// hold a free list link
+// ============================================================================
+Pool::Pool(size_t blockSize, size_t blocksPerSlab, MemoryTag tag)
+	:mFreeList(nullptr)
+	,mObjectSize(blockSize)
+	,mBlocksPerSlab(blocksPerSlab)
+	,mNumAllocated(0)
+	,mTag(tag)
+{
+	const size_t align = alignof(std::max_align_t);
+	if (blockSize < sizeof(FreeBlock))
+	{
+		blockSize = sizeof(FreeBlock);
+	}
+	mBlockSize = (blockSize + align - 1) & ~(align - 1);
+}
+
+
+// ============================================================================
+// ============================================================================
+Pool::~Pool()
+{
+	for (auto slab : mSlabs)
+	{
+		::operator delete(slab);
+		MemoryTracker::Remove(mTag, mBlockSize * mBlocksPerSlab);
+	}
+	mSlabs.clear();
+}
+
+
+// ============================================================================
+// ============================================================================
+void* Pool::Allocate(size_t size)
+{
+	if (size != mObjectSize || sBypass)
+	{
+		MemoryTracker::Add(mTag, size);
+		return ::operator new(size);
+	}
+
+	if (!mFreeList)
+	{
+		AddSlab();
+	}
+
+	FreeBlock* block = mFreeList;
+	mFreeList = block->mNext;
+	++mNumAllocated;
+	return block;
+}
+
+
+// ============================================================================
+// ============================================================================
+void Pool::Free(void* ptr, size_t size)
+{
+	if (!ptr)
+	{
+		return;
+	}
+
+	if (size != mObjectSize || sBypass)
+	{
+		::operator delete(ptr);
+		MemoryTracker::Remove(mTag, size);
+		return;
+	}
+
+	FreeBlock* block = static_cast<FreeBlock*>(ptr);
+	block->mNext = mFreeList;
+	mFreeList = block;
+	--mNumAllocated;
+}
+
+
+// ============================================================================
+// Link the blocks back to front so they're handed out in address order
+// ============================================================================
+void Pool::AddSlab()
+{
+	unsigned char* slab =
+		static_cast<unsigned char*>(::operator new(mBlockSize * mBlocksPerSlab));
+	mSlabs.emplace_back(slab);
+	MemoryTracker::Add(mTag, mBlockSize * mBlocksPerSlab);
+
+	for (size_t i = mBlocksPerSlab; i > 0; --i)
+	{
+		FreeBlock* block = reinterpret_cast<FreeBlock*>(slab + (i - 1) * mBlockSize);
+		block->mNext = mFreeList;
+		mFreeList = block;
+	}
+}
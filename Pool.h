@@ -0,0 +1,51 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+#include "MemoryTracker.h"
+
+// Fixed-size block allocator. Memory is carved out of large slabs so objects
+// of one type end up contiguous, and freed blocks go on an intrusive free
+// list to be reused by the next allocation. Requests that don't match the
+// block size (such as a subclass) fall through to the global heap. Slabs
+// and heap fallbacks are reported to the MemoryTracker under tag.
+//
+// Not thread safe. The pooled types are actors and their components, which
+// are only created and destroyed on the game thread (level loading's worker
+// chunks place transforms, never actors).
+class Pool
+{
+public:
+	Pool(size_t blockSize, size_t blocksPerSlab, MemoryTag tag);
+	~Pool();
+
+	void* Allocate(size_t size);
+	void Free(void* ptr, size_t size);
+
+	// Send every pool's allocations to the global heap instead, to measure
+	// what pooling saves (Tools/LevelBench --compare). Only change it while
+	// no pool has anything allocated.
+	static void SetBypass(bool bypass) { sBypass = bypass; }
+
+	size_t GetNumAllocated() const { return mNumAllocated; }
+	size_t GetNumSlabs() const { return mSlabs.size(); }
+	size_t GetBlockSize() const { return mBlockSize; }
+
+private:
+	// Add another slab and thread its blocks onto the free list
+	void AddSlab();
+
+	struct FreeBlock
+	{
+		FreeBlock* mNext;
+	};
+
+	std::vector<unsigned char*> mSlabs;
+	FreeBlock* mFreeList;
+	size_t mObjectSize;
+	size_t mBlockSize;
+	size_t mBlocksPerSlab;
+	size_t mNumAllocated;
+	MemoryTag mTag;
+
+	static bool sBypass;
+};
@@ -6,15 +6,41 @@
 #include "VertexArray.h"
 #include "MeshComponent.h"
 #include "HUD.h"
+#include "ThreadPool.h"
+#include "PixelBufferPool.h"
 #include <GL/glew.h>
 #include <algorithm>
+#include <chrono>
+#include <memory>
 
 static const float sColorBits = 8.0f;
 
+// The sprite/HUD pass always works in 1024x768 virtual pixels
+static constexpr Matrix4 sSpriteViewProj =
+	Matrix4::CreateSimpleViewProj(1024.0f, 768.0f);
+
+// Most bytes of texture/mesh data handed to GL per frame. At least one upload
+// runs every frame, however big.
+static const size_t sUploadBudget = 4 * 1024 * 1024;
+
+// Pixel buffers for staging texture uploads. Each has to hold a 1024x1024
+// RGBA8 mip chain (5.3 MB); bigger textures upload from client memory.
+static const size_t sNumPixelBuffers = 6;
+static const size_t sPixelBufferSize = 6 * 1024 * 1024;
+
+// Loaded up front, stands in for textures still loading
+static const char* const sPlaceholderTexture = "Assets/Default.png";
+
 // ============================================================================
 // ============================================================================
 Renderer::Renderer(Game* game)
-	:mGame(game)
+	:mAssetScope(AssetRefs::SessionScope)
+	,mPixelBuffers(nullptr)
+	,mNumTextureUploads(0)
+	,mTextureUploadBytes(0)
+	,mTextureUploadMS(0.0)
+	,mPlaceholderTexture(nullptr)
+	,mGame(game)
 	,mSpriteShader(nullptr)
 	,mSpriteVerts(nullptr)
 	,mMeshShader(nullptr)
@@ -96,6 +122,25 @@ bool Renderer::Initialize(float width, float height)
 	// Create quad for drawing sprites
 	CreateSpriteVerts();
 
+	// Without pixel buffers textures still load, just with a copy on upload
+	mPixelBuffers = new PixelBufferPool();
+	if (!mPixelBuffers->Initialize(sNumPixelBuffers, sPixelBufferSize))
+	{
+		delete mPixelBuffers;
+		mPixelBuffers = nullptr;
+	}
+
+	// The placeholder has to be there before anything draws, so it's the one
+	// texture loaded synchronously
+	mPlaceholderTexture = new Texture();
+	if (!mPlaceholderTexture->Load(sPlaceholderTexture))
+	{
+		SDL_Log("Failed to load placeholder texture %s", sPlaceholderTexture);
+		return false;
+	}
+	mTextures.emplace(sPlaceholderTexture, mPlaceholderTexture);
+	mPlaceholderTexture->GetRefs().AddScopeRef(AssetRefs::SessionScope);
+
 	return true;
 }
 
@@ -104,6 +149,14 @@ bool Renderer::Initialize(float width, float height)
 // ============================================================================
 void Renderer::Shutdown()
 {
+	// The loader threads are gone by now, anything they finished is dropped
+	mUploads.clear();
+	if (mPixelBuffers)
+	{
+		mPixelBuffers->Shutdown();
+		delete mPixelBuffers;
+		mPixelBuffers = nullptr;
+	}
 	delete mSpriteVerts;
 	mSpriteShader->Unload();
 	delete mSpriteShader;
@@ -118,6 +171,8 @@ void Renderer::Shutdown()
 // ============================================================================
 void Renderer::UnloadData()
 {
+	std::lock_guard<std::mutex> lock(mCacheMutex);
+
 	// Destroy textures
 	for (auto i : mTextures)
 	{
@@ -133,6 +188,9 @@ void Renderer::UnloadData()
 		delete i.second;
 	}
 	mMeshes.clear();
+	mMeshLoads.clear();
+	mScopeTextures.clear();
+	mScopeMeshes.clear();
 }
 
 
@@ -140,6 +198,8 @@ void Renderer::UnloadData()
 // ============================================================================
 void Renderer::Draw()
 {
+	ProcessUploads();
+
 	// Set the clear color to light grey
 	glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
 	
@@ -186,45 +246,136 @@ void Renderer::Draw()
 // ============================================================================
 void Renderer::AddMeshComp(MeshComponent* mesh)
 {
+	mesh->SetRendererIndex(mMeshComps.size());
 	mMeshComps.emplace_back(mesh);
 }
 
 
 // ============================================================================
+// Swap the last mesh component into this one's slot. If the slot doesn't hold
+// this component, the list was already cleared in bulk.
 // ============================================================================
 void Renderer::RemoveMeshComp(MeshComponent* mesh)
 {
-	auto it = std::find(mMeshComps.begin(), mMeshComps.end(), mesh);
-	mMeshComps.erase(it);
+	const size_t index = mesh->GetRendererIndex();
+	if (index < mMeshComps.size() && mMeshComps[index] == mesh)
+	{
+		MeshComponent* last = mMeshComps.back();
+		mMeshComps[index] = last;
+		last->SetRendererIndex(index);
+		mMeshComps.pop_back();
+	}
 }
 
 
 // ============================================================================
+// The decode (or mapping) happens on a worker, which then queues the upload.
+// A failed read queues marking the texture failed instead, so it stays on the
+// placeholder but stops counting as loading.
 // ============================================================================
-Texture* Renderer::GetTexture(const std::string& fileName)
+Texture* Renderer::FindTexture(const std::string& fileName)
 {
-	Texture* tex = nullptr;
 	auto it = mTextures.find(fileName);
 	if (it != mTextures.end())
 	{
-		tex = it->second;
+		return it->second;
 	}
-	else
-	{
-		tex = new Texture();
-		if (tex->Load(fileName))
+
+	Texture* tex = new Texture();
+	mTextures.emplace(fileName, tex);
+	mGame->GetThreadPool()->Submit([this, tex, fileName]() {
+		std::shared_ptr<TextureSource> source(Texture::Read(fileName));
+		if (source)
 		{
-			mTextures.emplace(fileName, tex);
-			return tex;
+			if (mPixelBuffers)
+			{
+				Texture::Stage(*source, *mPixelBuffers);
+			}
+			QueueUpload(source->GetUploadBytes(), [this, tex, source]() {
+				typedef std::chrono::steady_clock Clock;
+				const auto start = Clock::now();
+				if (source->mStaging)
+				{
+					mPixelBuffers->Bind(source->mStaging);
+				}
+				tex->Upload(*source);
+				if (source->mStaging)
+				{
+					mPixelBuffers->Release(source->mStaging);
+					source->mStaging = nullptr;
+				}
+				mTextureUploadMS += std::chrono::duration<double, std::milli>(
+					Clock::now() - start).count();
+				mTextureUploadBytes += tex->GetVRAMBytes();
+				mNumTextureUploads++;
+			});
 		}
 		else
 		{
-			if (tex)
+			QueueUpload(0, [tex]() {
+				tex->SetFailed();
+			});
+		}
+	});
+	return tex;
+}
+
+
+// ============================================================================
+// Same as FindTexture. A mesh that fails to read never gets a vertex array
+// and is never drawn.
+// ============================================================================
+Mesh* Renderer::FindMesh(const std::string & fileName)
+{
+	auto iter = mMeshes.find(fileName);
+	if (iter != mMeshes.end())
+	{
+		return iter->second;
+	}
+
+	Mesh* m = new Mesh();
+	mMeshes.emplace(fileName, m);
+	MeshLoad load = { m, fileName, std::chrono::steady_clock::now() };
+	mMeshLoads.emplace_back(load);
+	mGame->GetThreadPool()->Submit([this, m, fileName]() {
+		std::shared_ptr<MeshSource> source(Mesh::Read(fileName));
+		if (source)
+		{
+			// Start the textures decoding now, alongside each other and the
+			// mesh upload, rather than when the upload looks them up
+			const std::vector<std::string> texNames = Mesh::GetTextureNames(*source);
 			{
-				delete tex;
+				std::lock_guard<std::mutex> lock(mCacheMutex);
+				for (const auto& texName : texNames)
+				{
+					FindTexture(texName);
+				}
 			}
-			return nullptr;
+			QueueUpload(source->GetUploadBytes(), [this, m, source]() {
+				m->Upload(*source, this);
+			});
 		}
+		else
+		{
+			QueueUpload(0, [m]() {
+				m->SetFailed();
+			});
+		}
+	});
+	return m;
+}
+
+
+// ============================================================================
+// ============================================================================
+Texture* Renderer::GetTexture(const std::string& fileName)
+{
+	std::lock_guard<std::mutex> lock(mCacheMutex);
+	Texture* tex = FindTexture(fileName);
+	if (tex->GetRefs().AddScopeRef(mAssetScope))
+	{
+		ScopeRef<Texture*> ref = { mAssetScope, tex };
+		mScopeTextures.emplace_back(ref);
 	}
 	return tex;
 }
@@ -232,29 +383,239 @@ Texture* Renderer::GetTexture(const std::string& fileName)
 
 // ============================================================================
 // ============================================================================
-Mesh* Renderer::GetMesh(const std::string & fileName)
+Mesh* Renderer::GetMesh(const std::string& fileName)
 {
-	Mesh* m = nullptr;
-	auto iter = mMeshes.find(fileName);
-	if (iter != mMeshes.end())
+	std::lock_guard<std::mutex> lock(mCacheMutex);
+	Mesh* m = FindMesh(fileName);
+	if (m->GetRefs().AddScopeRef(mAssetScope))
+	{
+		ScopeRef<Mesh*> ref = { mAssetScope, m };
+		mScopeMeshes.emplace_back(ref);
+	}
+	return m;
+}
+
+
+// ============================================================================
+// ============================================================================
+Texture* Renderer::GetMeshTexture(const std::string& fileName)
+{
+	std::lock_guard<std::mutex> lock(mCacheMutex);
+	Texture* tex = FindTexture(fileName);
+	tex->GetRefs().mCount++;
+	return tex;
+}
+
+
+// ============================================================================
+// ============================================================================
+void Renderer::SetAssetScope(unsigned int scope)
+{
+	std::lock_guard<std::mutex> lock(mCacheMutex);
+	mAssetScope = scope;
+}
+
+
+// ============================================================================
+// Meshes go first so the textures only they used are free to go after them.
+// Only loaded or failed assets are evicted: anything still loading has a
+// worker or a queued upload holding its pointer.
+// ============================================================================
+void Renderer::ReleaseAssetScope(unsigned int scope)
+{
+	if (scope == AssetRefs::SessionScope)
 	{
-		m = iter->second;
+		return;
 	}
-	else
+	std::lock_guard<std::mutex> lock(mCacheMutex);
+	for (size_t i = 0; i < mScopeMeshes.size(); )
 	{
-		m = new Mesh();
-		if (m->Load(fileName, this))
+		if (mScopeMeshes[i].mScope == scope)
 		{
-			mMeshes.emplace(fileName, m);
-			return m;
+			mScopeMeshes[i].mAsset->GetRefs().mCount--;
+			mScopeMeshes[i] = mScopeMeshes.back();
+			mScopeMeshes.pop_back();
 		}
 		else
 		{
-			delete m;
-			return nullptr;
+			i++;
 		}
 	}
-	return m;
+	for (size_t i = 0; i < mScopeTextures.size(); )
+	{
+		if (mScopeTextures[i].mScope == scope)
+		{
+			mScopeTextures[i].mAsset->GetRefs().mCount--;
+			mScopeTextures[i] = mScopeTextures.back();
+			mScopeTextures.pop_back();
+		}
+		else
+		{
+			i++;
+		}
+	}
+
+	unsigned int numMeshes = 0;
+	for (auto it = mMeshes.begin(); it != mMeshes.end(); )
+	{
+		Mesh* m = it->second;
+		if (m->GetRefs().mCount > 0 || (m->GetVertexArray() == nullptr && !m->IsFailed()))
+		{
+			++it;
+			continue;
+		}
+		for (size_t i = 0; i < m->GetNumTextures(); i++)
+		{
+			m->GetTexture(i)->GetRefs().mCount--;
+		}
+		for (size_t i = 0; i < mMeshLoads.size(); i++)
+		{
+			if (mMeshLoads[i].mMesh == m)
+			{
+				mMeshLoads[i] = mMeshLoads.back();
+				mMeshLoads.pop_back();
+				break;
+			}
+		}
+		m->Unload();
+		delete m;
+		it = mMeshes.erase(it);
+		numMeshes++;
+	}
+
+	unsigned int numTextures = 0;
+	for (auto it = mTextures.begin(); it != mTextures.end(); )
+	{
+		Texture* tex = it->second;
+		if (tex->GetRefs().mCount > 0 || (!tex->IsLoaded() && !tex->IsFailed()))
+		{
+			++it;
+			continue;
+		}
+		tex->Unload();
+		delete tex;
+		it = mTextures.erase(it);
+		numTextures++;
+	}
+
+	if (numMeshes > 0 || numTextures > 0)
+	{
+		SDL_Log("Evicted %u meshes and %u textures", numMeshes, numTextures);
+	}
+}
+
+
+// ============================================================================
+// ============================================================================
+void Renderer::LogAssetMemory()
+{
+	std::lock_guard<std::mutex> lock(mCacheMutex);
+	size_t textureBytes = 0;
+	for (const auto& it : mTextures)
+	{
+		textureBytes += it.second->GetVRAMBytes();
+	}
+	size_t meshBytes = 0;
+	for (const auto& it : mMeshes)
+	{
+		meshBytes += it.second->GetVRAMBytes();
+	}
+	SDL_Log("  textures %4u  %8.1f KB VRAM", static_cast<unsigned>(mTextures.size()),
+			textureBytes / 1024.0);
+	SDL_Log("  meshes   %4u  %8.1f KB VRAM", static_cast<unsigned>(mMeshes.size()),
+			meshBytes / 1024.0);
+}
+
+
+// ============================================================================
+// ============================================================================
+void Renderer::QueueUpload(size_t bytes, std::function<void()> upload)
+{
+	PendingUpload pending = { bytes, std::move(upload) };
+	std::lock_guard<std::mutex> lock(mUploadMutex);
+	mUploads.emplace_back(std::move(pending));
+}
+
+
+// ============================================================================
+// Take one upload at a time so the lock isn't held across GL calls
+// ============================================================================
+void Renderer::ProcessUploads()
+{
+	size_t spent = 0;
+	while (spent < sUploadBudget)
+	{
+		PendingUpload pending;
+		{
+			std::lock_guard<std::mutex> lock(mUploadMutex);
+			if (mUploads.empty())
+			{
+				ReportTextureUploads();
+				ReportMeshLoads();
+				return;
+			}
+			// Stop before an upload that would blow the budget, unless it's
+			// the first this frame
+			if (spent > 0 && spent + mUploads.front().mBytes > sUploadBudget)
+			{
+				return;
+			}
+			pending = std::move(mUploads.front());
+			mUploads.pop_front();
+		}
+		pending.mUpload();
+		spent += pending.mBytes;
+	}
+}
+
+
+// ============================================================================
+// The time is CPU time in the GL calls. For source images that includes
+// queueing glGenerateMipmap but not the GPU running it.
+// ============================================================================
+void Renderer::ReportTextureUploads()
+{
+	if (mNumTextureUploads == 0)
+	{
+		return;
+	}
+	SDL_Log("Uploaded %u textures: %.1f MB of VRAM, %.2f ms",
+			static_cast<unsigned>(mNumTextureUploads),
+			mTextureUploadBytes / (1024.0 * 1024.0), mTextureUploadMS);
+	mNumTextureUploads = 0;
+	mTextureUploadBytes = 0;
+	mTextureUploadMS = 0.0;
+}
+
+
+// ============================================================================
+// Wall clock from GetMesh to the last of its textures being uploaded (or
+// failing). A mesh that failed to read is logged and dropped.
+// ============================================================================
+void Renderer::ReportMeshLoads()
+{
+	std::lock_guard<std::mutex> lock(mCacheMutex);
+	for (size_t i = 0; i < mMeshLoads.size(); )
+	{
+		const MeshLoad& load = mMeshLoads[i];
+		if (load.mMesh->IsFailed())
+		{
+			SDL_Log("Failed to load %s", load.mFileName.c_str());
+		}
+		else if (load.mMesh->IsLoaded())
+		{
+			const double ms = std::chrono::duration<double, std::milli>(
+				std::chrono::steady_clock::now() - load.mStart).count();
+			SDL_Log("Loaded %s with its textures in %.2f ms", load.mFileName.c_str(), ms);
+		}
+		else
+		{
+			i++;
+			continue;
+		}
+		mMeshLoads[i] = mMeshLoads.back();
+		mMeshLoads.pop_back();
+	}
 }
 
 
@@ -271,9 +632,7 @@ bool Renderer::LoadShaders()
 
 	mSpriteShader->SetActive();
 	// Set the view-projection matrix
-	
-	Matrix4 viewProj = Matrix4::CreateSimpleViewProj(1024.f, 768.f);
-	mSpriteShader->SetMatrixUniform("uViewProj", viewProj);
+	mSpriteShader->SetMatrixUniform("uViewProj", sSpriteViewProj);
 
 	// Create basic mesh shader
 	mMeshShader = new Shader();
@@ -285,8 +644,8 @@ bool Renderer::LoadShaders()
 	mMeshShader->SetActive();
 	// Set the view-projection matrix
 	mView = Matrix4::Identity;
-	mProjection = 
-		Matrix4::CreateOrtho(mScreenWidth, mScreenHeight, 1000.0f, -1000.0f);
+	SetProjectionMatrix(
+		Matrix4::CreateOrtho(mScreenWidth, mScreenHeight, 1000.0f, -1000.0f));
 	mMeshShader->SetMatrixUniform("uViewProj", mView * mProjection);
 	return true;
 }
@@ -314,6 +673,16 @@ void Renderer::CreateSpriteVerts()
 }
 
 
+// ============================================================================
+// ============================================================================
+void Renderer::SetProjectionMatrix(const Matrix4& proj)
+{
+	mProjection = proj;
+	mInvProjection = proj;
+	mInvProjection.Invert();
+}
+
+
 // ============================================================================
 // ============================================================================
 Vector3 Renderer::Unproject(const Vector3& screenPoint) const
@@ -322,8 +691,10 @@ Vector3 Renderer::Unproject(const Vector3& screenPoint) const
 	Vector3 deviceCoord = screenPoint;
 	deviceCoord.x /= (mScreenWidth) * 0.5f;
 	deviceCoord.y /= (mScreenHeight) * 0.5f;
-	// Transform vector by unprojection matrix
-	Matrix4 unprojection = mView * mProjection;
-	unprojection.Invert();
+	// inverse(view * proj) = inverse(proj) * inverse(view). The projection
+	// inverse is cached and the view is rigid, so its inverse is a transpose
+	Affine3x4 invView(mView);
+	invView.InvertOrthonormal();
+	Matrix4 unprojection = mInvProjection * invView;
 	return Vector3::TransformWithPerspDiv(deviceCoord, unprojection);
 }
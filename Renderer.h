@@ -2,8 +2,13 @@
 #include <string>
 #include <vector>
 #include <unordered_map>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <chrono>
 #include <SDL/SDL.h>
 #include "Math.h"
+#include "AssetRefs.h"
 
 class Renderer
 {
@@ -19,12 +24,41 @@ public:
 
 	void AddMeshComp(class MeshComponent* mesh);
 	void RemoveMeshComp(class MeshComponent* mesh);
+	
+	// Forget every mesh component at once (for level teardown)
+	void ClearMeshComps() { mMeshComps.clear(); }
+	void ReserveMeshComps(size_t count) { mMeshComps.reserve(count); }
 
+	// Both return at once and load on the game's thread pool. The texture
+	// has no GL data (IsLoaded is false) and the mesh no vertex array until
+	// their uploads run. Safe to call from any thread.
 	class Texture* GetTexture(const std::string& fileName);
 	class Mesh* GetMesh(const std::string& fileName);
 
+	// GetTexture for a mesh's own textures: the reference taken belongs to
+	// the mesh rather than the current scope
+	class Texture* GetMeshTexture(const std::string& fileName);
+
+	// Scope that GetTexture/GetMesh take references for (see AssetRefs)
+	void SetAssetScope(unsigned int scope);
+
+	// Drop a scope's references, then unload every texture and mesh nothing
+	// references any more. Ones still loading are kept, and go on a later
+	// release once they've finished. GL thread only.
+	void ReleaseAssetScope(unsigned int scope);
+
+	// Log the textures and meshes held and the VRAM they take
+	void LogAssetMemory();
+
+	// Drawn in place of any texture that isn't loaded (or failed to load)
+	class Texture* GetPlaceholderTexture() const { return mPlaceholderTexture; }
+
+	// Hand a finished load to the GL thread. Safe to call from any thread.
+	void QueueUpload(size_t bytes, std::function<void()> upload);
+
+	// The view is expected to be rigid (a look-at), Unproject relies on it
 	void SetViewMatrix(const Matrix4& view) { mView = view; }
-	void SetProjectionMatrix(const Matrix4& proj) { mProjection = proj; }
+	void SetProjectionMatrix(const Matrix4& proj);
 
 	float GetScreenWidth() const { return mScreenWidth; }
 	float GetScreenHeight() const { return mScreenHeight; }
@@ -37,15 +71,67 @@ private:
 	bool LoadShaders();
 	void CreateSpriteVerts();
 
+	// Run queued uploads until this frame's byte budget is spent
+	void ProcessUploads();
+
+	// Look up or start loading, without taking a reference. mCacheMutex
+	// must be held.
+	class Texture* FindTexture(const std::string& fileName);
+	class Mesh* FindMesh(const std::string& fileName);
+
+	// Log what the textures uploaded since the last report cost
+	void ReportTextureUploads();
+
+	// Log each mesh that has finished loading with all its textures
+	void ReportMeshLoads();
+
 	// Hash table of textures loaded
 	std::unordered_map<std::string, class Texture*> mTextures;
 	
 	// Hash table of meshes loaded
 	std::unordered_map<std::string, class Mesh*> mMeshes;
 
+	// Meshes still loading, with when they were first asked for
+	struct MeshLoad
+	{
+		class Mesh* mMesh;
+		std::string mFileName;
+		std::chrono::steady_clock::time_point mStart;
+	};
+	std::vector<MeshLoad> mMeshLoads;
+
+	// References each open scope holds
+	std::vector<ScopeRef<class Texture*>> mScopeTextures;
+	std::vector<ScopeRef<class Mesh*>> mScopeMeshes;
+	unsigned int mAssetScope;
+
+	// Guards both tables, every asset's references and mMeshLoads, which
+	// level loads use from workers
+	std::mutex mCacheMutex;
+
 	// All mesh components drawn
 	std::vector<class MeshComponent*> mMeshComps;
 
+	// Loads that finished reading and wait for GL, oldest first
+	struct PendingUpload
+	{
+		size_t mBytes;
+		std::function<void()> mUpload;
+	};
+	std::deque<PendingUpload> mUploads;
+	std::mutex mUploadMutex;
+
+	// Staging for texture uploads, nullptr if the buffers couldn't be mapped
+	class PixelBufferPool* mPixelBuffers;
+
+	// Texture uploads since the queue last drained, which is about once per
+	// level load (GL thread only)
+	size_t mNumTextureUploads;
+	size_t mTextureUploadBytes;
+	double mTextureUploadMS;
+
+	class Texture* mPlaceholderTexture;
+
 	// Game
 	class Game* mGame;
 
@@ -62,6 +148,9 @@ private:
 	Matrix4 mView;
 	Matrix4 mProjection;
 
+	// Inverse of mProjection, kept up to date by SetProjectionMatrix
+	Matrix4 mInvProjection;
+
 	// Window
 	SDL_Window* mWindow;
 	
@@ -0,0 +1,67 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+// Bounded lock-free queue for exactly one producer thread and one consumer
+// thread. Each side only writes its own index, so neither ever waits on the
+// other; a full queue makes Push fail rather than block.
+template <typename T>
+class SPSCQueue
+{
+public:
+	// Capacity is rounded up to a power of two
+	explicit SPSCQueue(size_t capacity)
+		:mHead(0)
+		,mTail(0)
+	{
+		size_t size = 1;
+		while (size < capacity)
+		{
+			size *= 2;
+		}
+		mItems.resize(size);
+		mMask = size - 1;
+	}
+
+	// Producer only. Returns false if the queue is full.
+	bool Push(const T& item)
+	{
+		const size_t tail = mTail.load(std::memory_order_relaxed);
+		if (tail - mHead.load(std::memory_order_acquire) > mMask)
+		{
+			return false;
+		}
+		mItems[tail & mMask] = item;
+		mTail.store(tail + 1, std::memory_order_release);
+		return true;
+	}
+
+	// Consumer only. Returns false if the queue is empty.
+	bool Pop(T& outItem)
+	{
+		const size_t head = mHead.load(std::memory_order_relaxed);
+		if (head == mTail.load(std::memory_order_acquire))
+		{
+			return false;
+		}
+		outItem = mItems[head & mMask];
+		mHead.store(head + 1, std::memory_order_release);
+		return true;
+	}
+
+private:
+	SPSCQueue(const SPSCQueue&) = delete;
+	SPSCQueue& operator=(const SPSCQueue&) = delete;
+
+	std::vector<T> mItems;
+	size_t mMask;
+
+	// Padding keeps the two indices on separate cache lines, so the threads
+	// don't invalidate each other's line on every push and pop
+	char mPad0[64];
+	std::atomic<size_t> mHead;
+	char mPad1[64];
+	std::atomic<size_t> mTail;
+	char mPad2[64];
+};
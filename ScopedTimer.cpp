@@ -0,0 +1,28 @@
+#include "ScopedTimer.h"
+#include <SDL/SDL.h>
+
+
+// ============================================================================
+// ============================================================================
+ScopedTimer::ScopedTimer(const char* label)
+	:mLabel(label)
+	,mStart(SDL_GetPerformanceCounter())
+{
+}
+
+
+// ============================================================================
+// ============================================================================
+ScopedTimer::~ScopedTimer()
+{
+	SDL_Log("%s: %.3f ms", mLabel, GetElapsedMS());
+}
+
+
+// ============================================================================
+// ============================================================================
+double ScopedTimer::GetElapsedMS() const
+{
+	const Uint64 elapsed = SDL_GetPerformanceCounter() - mStart;
+	return elapsed * 1000.0 / SDL_GetPerformanceFrequency();
+}
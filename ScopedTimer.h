@@ -0,0 +1,17 @@
+#pragma once
+#include <SDL/SDL_stdinc.h>
+
+// Logs how long the enclosing scope took, for quick load-time measurements
+class ScopedTimer
+{
+public:
+	ScopedTimer(const char* label);
+	~ScopedTimer();
+
+	// Milliseconds since this timer was created
+	double GetElapsedMS() const;
+
+private:
+	const char* mLabel;
+	Uint64 mStart;
+};
@@ -1,8 +1,8 @@
 #include "Shader.h"
 #include "Texture.h"
 #include <SDL/SDL.h>
-#include <fstream>
-#include <sstream>
+#include "FileSystem.h"
+#include <vector>
 
 
 // ============================================================================
@@ -88,6 +88,17 @@ void Shader::SetMatrixUniform(const char* name, const Matrix4& matrix)
 }
 
 
+// ============================================================================
+// Affine3x4 is 4 rows of 3 floats, which with transpose is exactly a GLSL
+// mat3x4 (3 columns, 4 rows), so a row vector times it gives a vec3
+// ============================================================================
+void Shader::SetAffineUniform(const char* name, const Affine3x4& matrix)
+{
+	GLuint loc = glGetUniformLocation(mShaderProgram, name);
+	glUniformMatrix3x4fv(loc, 1, GL_TRUE, matrix.GetAsFloatPtr());
+}
+
+
 // ============================================================================
 // ============================================================================
 void Shader::SetVectorUniform(const char* name, const Vector3& vector)
@@ -115,15 +126,11 @@ bool Shader::CompileShader(const std::string& fileName,
 				   GLenum shaderType,
 				   GLuint& outShader)
 {
-	// Open file
-	std::ifstream shaderFile(fileName);
-	if (shaderFile.is_open())
+	// Read all of the text, NUL terminated
+	std::vector<char> contents;
+	if (FileSystem::ReadFile(fileName, contents))
 	{
-		// Read all of the text into a string
-		std::stringstream sstream;
-		sstream << shaderFile.rdbuf();
-		std::string contents = sstream.str();
-		const char* contentsChar = contents.c_str();
+		const char* contentsChar = contents.data();
 		
 		// Create a shader of the specified type
 		outShader = glCreateShader(shaderType);
@@ -140,7 +147,6 @@ bool Shader::CompileShader(const std::string& fileName,
 	}
 	else
 	{
-		SDL_Log("Shader file not found: %s", fileName.c_str());
 		return false;
 	}
 	
@@ -19,6 +19,9 @@ public:
 	// Sets a Matrix uniform
 	void SetMatrixUniform(const char* name, const Matrix4& matrix);
 	
+	// Sets a mat3x4 uniform from an affine transform
+	void SetAffineUniform(const char* name, const Affine3x4& matrix);
+	
 	// Sets a Vector3 uniform
 	void SetVectorUniform(const char* name, const Vector3& vector);
 	
@@ -2,7 +2,7 @@
 #version 330
 
 // Uniforms for world transform and view-proj
-uniform mat4 uWorldTransform;
+uniform mat3x4 uWorldTransform;
 uniform mat4 uViewProj;
 
 // Attribute 0 is position, 1 is normal, 2 is tex coords.
@@ -17,8 +17,10 @@ void main()
 {
 	// Convert position to homogeneous coordinates
 	vec4 pos = vec4(inPosition, 1.0);
-	// Transform to position world space, then clip space
-	gl_Position = pos * uWorldTransform * uViewProj;
+	// Transform to position world space (the world transform is a 4x3
+	// affine, so this yields a vec3), then clip space
+	vec3 worldPos = pos * uWorldTransform;
+	gl_Position = vec4(worldPos, 1.0) * uViewProj;
 
 	// Pass along the texture coordinate to frag shader
 	fragTexCoord = inTexCoord;
@@ -0,0 +1,96 @@
+#include "SoundBinary.h"
+#include <fstream>
+#include <cstring>
+#include <SDL/SDL_log.h>
+
+const char SoundBinary::Magic[4] = { 'G', 'P', 'S', 'N' };
+
+static_assert(sizeof(SoundBinaryHeader) == 32, "SoundBinaryHeader layout changed");
+
+
+// ============================================================================
+// ============================================================================
+SoundBinary::SoundBinary()
+	:mHeader(nullptr)
+	,mSamples(nullptr)
+{
+}
+
+
+// ============================================================================
+// ============================================================================
+bool SoundBinary::Open(const std::string& fileName)
+{
+	Close();
+	if (!mFile.Open(fileName))
+	{
+		return false;
+	}
+
+	const unsigned char* data = mFile.GetData();
+	const size_t size = mFile.GetSize();
+	const SoundBinaryHeader* header =
+		reinterpret_cast<const SoundBinaryHeader*>(data);
+	if (size < sizeof(SoundBinaryHeader) ||
+		memcmp(header->mMagic, Magic, sizeof(Magic)) != 0 ||
+		header->mVersion != Version)
+	{
+		SDL_Log("Sound %s is not a version %u cooked sound", fileName.c_str(),
+				static_cast<unsigned>(Version));
+		Close();
+		return false;
+	}
+
+	if (static_cast<uint64_t>(header->mDataOffset) + header->mNumBytes > size)
+	{
+		SDL_Log("Sound %s is truncated", fileName.c_str());
+		Close();
+		return false;
+	}
+
+	mHeader = header;
+	mSamples = data + header->mDataOffset;
+	return true;
+}
+
+
+// ============================================================================
+// ============================================================================
+void SoundBinary::Close()
+{
+	mFile.Close();
+	mHeader = nullptr;
+	mSamples = nullptr;
+}
+
+
+// ============================================================================
+// ============================================================================
+bool SoundBinary::Write(const std::string& fileName, int frequency, uint16_t format,
+						int channels, const void* samples, uint32_t numBytes)
+{
+	SoundBinaryHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.mMagic, Magic, sizeof(Magic));
+	header.mVersion = Version;
+	header.mFrequency = frequency;
+	header.mFormat = format;
+	header.mChannels = static_cast<uint16_t>(channels);
+	header.mNumBytes = numBytes;
+	header.mDataOffset = sizeof(header);
+
+	std::ofstream file(fileName, std::ios::binary | std::ios::trunc);
+	if (!file.is_open())
+	{
+		SDL_Log("Couldn't open %s for writing", fileName.c_str());
+		return false;
+	}
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	file.write(static_cast<const char*>(samples), numBytes);
+	if (!file)
+	{
+		SDL_Log("Failed writing %s", fileName.c_str());
+		return false;
+	}
+	return true;
+}
@@ -0,0 +1,54 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include "MappedFile.h"
+
+// Cooked sound effect (<sound>.wav.pcm, written by Tools/Cook.cpp
+// with --decode-audio):
+//   header
+//   samples, already decoded and converted to the mixer's output format
+// The samples can be handed to Mix_QuickLoad_RAW as they are, skipping the
+// WAV decode and the format conversion Mix_LoadWAV does. Music isn't cooked,
+// it streams from the .ogg (see Game::PlayMusic).
+struct SoundBinaryHeader
+{
+	char mMagic[4];
+	uint32_t mVersion;
+	uint32_t mFrequency;
+	uint16_t mFormat;
+	uint16_t mChannels;
+	uint32_t mNumBytes;
+	uint32_t mDataOffset;
+	uint32_t mReserved[2];
+};
+
+class SoundBinary
+{
+public:
+	static const char Magic[4];
+	static const uint32_t Version = 1;
+
+	SoundBinary();
+
+	// Map and validate a cooked sound. Returns false, without logging, if
+	// the file doesn't exist so callers can fall back to the source.
+	bool Open(const std::string& fileName);
+	void Close();
+
+	// The output format the samples were converted to (Mix_QuerySpec's)
+	int GetFrequency() const { return mHeader->mFrequency; }
+	uint16_t GetFormat() const { return mHeader->mFormat; }
+	int GetChannels() const { return mHeader->mChannels; }
+
+	// Points into the mapped file, valid until Close
+	const unsigned char* GetSamples() const { return mSamples; }
+	uint32_t GetNumBytes() const { return mHeader->mNumBytes; }
+
+	static bool Write(const std::string& fileName, int frequency, uint16_t format,
+					  int channels, const void* samples, uint32_t numBytes);
+
+private:
+	MappedFile mFile;
+	const SoundBinaryHeader* mHeader;
+	const unsigned char* mSamples;
+};
@@ -2,11 +2,79 @@
 #include <SOIL/SOIL.h>
 #include <GL/glew.h>
 #include <SDL/SDL.h>
+#include "AssetPath.h"
+#include "FileSystem.h"
+#include "MemoryTracker.h"
+#include <vector>
+#include <cstring>
+
+TextureSource::TextureSource()
+:mPixels(nullptr)
+,mStaging(nullptr)
+,mWidth(0)
+,mHeight(0)
+,mChannels(0)
+{
+	
+}
+
+TextureSource::~TextureSource()
+{
+	if (mPixels)
+	{
+		SOIL_free_image_data(mPixels);
+	}
+}
+
+size_t TextureSource::GetUploadBytes() const
+{
+	if (mCooked.GetNumMips() > 0)
+	{
+		size_t bytes = 0;
+		for (size_t i = 0; i < mCooked.GetNumMips(); i++)
+		{
+			bytes += mCooked.GetMipBytes(i);
+		}
+		return bytes;
+	}
+	// A full mip chain adds about a third
+	const size_t baseBytes = static_cast<size_t>(mWidth) * mHeight * mChannels;
+	return baseBytes + baseBytes / 3;
+}
+
+size_t TextureSource::GetVRAMBytes() const
+{
+	if (mCooked.IsCompressed())
+	{
+		return GetUploadBytes();
+	}
+	// Drivers store RGB8 padded out to 4 bytes a texel, and a full mip chain
+	// adds about a third
+	const size_t baseBytes = static_cast<size_t>(mWidth) * mHeight * 4;
+	return baseBytes + baseBytes / 3;
+}
+
+const unsigned char* TextureSource::GetLevelData(size_t level) const
+{
+	if (mStaging == nullptr)
+	{
+		return mCooked.GetNumMips() > 0 ? mCooked.GetMipData(level) : mPixels;
+	}
+	// Levels are staged back to back, like in the cooked file
+	size_t offset = 0;
+	for (size_t i = 0; i < level; i++)
+	{
+		offset += mCooked.GetMipBytes(i);
+	}
+	return reinterpret_cast<const unsigned char*>(offset);
+}
 
 Texture::Texture()
 :mTextureID(0)
 ,mWidth(0)
 ,mHeight(0)
+,mVRAMBytes(0)
+,mFailed(false)
 {
 	
 }
@@ -18,43 +86,172 @@ Texture::~Texture()
 
 bool Texture::Load(const std::string& fileName)
 {
-	int channels = 0;
-	
-	unsigned char* image = SOIL_load_image(fileName.c_str(),
-										   &mWidth, &mHeight, &channels, SOIL_LOAD_AUTO);
-	
-	if (image == nullptr)
+	TextureSource* source = Read(fileName);
+	if (source == nullptr)
 	{
-		SDL_Log("SOIL failed to load image %s: %s", fileName.c_str(), SOIL_last_result());
 		return false;
 	}
-	
-	int format = GL_RGB;
-	if (channels == 4)
+	Upload(*source);
+	delete source;
+	return true;
+}
+
+TextureSource* Texture::Read(const std::string& fileName)
+{
+	TextureSource* source = new TextureSource();
+	const std::string cooked = AssetPath::GetCooked(fileName, AssetPath::TextureSuffix);
+	if (!cooked.empty() && source->mCooked.Open(cooked) &&
+		source->mCooked.IsCompressed() && !GLEW_EXT_texture_compression_s3tc)
 	{
-		format = GL_RGBA;
+		// No S3TC on this GPU, the source image it is
+		SDL_Log("S3TC isn't supported, loading %s instead of %s", fileName.c_str(),
+				cooked.c_str());
+		source->mCooked.Close();
 	}
-	
+	if (source->mCooked.GetNumMips() > 0)
+	{
+		source->mWidth = source->mCooked.GetWidth();
+		source->mHeight = source->mCooked.GetHeight();
+		source->mChannels = source->mCooked.GetChannels();
+
+		// Fault the mapping in here rather than during the upload
+		volatile unsigned char touch = 0;
+		for (size_t i = 0; i < source->mCooked.GetNumMips(); i++)
+		{
+			const unsigned char* mip = source->mCooked.GetMipData(i);
+			const size_t mipBytes = source->mCooked.GetMipBytes(i);
+			for (size_t offset = 0; offset < mipBytes; offset += 4096)
+			{
+				touch = touch + mip[offset];
+			}
+		}
+		return source;
+	}
+
+	// Read through FileSystem so the image can come from the asset pack
+	std::vector<char> file;
+	if (!FileSystem::ReadFile(fileName, file))
+	{
+		delete source;
+		return nullptr;
+	}
+	source->mPixels = SOIL_load_image_from_memory(
+		reinterpret_cast<const unsigned char*>(file.data()),
+		static_cast<int>(file.size() - 1), &source->mWidth, &source->mHeight,
+		&source->mChannels, SOIL_LOAD_AUTO);
+	if (source->mPixels == nullptr)
+	{
+		SDL_Log("SOIL failed to load image %s: %s", fileName.c_str(), SOIL_last_result());
+		delete source;
+		return nullptr;
+	}
+	return source;
+}
+
+void Texture::Stage(TextureSource& source, PixelBufferPool& pool)
+{
+	const size_t numMips = source.mCooked.GetNumMips();
+	size_t bytes = static_cast<size_t>(source.mWidth) * source.mHeight * source.mChannels;
+	if (numMips > 0)
+	{
+		bytes = 0;
+		for (size_t i = 0; i < numMips; i++)
+		{
+			bytes += source.mCooked.GetMipBytes(i);
+		}
+	}
+	PixelBufferPool::Buffer* buffer = pool.Acquire(bytes);
+	if (buffer == nullptr)
+	{
+		return;
+	}
+
+	if (numMips > 0)
+	{
+		unsigned char* dst = buffer->mData;
+		for (size_t i = 0; i < numMips; i++)
+		{
+			memcpy(dst, source.mCooked.GetMipData(i), source.mCooked.GetMipBytes(i));
+			dst += source.mCooked.GetMipBytes(i);
+		}
+	}
+	else
+	{
+		memcpy(buffer->mData, source.mPixels, bytes);
+		// The decoded copy isn't needed any more
+		SOIL_free_image_data(source.mPixels);
+		source.mPixels = nullptr;
+	}
+	source.mStaging = buffer;
+}
+
+void Texture::Upload(const TextureSource& source)
+{
+	mWidth = source.mWidth;
+	mHeight = source.mHeight;
+	mVRAMBytes = source.GetVRAMBytes();
+	MemoryTracker::Add(MemoryTextures, mVRAMBytes);
+	const int format = (source.mChannels == 4) ? GL_RGBA : GL_RGB;
+
 	glGenTextures(1, &mTextureID);
 	glBindTexture(GL_TEXTURE_2D, mTextureID);
-	
-	glTexImage2D(GL_TEXTURE_2D, 0, format, mWidth, mHeight, 0, format,
-				 GL_UNSIGNED_BYTE, image);
-	
-	SOIL_free_image_data(image);
-	
-	// Generate mipmaps for texture
-	glGenerateMipmap(GL_TEXTURE_2D);
+
+	if (source.mCooked.IsCompressed())
+	{
+		// Blocks go to GL as they are; the driver never sees RGBA8
+		const size_t numMips = source.mCooked.GetNumMips();
+		const GLenum compressed = (source.mCooked.GetFormat() == TextureBC3) ?
+			GL_COMPRESSED_RGBA_S3TC_DXT5_EXT : GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+		for (size_t i = 0; i < numMips; i++)
+		{
+			glCompressedTexImage2D(GL_TEXTURE_2D, static_cast<GLint>(i), compressed,
+								   TextureBinary::GetMipSize(mWidth, i),
+								   TextureBinary::GetMipSize(mHeight, i), 0,
+								   static_cast<GLsizei>(source.mCooked.GetMipBytes(i)),
+								   source.GetLevelData(i));
+		}
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL,
+						static_cast<GLint>(numMips) - 1);
+	}
+	else if (source.mCooked.GetNumMips() > 0)
+	{
+		// Upload the cooked mip chain as is. Levels are tightly packed, so
+		// RGB rows needn't be 4 byte multiples.
+		const size_t numMips = source.mCooked.GetNumMips();
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+		for (size_t i = 0; i < numMips; i++)
+		{
+			glTexImage2D(GL_TEXTURE_2D, static_cast<GLint>(i), format,
+						 TextureBinary::GetMipSize(mWidth, i),
+						 TextureBinary::GetMipSize(mHeight, i), 0, format,
+						 GL_UNSIGNED_BYTE, source.GetLevelData(i));
+		}
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL,
+						static_cast<GLint>(numMips) - 1);
+	}
+	else
+	{
+		glTexImage2D(GL_TEXTURE_2D, 0, format, mWidth, mHeight, 0, format,
+					 GL_UNSIGNED_BYTE, source.GetLevelData(0));
+
+		// Generate mipmaps for texture
+		glGenerateMipmap(GL_TEXTURE_2D);
+	}
+
 	// Enable linear filtering
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-	
-	return true;
 }
 
 void Texture::Unload()
 {
 	glDeleteTextures(1, &mTextureID);
+	if (mVRAMBytes > 0)
+	{
+		MemoryTracker::Remove(MemoryTextures, mVRAMBytes);
+	}
+	mVRAMBytes = 0;
 }
 
 void Texture::SetActive()
@@ -66,6 +263,8 @@ void Texture::CreateFromSurface(SDL_Surface* surface)
 {
 	mWidth = surface->w;
 	mHeight = surface->h;
+	mVRAMBytes = static_cast<size_t>(mWidth) * mHeight * 4;
+	MemoryTracker::Add(MemoryTextures, mVRAMBytes);
 
 	// Generate a GL texture
 	glGenTextures(1, &mTextureID);
@@ -1,4 +1,38 @@
+#pragma once
 #include <string>
+#include "TextureBinary.h"
+#include "PixelBufferPool.h"
+#include "AssetRefs.h"
+
+// A texture read into memory, waiting for its GL upload: either a cooked
+// mip chain still in its mapping, or pixels SOIL decoded. Either may then
+// have been copied into a pixel buffer by Texture::Stage.
+struct TextureSource
+{
+	TextureSource();
+	~TextureSource();
+
+	// Bytes the upload will copy to GL
+	size_t GetUploadBytes() const;
+
+	// Bytes the GL texture will take, mips included
+	size_t GetVRAMBytes() const;
+
+	// What to hand GL for a level: a pointer into the mapping or pixels, or,
+	// once staged, an offset into the bound pixel buffer
+	const unsigned char* GetLevelData(size_t level) const;
+
+	TextureBinary mCooked;
+	unsigned char* mPixels;
+	PixelBufferPool::Buffer* mStaging;
+	int mWidth;
+	int mHeight;
+	int mChannels;
+
+private:
+	TextureSource(const TextureSource&) = delete;
+	TextureSource& operator=(const TextureSource&) = delete;
+};
 
 class Texture
 {
@@ -6,17 +40,48 @@ public:
 	Texture();
 	~Texture();
 	
+	// Read and upload in one go. Uses the cooked <fileName>.dds when there
+	// is one.
 	bool Load(const std::string& fileName);
 	void Unload();
 	void CreateFromSurface(struct SDL_Surface* surface);
+
+	// The two halves of Load. Read only touches memory, so it can run on a
+	// loader thread (nullptr on failure); Upload must run on the GL thread.
+	static TextureSource* Read(const std::string& fileName);
+	void Upload(const TextureSource& source);
+
+	// Between the two, on the loader thread: copy the source's data into a
+	// pixel buffer from pool so the upload doesn't copy it. Leaves the source
+	// as it was if no buffer is free. The buffer must be bound around Upload
+	// and released after.
+	static void Stage(TextureSource& source, PixelBufferPool& pool);
+
+	// False until the GL texture exists
+	bool IsLoaded() const { return mTextureID != 0; }
+
+	// Set on the GL thread when the read failed. A failed texture has
+	// finished loading as far as anything waiting on it is concerned: it
+	// draws as the placeholder and can be evicted.
+	void SetFailed() { mFailed = true; }
+	bool IsFailed() const { return mFailed; }
 	
 	void SetActive();
 	
 	int GetWidth() const { return mWidth; }
 	int GetHeight() const { return mHeight; }
+
+	// Estimated size of the GL texture, 0 until uploaded
+	size_t GetVRAMBytes() const { return mVRAMBytes; }
+
+	// Managed by the renderer, under its cache lock
+	AssetRefs& GetRefs() { return mRefs; }
 	
 private:
 	unsigned int mTextureID;
 	int mWidth;
 	int mHeight;
+	size_t mVRAMBytes;
+	bool mFailed;
+	AssetRefs mRefs;
 };
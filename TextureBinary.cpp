@@ -0,0 +1,599 @@
+#include "TextureBinary.h"
+#include <fstream>
+#include <vector>
+#include <cstring>
+#include <cmath>
+#include <SDL/SDL_log.h>
+
+static_assert(sizeof(TextureBinaryHeader) == 128, "TextureBinaryHeader layout changed");
+
+// DDS constants, from the DDS_HEADER documentation
+static const uint32_t sDDSMagic = 0x20534444;
+static const uint32_t sDDSHeaderSize = 124;
+static const uint32_t sDDSDCaps = 0x1;
+static const uint32_t sDDSDHeight = 0x2;
+static const uint32_t sDDSDWidth = 0x4;
+static const uint32_t sDDSDPitch = 0x8;
+static const uint32_t sDDSDPixelFormat = 0x1000;
+static const uint32_t sDDSDMipMapCount = 0x20000;
+static const uint32_t sDDSDLinearSize = 0x80000;
+static const uint32_t sDDPFAlphaPixels = 0x1;
+static const uint32_t sDDPFFourCC = 0x4;
+static const uint32_t sDDPFRGB = 0x40;
+static const uint32_t sDDSCapsComplex = 0x8;
+static const uint32_t sDDSCapsTexture = 0x1000;
+static const uint32_t sDDSCapsMipMap = 0x400000;
+static const uint32_t sFourCCDXT1 = 0x31545844;
+static const uint32_t sFourCCDXT5 = 0x35545844;
+
+// Bytes R, G, B, A in memory, which GL reads as GL_RGB(A)/GL_UNSIGNED_BYTE
+static const uint32_t sRedMask = 0x000000FF;
+static const uint32_t sGreenMask = 0x0000FF00;
+static const uint32_t sBlueMask = 0x00FF0000;
+static const uint32_t sAlphaMask = 0xFF000000;
+
+// Iterations when finding a block's principal axis
+static const int sPowerIterations = 4;
+
+static size_t MipBytes(int width, int height, int channels, size_t level)
+{
+	return static_cast<size_t>(TextureBinary::GetMipSize(width, level)) *
+		TextureBinary::GetMipSize(height, level) * channels;
+}
+
+
+// ============================================================================
+// ============================================================================
+static uint16_t To565(const float* color)
+{
+	int r = static_cast<int>(color[0] * 31.0f / 255.0f + 0.5f);
+	int g = static_cast<int>(color[1] * 63.0f / 255.0f + 0.5f);
+	int b = static_cast<int>(color[2] * 31.0f / 255.0f + 0.5f);
+	r = r < 0 ? 0 : (r > 31 ? 31 : r);
+	g = g < 0 ? 0 : (g > 63 ? 63 : g);
+	b = b < 0 ? 0 : (b > 31 ? 31 : b);
+	return static_cast<uint16_t>((r << 11) | (g << 5) | b);
+}
+
+
+// ============================================================================
+// Expand to 8 bits the way the hardware does, by replicating the top bits
+// ============================================================================
+static void From565(uint16_t packed, int* outColor)
+{
+	const int r = (packed >> 11) & 31;
+	const int g = (packed >> 5) & 63;
+	const int b = packed & 31;
+	outColor[0] = (r << 3) | (r >> 2);
+	outColor[1] = (g << 2) | (g >> 4);
+	outColor[2] = (b << 3) | (b >> 2);
+}
+
+
+// ============================================================================
+// ============================================================================
+static void WriteLE16(unsigned char* out, uint16_t value)
+{
+	out[0] = static_cast<unsigned char>(value & 0xFF);
+	out[1] = static_cast<unsigned char>(value >> 8);
+}
+
+
+// ============================================================================
+// BC1 color block: the endpoints are the texels furthest apart along the
+// block's principal axis, found by power iteration on the covariance. Always
+// uses the four color mode (color0 > color1), which BC3 requires anyway.
+// ============================================================================
+static void EncodeColorBlock(const unsigned char texels[16][4], unsigned char* out)
+{
+	float mean[3] = { 0.0f, 0.0f, 0.0f };
+	for (int i = 0; i < 16; i++)
+	{
+		for (int c = 0; c < 3; c++)
+		{
+			mean[c] += texels[i][c];
+		}
+	}
+	for (int c = 0; c < 3; c++)
+	{
+		mean[c] /= 16.0f;
+	}
+
+	float cov[6] = { 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f };
+	for (int i = 0; i < 16; i++)
+	{
+		const float r = texels[i][0] - mean[0];
+		const float g = texels[i][1] - mean[1];
+		const float b = texels[i][2] - mean[2];
+		cov[0] += r * r;
+		cov[1] += r * g;
+		cov[2] += r * b;
+		cov[3] += g * g;
+		cov[4] += g * b;
+		cov[5] += b * b;
+	}
+
+	float axis[3] = { 1.0f, 1.0f, 1.0f };
+	for (int iter = 0; iter < sPowerIterations; iter++)
+	{
+		const float x = axis[0] * cov[0] + axis[1] * cov[1] + axis[2] * cov[2];
+		const float y = axis[0] * cov[1] + axis[1] * cov[3] + axis[2] * cov[4];
+		const float z = axis[0] * cov[2] + axis[1] * cov[4] + axis[2] * cov[5];
+		float largest = fabsf(x) > fabsf(y) ? fabsf(x) : fabsf(y);
+		largest = fabsf(z) > largest ? fabsf(z) : largest;
+		if (largest < 1e-6f)
+		{
+			break;
+		}
+		axis[0] = x / largest;
+		axis[1] = y / largest;
+		axis[2] = z / largest;
+	}
+
+	int minIndex = 0;
+	int maxIndex = 0;
+	float minDot = 1e30f;
+	float maxDot = -1e30f;
+	for (int i = 0; i < 16; i++)
+	{
+		const float dot = texels[i][0] * axis[0] + texels[i][1] * axis[1] +
+			texels[i][2] * axis[2];
+		if (dot < minDot)
+		{
+			minDot = dot;
+			minIndex = i;
+		}
+		if (dot > maxDot)
+		{
+			maxDot = dot;
+			maxIndex = i;
+		}
+	}
+
+	float maxColor[3];
+	float minColor[3];
+	for (int c = 0; c < 3; c++)
+	{
+		maxColor[c] = texels[maxIndex][c];
+		minColor[c] = texels[minIndex][c];
+	}
+	uint16_t color0 = To565(maxColor);
+	uint16_t color1 = To565(minColor);
+	if (color0 < color1)
+	{
+		const uint16_t swap = color0;
+		color0 = color1;
+		color1 = swap;
+	}
+	WriteLE16(out, color0);
+	WriteLE16(out + 2, color1);
+	if (color0 == color1)
+	{
+		// Flat block, every index picks color0
+		memset(out + 4, 0, 4);
+		return;
+	}
+
+	int palette[4][3];
+	From565(color0, palette[0]);
+	From565(color1, palette[1]);
+	for (int c = 0; c < 3; c++)
+	{
+		palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+		palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+	}
+
+	uint32_t indices = 0;
+	for (int i = 0; i < 16; i++)
+	{
+		int best = 0;
+		int bestError = 0x7FFFFFFF;
+		for (int p = 0; p < 4; p++)
+		{
+			int error = 0;
+			for (int c = 0; c < 3; c++)
+			{
+				const int d = texels[i][c] - palette[p][c];
+				error += d * d;
+			}
+			if (error < bestError)
+			{
+				bestError = error;
+				best = p;
+			}
+		}
+		indices |= static_cast<uint32_t>(best) << (2 * i);
+	}
+	for (int i = 0; i < 4; i++)
+	{
+		out[4 + i] = static_cast<unsigned char>(indices >> (8 * i));
+	}
+}
+
+
+// ============================================================================
+// BC3 alpha block: the block's alpha range in eight steps
+// ============================================================================
+static void EncodeAlphaBlock(const unsigned char texels[16][4], unsigned char* out)
+{
+	int alpha0 = 0;
+	int alpha1 = 255;
+	for (int i = 0; i < 16; i++)
+	{
+		alpha0 = texels[i][3] > alpha0 ? texels[i][3] : alpha0;
+		alpha1 = texels[i][3] < alpha1 ? texels[i][3] : alpha1;
+	}
+	out[0] = static_cast<unsigned char>(alpha0);
+	out[1] = static_cast<unsigned char>(alpha1);
+	memset(out + 2, 0, 6);
+	if (alpha0 == alpha1)
+	{
+		return;
+	}
+
+	int palette[8];
+	palette[0] = alpha0;
+	palette[1] = alpha1;
+	for (int i = 1; i < 7; i++)
+	{
+		palette[i + 1] = ((7 - i) * alpha0 + i * alpha1) / 7;
+	}
+
+	uint64_t indices = 0;
+	for (int i = 0; i < 16; i++)
+	{
+		int best = 0;
+		int bestError = 256;
+		for (int p = 0; p < 8; p++)
+		{
+			const int d = texels[i][3] - palette[p];
+			const int error = d < 0 ? -d : d;
+			if (error < bestError)
+			{
+				bestError = error;
+				best = p;
+			}
+		}
+		indices |= static_cast<uint64_t>(best) << (3 * i);
+	}
+	for (int i = 0; i < 6; i++)
+	{
+		out[2 + i] = static_cast<unsigned char>(indices >> (8 * i));
+	}
+}
+
+
+// ============================================================================
+// Encode one mip level block by block. Levels smaller than a block repeat
+// their edge texels to fill it.
+// ============================================================================
+static void EncodeLevel(const unsigned char* pixels, int width, int height,
+						int channels, TextureFormat format, unsigned char* out)
+{
+	const int blocksX = (width + 3) / 4;
+	const int blocksY = (height + 3) / 4;
+	for (int by = 0; by < blocksY; by++)
+	{
+		for (int bx = 0; bx < blocksX; bx++)
+		{
+			unsigned char texels[16][4];
+			for (int i = 0; i < 16; i++)
+			{
+				int x = bx * 4 + (i & 3);
+				int y = by * 4 + (i >> 2);
+				x = x < width ? x : width - 1;
+				y = y < height ? y : height - 1;
+				const unsigned char* texel = pixels + (y * width + x) * channels;
+				texels[i][0] = texel[0];
+				texels[i][1] = texel[1];
+				texels[i][2] = texel[2];
+				texels[i][3] = channels == 4 ? texel[3] : 255;
+			}
+			if (format == TextureBC3)
+			{
+				EncodeAlphaBlock(texels, out);
+				out += 8;
+			}
+			EncodeColorBlock(texels, out);
+			out += 8;
+		}
+	}
+}
+
+
+// ============================================================================
+// ============================================================================
+TextureBinary::TextureBinary()
+	:mWidth(0)
+	,mHeight(0)
+	,mChannels(0)
+	,mFormat(TextureRGB8)
+	,mNumMips(0)
+{
+	memset(mMips, 0, sizeof(mMips));
+}
+
+
+// ============================================================================
+// Only the exact layouts Write produces are accepted. Anything else is left
+// to the source image.
+// ============================================================================
+bool TextureBinary::Open(const std::string& fileName)
+{
+	Close();
+	if (!mFile.Open(fileName))
+	{
+		return false;
+	}
+
+	const unsigned char* data = mFile.GetData();
+	const size_t size = mFile.GetSize();
+	const TextureBinaryHeader* header =
+		reinterpret_cast<const TextureBinaryHeader*>(data);
+	if (size < sizeof(TextureBinaryHeader) || header->mMagic != sDDSMagic ||
+		header->mSize != sDDSHeaderSize ||
+		header->mPixelFormat.mSize != sizeof(DDSPixelFormat))
+	{
+		SDL_Log("Texture %s is not a DDS file", fileName.c_str());
+		Close();
+		return false;
+	}
+
+	const DDSPixelFormat& format = header->mPixelFormat;
+	int channels = 0;
+	TextureFormat textureFormat = TextureRGB8;
+	if (format.mFlags & sDDPFFourCC)
+	{
+		if (format.mFourCC == sFourCCDXT1)
+		{
+			channels = 3;
+			textureFormat = TextureBC1;
+		}
+		else if (format.mFourCC == sFourCCDXT5)
+		{
+			channels = 4;
+			textureFormat = TextureBC3;
+		}
+	}
+	else if ((format.mFlags & sDDPFRGB) && format.mRBitMask == sRedMask &&
+			 format.mGBitMask == sGreenMask && format.mBBitMask == sBlueMask)
+	{
+		if (format.mRGBBitCount == 24 && !(format.mFlags & sDDPFAlphaPixels))
+		{
+			channels = 3;
+			textureFormat = TextureRGB8;
+		}
+		else if (format.mRGBBitCount == 32 && (format.mFlags & sDDPFAlphaPixels) &&
+				 format.mABitMask == sAlphaMask)
+		{
+			channels = 4;
+			textureFormat = TextureRGBA8;
+		}
+	}
+	if (channels == 0)
+	{
+		SDL_Log("Texture %s isn't RGB8/RGBA8/DXT1/DXT5", fileName.c_str());
+		Close();
+		return false;
+	}
+
+	const int width = static_cast<int>(header->mWidth);
+	const int height = static_cast<int>(header->mHeight);
+	size_t numMips = (header->mFlags & sDDSDMipMapCount) ? header->mMipMapCount : 1;
+	if (width <= 0 || height <= 0 || numMips == 0 || numMips > MaxMips)
+	{
+		SDL_Log("Texture %s has a bad size or mip count", fileName.c_str());
+		Close();
+		return false;
+	}
+
+	// Lay out the levels and make sure the file holds all of them
+	uint64_t offset = sizeof(TextureBinaryHeader);
+	for (size_t i = 0; i < numMips; i++)
+	{
+		mMips[i] = data + offset;
+		offset += GetMipBytes(textureFormat, width, height, i);
+	}
+	if (offset > size)
+	{
+		SDL_Log("Texture %s is truncated", fileName.c_str());
+		Close();
+		return false;
+	}
+
+	mWidth = width;
+	mHeight = height;
+	mChannels = channels;
+	mFormat = textureFormat;
+	mNumMips = numMips;
+	return true;
+}
+
+
+// ============================================================================
+// ============================================================================
+void TextureBinary::Close()
+{
+	mFile.Close();
+	mWidth = 0;
+	mHeight = 0;
+	mChannels = 0;
+	mFormat = TextureRGB8;
+	mNumMips = 0;
+	memset(mMips, 0, sizeof(mMips));
+}
+
+
+// ============================================================================
+// ============================================================================
+int TextureBinary::GetMipSize(int size, size_t level)
+{
+	const int mipSize = size >> level;
+	return mipSize > 0 ? mipSize : 1;
+}
+
+
+// ============================================================================
+// ============================================================================
+size_t TextureBinary::GetMipBytes(TextureFormat format, int width, int height,
+								  size_t level)
+{
+	const size_t mipWidth = static_cast<size_t>(GetMipSize(width, level));
+	const size_t mipHeight = static_cast<size_t>(GetMipSize(height, level));
+	switch (format)
+	{
+	case TextureRGB8:
+		return mipWidth * mipHeight * 3;
+	case TextureRGBA8:
+		return mipWidth * mipHeight * 4;
+	case TextureBC1:
+		return ((mipWidth + 3) / 4) * ((mipHeight + 3) / 4) * 8;
+	case TextureBC3:
+		return ((mipWidth + 3) / 4) * ((mipHeight + 3) / 4) * 16;
+	}
+	return 0;
+}
+
+
+// ============================================================================
+// Each level averages 2x2 texels of the one above, clamping at the edge for
+// odd sizes, down to 1x1. Compressed levels are encoded from those, not
+// from the compressed level above, so errors don't build up down the chain.
+// ============================================================================
+bool TextureBinary::Write(const std::string& fileName, const unsigned char* pixels,
+						  int width, int height, int channels, bool compress)
+{
+	if (width <= 0 || height <= 0 || (channels != 3 && channels != 4))
+	{
+		SDL_Log("Can't write %s: %dx%d with %d channels", fileName.c_str(),
+				width, height, channels);
+		return false;
+	}
+
+	size_t numMips = 1;
+	while ((width >> numMips) > 0 || (height >> numMips) > 0)
+	{
+		numMips++;
+	}
+	if (numMips > MaxMips)
+	{
+		SDL_Log("Can't write %s: %dx%d is too large", fileName.c_str(), width, height);
+		return false;
+	}
+	if (compress && (width % 4 != 0 || height % 4 != 0))
+	{
+		SDL_Log("Can't compress %s: %dx%d isn't a multiple of 4", fileName.c_str(),
+				width, height);
+		return false;
+	}
+	TextureFormat format = channels == 4 ? TextureRGBA8 : TextureRGB8;
+	if (compress)
+	{
+		format = channels == 4 ? TextureBC3 : TextureBC1;
+	}
+
+	// Box filter the full chain uncompressed first
+	size_t chainBytes = 0;
+	for (size_t i = 0; i < numMips; i++)
+	{
+		chainBytes += MipBytes(width, height, channels, i);
+	}
+	std::vector<unsigned char> chain(chainBytes);
+	unsigned char* level = chain.data();
+	memcpy(level, pixels, MipBytes(width, height, channels, 0));
+	for (size_t i = 1; i < numMips; i++)
+	{
+		const unsigned char* src = level;
+		const int srcW = GetMipSize(width, i - 1);
+		const int srcH = GetMipSize(height, i - 1);
+		const int dstW = GetMipSize(width, i);
+		const int dstH = GetMipSize(height, i);
+		unsigned char* dst = level + MipBytes(width, height, channels, i - 1);
+		for (int y = 0; y < dstH; y++)
+		{
+			const int y0 = y * 2 < srcH ? y * 2 : srcH - 1;
+			const int y1 = y * 2 + 1 < srcH ? y * 2 + 1 : srcH - 1;
+			for (int x = 0; x < dstW; x++)
+			{
+				const int x0 = x * 2 < srcW ? x * 2 : srcW - 1;
+				const int x1 = x * 2 + 1 < srcW ? x * 2 + 1 : srcW - 1;
+				for (int c = 0; c < channels; c++)
+				{
+					const int sum = src[(y0 * srcW + x0) * channels + c] +
+						src[(y0 * srcW + x1) * channels + c] +
+						src[(y1 * srcW + x0) * channels + c] +
+						src[(y1 * srcW + x1) * channels + c];
+					dst[(y * dstW + x) * channels + c] =
+						static_cast<unsigned char>((sum + 2) / 4);
+				}
+			}
+		}
+		level = dst;
+	}
+
+	TextureBinaryHeader header;
+	memset(&header, 0, sizeof(header));
+	header.mMagic = sDDSMagic;
+	header.mSize = sDDSHeaderSize;
+	header.mFlags = sDDSDCaps | sDDSDHeight | sDDSDWidth | sDDSDPixelFormat |
+		sDDSDMipMapCount | (compress ? sDDSDLinearSize : sDDSDPitch);
+	header.mHeight = height;
+	header.mWidth = width;
+	header.mMipMapCount = static_cast<uint32_t>(numMips);
+	header.mPixelFormat.mSize = sizeof(DDSPixelFormat);
+	if (compress)
+	{
+		header.mPitchOrLinearSize = static_cast<uint32_t>(GetMipBytes(format, width, height, 0));
+		header.mPixelFormat.mFlags = sDDPFFourCC;
+		header.mPixelFormat.mFourCC = format == TextureBC3 ? sFourCCDXT5 : sFourCCDXT1;
+	}
+	else
+	{
+		header.mPitchOrLinearSize = width * channels;
+		header.mPixelFormat.mFlags = sDDPFRGB | (channels == 4 ? sDDPFAlphaPixels : 0);
+		header.mPixelFormat.mRGBBitCount = channels * 8;
+		header.mPixelFormat.mRBitMask = sRedMask;
+		header.mPixelFormat.mGBitMask = sGreenMask;
+		header.mPixelFormat.mBBitMask = sBlueMask;
+		header.mPixelFormat.mABitMask = channels == 4 ? sAlphaMask : 0;
+	}
+	header.mCaps = sDDSCapsTexture | sDDSCapsComplex | sDDSCapsMipMap;
+
+	size_t totalBytes = sizeof(header);
+	for (size_t i = 0; i < numMips; i++)
+	{
+		totalBytes += GetMipBytes(format, width, height, i);
+	}
+	std::vector<unsigned char> out(totalBytes);
+	memcpy(out.data(), &header, sizeof(header));
+	if (compress)
+	{
+		const unsigned char* src = chain.data();
+		unsigned char* dst = out.data() + sizeof(header);
+		for (size_t i = 0; i < numMips; i++)
+		{
+			EncodeLevel(src, GetMipSize(width, i), GetMipSize(height, i), channels,
+						format, dst);
+			src += MipBytes(width, height, channels, i);
+			dst += GetMipBytes(format, width, height, i);
+		}
+	}
+	else
+	{
+		memcpy(out.data() + sizeof(header), chain.data(), chain.size());
+	}
+
+	std::ofstream file(fileName, std::ios::binary | std::ios::trunc);
+	if (!file.is_open())
+	{
+		SDL_Log("Couldn't open %s for writing", fileName.c_str());
+		return false;
+	}
+	file.write(reinterpret_cast<const char*>(out.data()), out.size());
+	if (!file)
+	{
+		SDL_Log("Failed writing %s", fileName.c_str());
+		return false;
+	}
+	return true;
+}
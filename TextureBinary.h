@@ -0,0 +1,106 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include "MappedFile.h"
+
+// DDS pixel format block
+struct DDSPixelFormat
+{
+	uint32_t mSize;
+	uint32_t mFlags;
+	uint32_t mFourCC;
+	uint32_t mRGBBitCount;
+	uint32_t mRBitMask;
+	uint32_t mGBitMask;
+	uint32_t mBBitMask;
+	uint32_t mABitMask;
+};
+
+// The "DDS " magic followed by the standard DDS_HEADER
+struct TextureBinaryHeader
+{
+	uint32_t mMagic;
+	uint32_t mSize;
+	uint32_t mFlags;
+	uint32_t mHeight;
+	uint32_t mWidth;
+	uint32_t mPitchOrLinearSize;
+	uint32_t mDepth;
+	uint32_t mMipMapCount;
+	uint32_t mReserved1[11];
+	DDSPixelFormat mPixelFormat;
+	uint32_t mCaps;
+	uint32_t mCaps2;
+	uint32_t mCaps3;
+	uint32_t mCaps4;
+	uint32_t mReserved2;
+};
+
+// How a cooked texture's texels are stored
+enum TextureFormat
+{
+	// Uncompressed, byte order R, G, B[, A]
+	TextureRGB8,
+	TextureRGBA8,
+	// S3TC: each 4x4 block of texels is 8 bytes (BC1/DXT1, opaque) or 16
+	// bytes (BC3/DXT5, with alpha)
+	TextureBC1,
+	TextureBC3
+};
+
+// Cooked texture (<image>.png.dds, written by Tools/Cook.cpp). A plain DDS
+// file holding one of the formats above with the whole mip chain, largest
+// first and tightly packed, so loading is one glTexImage2D (or
+// glCompressedTexImage2D) per level straight out of the mapped file with no
+// decode and no glGenerateMipmap.
+class TextureBinary
+{
+public:
+	// Enough levels for a 32768 texel edge
+	static const size_t MaxMips = 16;
+
+	TextureBinary();
+
+	// Map and validate a cooked texture. Returns false, without logging, if
+	// the file doesn't exist so callers can fall back to the source image.
+	bool Open(const std::string& fileName);
+	void Close();
+
+	int GetWidth() const { return mWidth; }
+	int GetHeight() const { return mHeight; }
+	// 3 or 4: what the texture decodes to, compressed or not
+	int GetChannels() const { return mChannels; }
+	TextureFormat GetFormat() const { return mFormat; }
+	bool IsCompressed() const { return mFormat == TextureBC1 || mFormat == TextureBC3; }
+	size_t GetNumMips() const { return mNumMips; }
+
+	// Pixels (or blocks) of one mip level, valid until Close
+	const unsigned char* GetMipData(size_t level) const { return mMips[level]; }
+	size_t GetMipBytes(size_t level) const
+	{
+		return GetMipBytes(mFormat, mWidth, mHeight, level);
+	}
+
+	// Edge length of a mip level (glGenerateMipmap's rounding)
+	static int GetMipSize(int size, size_t level);
+
+	// Size of a mip level in a given format. Compressed levels round up to
+	// whole blocks, so the 2x2 and 1x1 levels still take one block each.
+	static size_t GetMipBytes(TextureFormat format, int width, int height,
+							  size_t level);
+
+	// Write 3 or 4 channel pixels along with a box filtered mip chain. With
+	// compress, each level is then encoded to BC1 (3 channels) or BC3 (4);
+	// that needs both edges to be multiples of 4.
+	static bool Write(const std::string& fileName, const unsigned char* pixels,
+					  int width, int height, int channels, bool compress);
+
+private:
+	MappedFile mFile;
+	int mWidth;
+	int mHeight;
+	int mChannels;
+	TextureFormat mFormat;
+	size_t mNumMips;
+	const unsigned char* mMips[MaxMips];
+};
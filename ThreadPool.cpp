@@ -0,0 +1,148 @@
+#include "ThreadPool.h"
+#include <atomic>
+
+namespace
+{
+	// Shared between ParallelFor and its helper jobs. Helpers that only get
+	// to run after the caller has returned find no chunks left and exit, so
+	// the state is reference counted rather than on the caller's stack.
+	struct ParallelForState
+	{
+		std::function<void(size_t, size_t)> mFn;
+		size_t mCount;
+		size_t mChunkSize;
+		size_t mNumChunks;
+		std::atomic<size_t> mNextChunk;
+		size_t mChunksDone;
+		std::mutex mMutex;
+		std::condition_variable mDone;
+
+		// Run chunks until there are none left to claim
+		void Work()
+		{
+			size_t chunk;
+			while ((chunk = mNextChunk.fetch_add(1)) < mNumChunks)
+			{
+				const size_t begin = chunk * mChunkSize;
+				const size_t end = (begin + mChunkSize < mCount) ? begin + mChunkSize : mCount;
+				mFn(begin, end);
+
+				std::lock_guard<std::mutex> lock(mMutex);
+				if (++mChunksDone == mNumChunks)
+				{
+					mDone.notify_all();
+				}
+			}
+		}
+	};
+}
+
+
+// ============================================================================
+// ============================================================================
+ThreadPool::ThreadPool(unsigned int numThreads)
+	:mStopping(false)
+{
+	if (numThreads == 0)
+	{
+		const unsigned int cores = std::thread::hardware_concurrency();
+		numThreads = (cores > 1) ? cores - 1 : 1;
+	}
+	mThreads.reserve(numThreads);
+	for (unsigned int i = 0; i < numThreads; i++)
+	{
+		mThreads.emplace_back(&ThreadPool::WorkerLoop, this);
+	}
+}
+
+
+// ============================================================================
+// ============================================================================
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mStopping = true;
+		mJobs.clear();
+	}
+	mJobReady.notify_all();
+	for (auto& thread : mThreads)
+	{
+		thread.join();
+	}
+}
+
+
+// ============================================================================
+// ============================================================================
+void ThreadPool::Submit(std::function<void()> job)
+{
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mJobs.emplace_back(std::move(job));
+	}
+	mJobReady.notify_one();
+}
+
+
+// ============================================================================
+// Jobs run outside the lock so the workers only contend on the queue itself
+// ============================================================================
+void ThreadPool::WorkerLoop()
+{
+	for (;;)
+	{
+		std::function<void()> job;
+		{
+			std::unique_lock<std::mutex> lock(mMutex);
+			mJobReady.wait(lock, [this]() { return mStopping || !mJobs.empty(); });
+			if (mStopping)
+			{
+				return;
+			}
+			job = std::move(mJobs.front());
+			mJobs.pop_front();
+		}
+		job();
+	}
+}
+
+
+// ============================================================================
+// ============================================================================
+void ThreadPool::ParallelFor(size_t count, size_t chunkSize,
+							 std::function<void(size_t, size_t)> fn)
+{
+	if (count == 0)
+	{
+		return;
+	}
+	if (chunkSize == 0)
+	{
+		chunkSize = 1;
+	}
+	const size_t numChunks = (count + chunkSize - 1) / chunkSize;
+	if (numChunks == 1)
+	{
+		fn(0, count);
+		return;
+	}
+
+	auto state = std::make_shared<ParallelForState>();
+	state->mFn = std::move(fn);
+	state->mCount = count;
+	state->mChunkSize = chunkSize;
+	state->mNumChunks = numChunks;
+	state->mNextChunk = 0;
+	state->mChunksDone = 0;
+
+	const size_t numHelpers = (numChunks - 1 < mThreads.size()) ? numChunks - 1 : mThreads.size();
+	for (size_t i = 0; i < numHelpers; i++)
+	{
+		Submit([state]() { state->Work(); });
+	}
+	state->Work();
+
+	std::unique_lock<std::mutex> lock(state->mMutex);
+	state->mDone.wait(lock, [&state]() { return state->mChunksDone == state->mNumChunks; });
+}
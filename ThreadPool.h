@@ -0,0 +1,56 @@
+#pragma once
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads pulling jobs off one shared queue. Used for
+// anything that can run away from the main thread: file reads, decoding,
+// parsing. Jobs must not touch GL or the game's actors.
+class ThreadPool
+{
+public:
+	// 0 threads means one per core, less one for the main thread
+	explicit ThreadPool(unsigned int numThreads = 0);
+
+	// Waits for the running jobs. Jobs still queued are dropped.
+	~ThreadPool();
+
+	void Submit(std::function<void()> job);
+
+	// Run fn on a worker, returning a future for its result
+	template <typename Fn>
+	auto Async(Fn fn) -> std::future<decltype(fn())>
+	{
+		typedef decltype(fn()) Result;
+		auto task = std::make_shared<std::packaged_task<Result()>>(fn);
+		std::future<Result> result = task->get_future();
+		Submit([task]() { (*task)(); });
+		return result;
+	}
+
+	// Split [0, count) into chunks of chunkSize and call fn(begin, end) on
+	// each, spread over the workers and the calling thread. Returns once
+	// every chunk has run. The caller works through chunks itself, so this
+	// still finishes if every worker is busy with other jobs.
+	void ParallelFor(size_t count, size_t chunkSize,
+					 std::function<void(size_t, size_t)> fn);
+
+	size_t GetNumThreads() const { return mThreads.size(); }
+
+private:
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	void WorkerLoop();
+
+	std::vector<std::thread> mThreads;
+	std::deque<std::function<void()>> mJobs;
+	std::mutex mMutex;
+	std::condition_variable mJobReady;
+	bool mStopping;
+};
@@ -0,0 +1,691 @@
+// parkour-cook: compiles everything under Assets/ into the cooked forms the
+// game loads in preference to the sources (see AssetPath.h):
+//   .gpmesh         -> .gpmesh.bin   (MeshBinary)
+//   level .json     -> .json.bin     (LevelBinary)
+//   .png            -> .png.dds      (TextureBinary, full mip chain, BC1/BC3
+//                                     with --compress-textures)
+//   .wav            -> .wav.pcm      (SoundBinary, only with --decode-audio)
+// Cooking is incremental. CookManifest.txt in the asset root records a key
+// per source: a hash of its contents, the cooker version and the output
+// format version. Sources whose key is unchanged and whose output exists are
+// skipped.
+//
+// Build from the repo root with the game's include paths:
+//   g++ -std=c++14 -O2 <includes> -o parkour-cook Tools/Cook.cpp AssetPath.cpp
+//       MeshBinary.cpp LevelBinary.cpp TextureBinary.cpp SoundBinary.cpp
+//       JSONParser.cpp MemoryTracker.cpp FileSystem.cpp AssetPack.cpp LZ4.cpp
+//       MappedFile.cpp -lSOIL -lSDL2_mixer -lSDL2
+//   (cl /O2 /EHsc with the same sources and SOIL.lib SDL2_mixer.lib SDL2.lib)
+//
+// Usage: parkour-cook [--force] [--decode-audio] [--compress-textures]
+//                     [--compare] [assetRoot]
+//   --force         recook everything, ignoring the manifest
+//   --decode-audio  also pre-decode sounds to the mixer's output format
+//   --compress-textures
+//                   block compress textures (BC1 opaque, BC3 with alpha):
+//                   a quarter to a sixth of the VRAM and upload bytes, at
+//                   some loss. Sizes that aren't multiples of 4 stay RGB(A)8.
+//   --compare       afterwards, time loading every asset from its source and
+//                   from its cooked form (CPU side only, best of several runs)
+// The game's --raw switch ignores cooked assets, so its "Startup load" and
+// "Level load" timings can be compared between the two.
+#include "../AssetPath.h"
+#include "../MeshBinary.h"
+#include "../LevelBinary.h"
+#include "../TextureBinary.h"
+#include "../SoundBinary.h"
+#include <SOIL/SOIL.h>
+#include <SDL/SDL.h>
+#include <SDL/SDL_mixer.h>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <string>
+#include <vector>
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <dirent.h>
+#include <sys/stat.h>
+#endif
+
+// Bump whenever a change to the cooker should invalidate every output
+static const uint32_t sCookerVersion = 1;
+
+static const char* const sManifestName = "CookManifest.txt";
+
+// Must match the Mix_OpenAudio call in Game.cpp. The game checks the format
+// of each cooked sound and falls back to the source if they differ.
+static const int sFrequency = 44100;
+static const int sNumChannels = 2;
+static const int sChunkSize = 2048;
+
+static const int sCompareRuns = 5;
+
+// Stops the compiler from skipping the reads being timed
+static volatile unsigned gSink = 0;
+
+enum AssetType
+{
+	AssetMesh,
+	AssetLevel,
+	AssetTexture,
+	AssetSound,
+	NumAssetTypes
+};
+
+static const char* const sTypeNames[NumAssetTypes] =
+{
+	"meshes", "levels", "textures", "sounds"
+};
+
+struct Asset
+{
+	std::string mSource;
+	std::string mCooked;
+	AssetType mType;
+	// Textures only: cook to BC1/BC3
+	bool mCompress;
+};
+
+
+// ============================================================================
+// ============================================================================
+static bool EndsWith(const std::string& str, const char* suffix)
+{
+	const size_t len = strlen(suffix);
+	return str.size() >= len && str.compare(str.size() - len, len, suffix) == 0;
+}
+
+
+// ============================================================================
+// Every file under dir, recursively, with '/' separators
+// ============================================================================
+static void ListFiles(const std::string& dir, std::vector<std::string>& outFiles)
+{
+#ifdef _WIN32
+	WIN32_FIND_DATAA findData;
+	HANDLE find = FindFirstFileA((dir + "/*").c_str(), &findData);
+	if (find == INVALID_HANDLE_VALUE)
+	{
+		return;
+	}
+	do
+	{
+		const std::string name = findData.cFileName;
+		if (name == "." || name == "..")
+		{
+			continue;
+		}
+		if (findData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)
+		{
+			ListFiles(dir + "/" + name, outFiles);
+		}
+		else
+		{
+			outFiles.emplace_back(dir + "/" + name);
+		}
+	} while (FindNextFileA(find, &findData));
+	FindClose(find);
+#else
+	DIR* d = opendir(dir.c_str());
+	if (d == nullptr)
+	{
+		return;
+	}
+	while (dirent* entry = readdir(d))
+	{
+		const std::string name = entry->d_name;
+		if (name == "." || name == "..")
+		{
+			continue;
+		}
+		const std::string path = dir + "/" + name;
+		struct stat info;
+		if (stat(path.c_str(), &info) != 0)
+		{
+			continue;
+		}
+		if (S_ISDIR(info.st_mode))
+		{
+			ListFiles(path, outFiles);
+		}
+		else
+		{
+			outFiles.emplace_back(path);
+		}
+	}
+	closedir(d);
+#endif
+}
+
+
+// ============================================================================
+// ============================================================================
+static bool FileExists(const std::string& fileName)
+{
+	std::ifstream file(fileName, std::ios::binary);
+	return file.is_open();
+}
+
+
+// ============================================================================
+// 64-bit FNV-1a, chained through hash so several buffers make one key
+// ============================================================================
+static uint64_t Hash(const void* data, size_t size, uint64_t hash = 0xCBF29CE484222325ULL)
+{
+	const unsigned char* bytes = static_cast<const unsigned char*>(data);
+	for (size_t i = 0; i < size; i++)
+	{
+		hash ^= bytes[i];
+		hash *= 0x100000001B3ULL;
+	}
+	return hash;
+}
+
+
+// ============================================================================
+// ============================================================================
+static uint32_t GetFormatVersion(AssetType type)
+{
+	switch (type)
+	{
+	case AssetMesh:
+		return MeshBinary::Version;
+	case AssetLevel:
+		return LevelBinary::Version;
+	case AssetSound:
+		return SoundBinary::Version;
+	default:
+		// DDS has no version of its own
+		return 1;
+	}
+}
+
+
+// ============================================================================
+// Contents, cooker version and output format version. Sounds also depend on
+// the mixer format they're converted to, textures on whether they're
+// compressed.
+// ============================================================================
+static bool ComputeKey(const Asset& asset, uint64_t& outKey)
+{
+	std::ifstream file(asset.mSource, std::ios::binary);
+	if (!file.is_open())
+	{
+		return false;
+	}
+	const std::vector<char> contents((std::istreambuf_iterator<char>(file)),
+									 std::istreambuf_iterator<char>());
+	uint64_t key = Hash(contents.data(), contents.size());
+	const uint32_t versions[2] = { sCookerVersion, GetFormatVersion(asset.mType) };
+	key = Hash(versions, sizeof(versions), key);
+	if (asset.mType == AssetSound)
+	{
+		const int spec[3] = { sFrequency, MIX_DEFAULT_FORMAT, sNumChannels };
+		key = Hash(spec, sizeof(spec), key);
+	}
+	if (asset.mType == AssetTexture)
+	{
+		const uint8_t compress = asset.mCompress ? 1 : 0;
+		key = Hash(&compress, sizeof(compress), key);
+	}
+	outKey = key;
+	return true;
+}
+
+
+// ============================================================================
+// ============================================================================
+static void LoadManifest(const std::string& fileName,
+						 std::map<std::string, uint64_t>& outManifest)
+{
+	std::ifstream file(fileName);
+	std::string line;
+	while (std::getline(file, line))
+	{
+		unsigned long long key = 0;
+		int pathStart = 0;
+		if (sscanf(line.c_str(), "%llx %n", &key, &pathStart) == 1 && pathStart > 0)
+		{
+			outManifest[line.substr(pathStart)] = key;
+		}
+	}
+}
+
+
+// ============================================================================
+// ============================================================================
+static bool SaveManifest(const std::string& fileName,
+						 const std::map<std::string, uint64_t>& manifest)
+{
+	FILE* file = fopen(fileName.c_str(), "w");
+	if (!file)
+	{
+		printf("Couldn't write %s\n", fileName.c_str());
+		return false;
+	}
+	for (const auto& entry : manifest)
+	{
+		fprintf(file, "%016llx %s\n", static_cast<unsigned long long>(entry.second),
+				entry.first.c_str());
+	}
+	fclose(file);
+	return true;
+}
+
+
+// ============================================================================
+// SOIL hands back 1-4 channels; the cooked format holds 3 or 4. Block
+// compression needs whole 4x4 blocks.
+// ============================================================================
+static bool CookTexture(const Asset& asset)
+{
+	int width = 0;
+	int height = 0;
+	int channels = 0;
+	unsigned char* image = SOIL_load_image(asset.mSource.c_str(), &width, &height,
+										   &channels, SOIL_LOAD_AUTO);
+	if (image && channels != 3 && channels != 4)
+	{
+		SOIL_free_image_data(image);
+		const int forced = (channels == 2) ? SOIL_LOAD_RGBA : SOIL_LOAD_RGB;
+		image = SOIL_load_image(asset.mSource.c_str(), &width, &height,
+								&channels, forced);
+		channels = (forced == SOIL_LOAD_RGBA) ? 4 : 3;
+	}
+	if (image == nullptr)
+	{
+		printf("  SOIL failed to load %s: %s\n", asset.mSource.c_str(), SOIL_last_result());
+		return false;
+	}
+	const bool compress = asset.mCompress && width % 4 == 0 && height % 4 == 0;
+	if (asset.mCompress && !compress)
+	{
+		printf("  %s is %dx%d, leaving it uncompressed\n", asset.mSource.c_str(),
+			   width, height);
+	}
+	const bool success =
+		TextureBinary::Write(asset.mCooked, image, width, height, channels, compress);
+	SOIL_free_image_data(image);
+	return success;
+}
+
+
+// ============================================================================
+// Mix_LoadWAV decodes and converts to the opened output format, which is
+// exactly what the game would otherwise do at load
+// ============================================================================
+static bool CookSound(const Asset& asset)
+{
+	Mix_Chunk* chunk = Mix_LoadWAV(asset.mSource.c_str());
+	if (!chunk)
+	{
+		printf("  Failed to decode %s: %s\n", asset.mSource.c_str(), SDL_GetError());
+		return false;
+	}
+	int frequency = 0;
+	Uint16 format = 0;
+	int channels = 0;
+	Mix_QuerySpec(&frequency, &format, &channels);
+	const bool success = SoundBinary::Write(asset.mCooked, frequency, format, channels,
+											chunk->abuf, chunk->alen);
+	Mix_FreeChunk(chunk);
+	return success;
+}
+
+
+// ============================================================================
+// ============================================================================
+static bool Cook(const Asset& asset)
+{
+	switch (asset.mType)
+	{
+	case AssetMesh:
+	{
+		MeshData data;
+		return MeshBinary::ParseJSON(asset.mSource, data) &&
+			MeshBinary::Write(asset.mCooked, data);
+	}
+	case AssetLevel:
+	{
+		LevelData data;
+		return LevelBinary::ParseJSON(asset.mSource, data) &&
+			LevelBinary::Write(asset.mCooked, data);
+	}
+	case AssetTexture:
+		return CookTexture(asset);
+	case AssetSound:
+		return CookSound(asset);
+	default:
+		return false;
+	}
+}
+
+
+// ============================================================================
+// Load from the source, doing the CPU work the game does before handing the
+// result to GL / the mixer
+// ============================================================================
+static void LoadRaw(const Asset& asset)
+{
+	switch (asset.mType)
+	{
+	case AssetMesh:
+	{
+		MeshData data;
+		MeshBinary::ParseJSON(asset.mSource, data);
+		gSink = gSink + static_cast<unsigned>(data.mVertices.size());
+		break;
+	}
+	case AssetLevel:
+	{
+		LevelData data;
+		LevelBinary::ParseJSON(asset.mSource, data);
+		gSink = gSink + static_cast<unsigned>(data.mBlockPositions.size());
+		break;
+	}
+	case AssetTexture:
+	{
+		int width = 0;
+		int height = 0;
+		int channels = 0;
+		unsigned char* image = SOIL_load_image(asset.mSource.c_str(), &width,
+											   &height, &channels, SOIL_LOAD_AUTO);
+		if (image)
+		{
+			gSink = gSink + image[0];
+			SOIL_free_image_data(image);
+		}
+		break;
+	}
+	case AssetSound:
+	{
+		Mix_Chunk* chunk = Mix_LoadWAV(asset.mSource.c_str());
+		if (chunk)
+		{
+			gSink = gSink + chunk->alen;
+			Mix_FreeChunk(chunk);
+		}
+		break;
+	}
+	default:
+		break;
+	}
+}
+
+
+// ============================================================================
+// Map the cooked file and touch the data like the upload would
+// ============================================================================
+static void LoadCooked(const Asset& asset)
+{
+	switch (asset.mType)
+	{
+	case AssetMesh:
+	{
+		MeshBinary binary;
+		if (binary.Open(asset.mCooked))
+		{
+			gSink = gSink + binary.GetNumVerts() +
+				static_cast<unsigned>(binary.GetVertices()[0]);
+		}
+		break;
+	}
+	case AssetLevel:
+	{
+		LevelBinary binary;
+		if (binary.Open(asset.mCooked))
+		{
+			gSink = gSink + static_cast<unsigned>(binary.GetView().mNumBlocks);
+		}
+		break;
+	}
+	case AssetTexture:
+	{
+		TextureBinary binary;
+		if (binary.Open(asset.mCooked))
+		{
+			unsigned sum = 0;
+			for (size_t i = 0; i < binary.GetNumMips(); i++)
+			{
+				sum += binary.GetMipData(i)[0];
+			}
+			gSink = gSink + sum;
+		}
+		break;
+	}
+	case AssetSound:
+	{
+		SoundBinary binary;
+		if (binary.Open(asset.mCooked))
+		{
+			std::vector<unsigned char> samples(binary.GetSamples(),
+											   binary.GetSamples() + binary.GetNumBytes());
+			gSink = gSink + samples[samples.size() / 2];
+		}
+		break;
+	}
+	default:
+		break;
+	}
+}
+
+
+// ============================================================================
+// ============================================================================
+template <typename Fn>
+static double BestMS(Fn fn)
+{
+	typedef std::chrono::steady_clock Clock;
+	double best = 1e30;
+	for (int i = 0; i < sCompareRuns; i++)
+	{
+		const auto start = Clock::now();
+		fn();
+		const auto end = Clock::now();
+		const double ms =
+			std::chrono::duration<double, std::milli>(end - start).count();
+		if (ms < best)
+		{
+			best = ms;
+		}
+	}
+	return best;
+}
+
+
+// ============================================================================
+// ============================================================================
+static void Compare(const std::vector<Asset>& assets)
+{
+	printf("Load time per asset type, best of %d:\n", sCompareRuns);
+	double rawTotal = 0.0;
+	double cookedTotal = 0.0;
+	for (int type = 0; type < NumAssetTypes; type++)
+	{
+		std::vector<const Asset*> ofType;
+		for (const auto& asset : assets)
+		{
+			if (asset.mType == type && FileExists(asset.mCooked))
+			{
+				ofType.emplace_back(&asset);
+			}
+		}
+		if (ofType.empty())
+		{
+			continue;
+		}
+
+		const double rawMS = BestMS([&]() {
+			for (auto asset : ofType)
+			{
+				LoadRaw(*asset);
+			}
+		});
+		const double cookedMS = BestMS([&]() {
+			for (auto asset : ofType)
+			{
+				LoadCooked(*asset);
+			}
+		});
+		printf("  %-10s %3u files   raw %9.3f ms   cooked %9.3f ms   %6.1fx\n",
+			   sTypeNames[type], static_cast<unsigned>(ofType.size()),
+			   rawMS, cookedMS, rawMS / cookedMS);
+		rawTotal += rawMS;
+		cookedTotal += cookedMS;
+	}
+	printf("  %-10s             raw %9.3f ms   cooked %9.3f ms   %6.1fx\n",
+		   "total", rawTotal, cookedTotal, rawTotal / cookedTotal);
+}
+
+
+// ============================================================================
+// ============================================================================
+int main(int argc, char** argv)
+{
+	bool force = false;
+	bool decodeAudio = false;
+	bool compressTextures = false;
+	bool compare = false;
+	std::string root = "Assets";
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--force") == 0)
+		{
+			force = true;
+		}
+		else if (strcmp(argv[i], "--decode-audio") == 0)
+		{
+			decodeAudio = true;
+		}
+		else if (strcmp(argv[i], "--compress-textures") == 0)
+		{
+			compressTextures = true;
+		}
+		else if (strcmp(argv[i], "--compare") == 0)
+		{
+			compare = true;
+		}
+		else if (argv[i][0] == '-')
+		{
+			printf("Usage: parkour-cook [--force] [--decode-audio] [--compress-textures]\n"
+				   "                   [--compare] [assetRoot]\n");
+			return 1;
+		}
+		else
+		{
+			root = argv[i];
+		}
+	}
+
+	// Decoding goes through SDL_mixer, which needs an open (silent) device
+	const bool needMixer = decodeAudio || compare;
+	if (needMixer)
+	{
+		SDL_setenv("SDL_AUDIODRIVER", "dummy", 1);
+		if (SDL_Init(SDL_INIT_AUDIO) != 0 ||
+			Mix_OpenAudio(sFrequency, MIX_DEFAULT_FORMAT, sNumChannels, sChunkSize))
+		{
+			printf("Unable to open audio for decoding: %s\n", SDL_GetError());
+			return 1;
+		}
+	}
+
+	std::vector<std::string> files;
+	ListFiles(root, files);
+	std::vector<Asset> assets;
+	for (const auto& file : files)
+	{
+		Asset asset;
+		asset.mSource = file;
+		asset.mCompress = false;
+		if (EndsWith(file, ".gpmesh"))
+		{
+			asset.mType = AssetMesh;
+			asset.mCooked = file + AssetPath::MeshSuffix;
+		}
+		else if (EndsWith(file, ".json"))
+		{
+			asset.mType = AssetLevel;
+			asset.mCooked = file + AssetPath::LevelSuffix;
+		}
+		else if (EndsWith(file, ".png"))
+		{
+			asset.mType = AssetTexture;
+			asset.mCooked = file + AssetPath::TextureSuffix;
+			asset.mCompress = compressTextures;
+		}
+		else if (decodeAudio && EndsWith(file, ".wav"))
+		{
+			asset.mType = AssetSound;
+			asset.mCooked = file + AssetPath::SoundSuffix;
+		}
+		else
+		{
+			continue;
+		}
+		assets.emplace_back(asset);
+	}
+
+	const std::string manifestName = root + "/" + sManifestName;
+	std::map<std::string, uint64_t> manifest;
+	if (!force)
+	{
+		LoadManifest(manifestName, manifest);
+	}
+
+	const auto start = std::chrono::steady_clock::now();
+	int cooked = 0;
+	int upToDate = 0;
+	int failed = 0;
+	for (const auto& asset : assets)
+	{
+		uint64_t key = 0;
+		if (!ComputeKey(asset, key))
+		{
+			printf("%s: can't read\n", asset.mSource.c_str());
+			failed++;
+			continue;
+		}
+
+		auto itr = manifest.find(asset.mSource);
+		if (itr != manifest.end() && itr->second == key && FileExists(asset.mCooked))
+		{
+			upToDate++;
+			continue;
+		}
+
+		if (!Cook(asset))
+		{
+			printf("%s: FAILED\n", asset.mSource.c_str());
+			manifest.erase(asset.mSource);
+			failed++;
+			continue;
+		}
+		printf("%s -> %s\n", asset.mSource.c_str(), asset.mCooked.c_str());
+		manifest[asset.mSource] = key;
+		cooked++;
+	}
+	const double ms = std::chrono::duration<double, std::milli>(
+		std::chrono::steady_clock::now() - start).count();
+	SaveManifest(manifestName, manifest);
+	printf("%d cooked, %d up to date, %d failed (%.1f ms)\n", cooked, upToDate, failed, ms);
+
+	if (compare)
+	{
+		Compare(assets);
+	}
+
+	if (needMixer)
+	{
+		Mix_CloseAudio();
+		SDL_Quit();
+	}
+	return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,224 @@
+// Level load and teardown benchmark.
+//
+// Builds each level's actors the way a level transition does
+// (LevelLoader::Load) and deletes them again (Game::DestroyAllActors), over
+// several runs, and reports the median of each phase. While the level is up
+// it also times a collision sweep: the player's box against every block's,
+// the loop PlayerMove runs several times a frame. The game is set up with
+// Game::InitializeHeadless, so no window opens; meshes and textures are read
+// on the thread pool but never uploaded.
+//
+// The shipped levels are small. Make big ones with
+//   LevelConvert --generate 50000 Assets/Generated50k.json
+//
+// Build from the repo root with the game's include paths and libraries. It
+// links every game source except Main.cpp:
+//   g++ -std=c++14 -O2 -pthread <includes> -o LevelBench Tools/LevelBench.cpp
+//       $(ls *.cpp | grep -v Main.cpp) -lSOIL -lGLEW -lGL -lSDL2_ttf
+//       -lSDL2_mixer -lSDL2
+//   (cl /O2 /EHsc with the same sources and the game's .lib files)
+// Run it from the repo root so the assets resolve.
+//
+// Usage: LevelBench [--compare] [--runs N] level.json...
+//   --compare  run every level again with the actor pools bypassed (see
+//              Pool::SetBypass), alternating run by run, and print both
+//   --runs     runs per level (default 9)
+#include "../Game.h"
+#include "../LevelLoader.h"
+#include "../Block.h"
+#include "../Player.h"
+#include "../CollisionComponent.h"
+#include "../Pool.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+static const int sDefaultRuns = 9;
+
+// Sweeps per run; the best is kept, like a frame with a warm cache
+static const int sSweepRepeats = 5;
+
+// Stops the compiler from skipping the sweep being timed
+static volatile int gSink = 0;
+
+typedef std::chrono::steady_clock Clock;
+
+// Milliseconds each phase took, one entry per run
+struct LevelTimes
+{
+	std::vector<double> mLoad;
+	std::vector<double> mSweep;
+	std::vector<double> mTeardown;
+	size_t mNumBlocks;
+};
+
+
+// ============================================================================
+// ============================================================================
+static double Milliseconds(Clock::time_point start, Clock::time_point end)
+{
+	return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+
+// ============================================================================
+// ============================================================================
+static double Median(std::vector<double> values)
+{
+	std::sort(values.begin(), values.end());
+	return values.empty() ? 0.0 : values[values.size() / 2];
+}
+
+
+// ============================================================================
+// Same test as PlayerMove's collision loops, without the response
+// ============================================================================
+static double Sweep(Game& game)
+{
+	Player* player = game.GetPlayer();
+	if (!player)
+	{
+		return 0.0;
+	}
+	CollisionComponent* playerBox = player->GetCollision();
+
+	double best = 1e30;
+	for (int i = 0; i < sSweepRepeats; i++)
+	{
+		const auto start = Clock::now();
+		int hits = 0;
+		for (Block* block : game.GetBlocks())
+		{
+			if (playerBox->Intersect(block->GetCollision()))
+			{
+				hits++;
+			}
+		}
+		const auto end = Clock::now();
+		gSink = gSink + hits;
+		best = std::min(best, Milliseconds(start, end));
+	}
+	return best;
+}
+
+
+// ============================================================================
+// One load, sweep and teardown. The teardown is LoadNextLevel's.
+// ============================================================================
+static bool Run(Game& game, const std::string& fileName, LevelTimes& times)
+{
+	const auto start = Clock::now();
+	if (!LevelLoader::Load(&game, fileName))
+	{
+		printf("%s: failed to load\n", fileName.c_str());
+		return false;
+	}
+	const auto loaded = Clock::now();
+	times.mNumBlocks = game.GetBlocks().size();
+	times.mSweep.emplace_back(Sweep(game));
+
+	const auto teardown = Clock::now();
+	game.DestroyAllActors();
+	while (!game.mCheckpoints.empty())
+	{
+		game.mCheckpoints.pop();
+	}
+	const auto end = Clock::now();
+
+	times.mLoad.emplace_back(Milliseconds(start, loaded));
+	times.mTeardown.emplace_back(Milliseconds(teardown, end));
+	return true;
+}
+
+
+// ============================================================================
+// ============================================================================
+static void PrintTimes(const char* label, const LevelTimes& times)
+{
+	printf("  %-8s load %9.3f ms   sweep %8.3f ms   teardown %9.3f ms\n", label,
+		   Median(times.mLoad), Median(times.mSweep), Median(times.mTeardown));
+}
+
+
+// ============================================================================
+// ============================================================================
+static void PrintRatio(const LevelTimes& pooled, const LevelTimes& heap)
+{
+	printf("  %-8s load %8.2fx    sweep %7.2fx    teardown %8.2fx\n", "heap/pool",
+		   Median(heap.mLoad) / Median(pooled.mLoad),
+		   Median(heap.mSweep) / Median(pooled.mSweep),
+		   Median(heap.mTeardown) / Median(pooled.mTeardown));
+}
+
+
+// ============================================================================
+// ============================================================================
+int main(int argc, char** argv)
+{
+	bool compare = false;
+	int runs = sDefaultRuns;
+	std::vector<std::string> files;
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--compare") == 0)
+		{
+			compare = true;
+		}
+		else if (strcmp(argv[i], "--runs") == 0 && i + 1 < argc)
+		{
+			runs = std::max(1, atoi(argv[++i]));
+		}
+		else
+		{
+			files.emplace_back(argv[i]);
+		}
+	}
+
+	if (files.empty())
+	{
+		printf("Usage: LevelBench [--compare] [--runs N] level.json...\n");
+		return 1;
+	}
+
+	Game game;
+	game.InitializeHeadless();
+
+	int failures = 0;
+	printf("Median of %d runs, sweep best of %d\n", runs, sSweepRepeats);
+	for (const auto& file : files)
+	{
+		LevelTimes pooled;
+		LevelTimes heap;
+		bool ok = true;
+		for (int i = 0; i < runs && ok; i++)
+		{
+			ok = Run(game, file, pooled);
+			if (ok && compare)
+			{
+				Pool::SetBypass(true);
+				ok = Run(game, file, heap);
+				Pool::SetBypass(false);
+			}
+		}
+		if (!ok)
+		{
+			failures++;
+			continue;
+		}
+
+		printf("%s: %u blocks\n", file.c_str(), static_cast<unsigned>(pooled.mNumBlocks));
+		PrintTimes("pooled", pooled);
+		if (compare)
+		{
+			PrintTimes("heap", heap);
+			PrintRatio(pooled, heap);
+		}
+	}
+
+	game.ShutdownHeadless();
+	return failures > 0 ? 1 : 0;
+}
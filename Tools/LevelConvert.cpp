@@ -0,0 +1,239 @@
+// Compiles level .json files into the binary format LevelLoader::Load maps
+// directly (see LevelBinary.h). Each input is written next to itself as
+// <input>.bin; rerun after editing a level or the stale binary wins.
+//
+// Build from the repo root with the game's rapidjson and SDL include paths
+// (SDL is only needed for SDL_Log):
+//   g++ -std=c++14 -O2 <includes> Tools/LevelConvert.cpp LevelBinary.cpp
+//       JSONParser.cpp MemoryTracker.cpp FileSystem.cpp AssetPack.cpp LZ4.cpp
+//       MappedFile.cpp -lSDL2
+//   cl /O2 /EHsc <includes> Tools\LevelConvert.cpp LevelBinary.cpp
+//       JSONParser.cpp MemoryTracker.cpp FileSystem.cpp AssetPack.cpp LZ4.cpp
+//       MappedFile.cpp SDL2.lib
+//
+// Usage: LevelConvert [--compare] level.json...
+//        LevelConvert --generate <blocks> out.json
+//   --compare   after converting, check the binary matches the JSON and time
+//               loading each level both ways (best of several runs)
+//   --generate  write a synthetic level with that many blocks, for timing
+//               level sizes the shipped levels don't reach
+#include "../LevelBinary.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+static const int sCompareRuns = 20;
+
+// Stops the compiler from skipping the reads being timed
+static volatile float gSink = 0.0f;
+
+
+// ============================================================================
+// ============================================================================
+template <typename Fn>
+static double BestMS(Fn fn)
+{
+	typedef std::chrono::steady_clock Clock;
+	double best = 1e30;
+	for (int i = 0; i < sCompareRuns; i++)
+	{
+		const auto start = Clock::now();
+		fn();
+		const auto end = Clock::now();
+		const double ms =
+			std::chrono::duration<double, std::milli>(end - start).count();
+		if (ms < best)
+		{
+			best = ms;
+		}
+	}
+	return best;
+}
+
+
+// ============================================================================
+// Touch every block and actor, like LevelLoader::Instantiate does
+// ============================================================================
+static float Checksum(const LevelView& view)
+{
+	float sum = 0.0f;
+	for (size_t i = 0; i < view.mNumBlocks; i++)
+	{
+		sum += view.mBlockPositions[i].x + view.mBlockPositions[i].y +
+			view.mBlockPositions[i].z + view.mBlockScales[i] +
+			view.mBlockRotations[i] + view.mBlockTextures[i] + view.mBlockFlags[i];
+	}
+	for (size_t i = 0; i < view.mNumActors; i++)
+	{
+		sum += view.mActors[i].mPos.x + view.mActors[i].mScale +
+			static_cast<float>(view.mActors[i].mType);
+	}
+	return sum;
+}
+
+
+// ============================================================================
+// ============================================================================
+static bool SameBytes(const void* a, const void* b, size_t bytes)
+{
+	return bytes == 0 || memcmp(a, b, bytes) == 0;
+}
+
+
+// ============================================================================
+// ============================================================================
+static bool Matches(const LevelView& a, const LevelView& b)
+{
+	return a.mNumBlocks == b.mNumBlocks && a.mNumActors == b.mNumActors &&
+		a.mStringsSize == b.mStringsSize &&
+		SameBytes(a.mBlockPositions, b.mBlockPositions, a.mNumBlocks * sizeof(Vector3)) &&
+		SameBytes(a.mBlockScales, b.mBlockScales, a.mNumBlocks * sizeof(float)) &&
+		SameBytes(a.mBlockRotations, b.mBlockRotations, a.mNumBlocks * sizeof(float)) &&
+		SameBytes(a.mBlockTextures, b.mBlockTextures, a.mNumBlocks * sizeof(int32_t)) &&
+		SameBytes(a.mBlockFlags, b.mBlockFlags, a.mNumBlocks) &&
+		SameBytes(a.mActors, b.mActors, a.mNumActors * sizeof(LevelActorRecord)) &&
+		SameBytes(a.mStrings, b.mStrings, a.mStringsSize);
+}
+
+
+// ============================================================================
+// ============================================================================
+static bool Compare(const std::string& fileName)
+{
+	LevelData data;
+	LevelBinary binary;
+	if (!LevelBinary::ParseJSON(fileName, data) || !binary.Open(fileName + ".bin") ||
+		!Matches(data.GetView(), binary.GetView()))
+	{
+		printf("  %-32s binary does not match the JSON\n", fileName.c_str());
+		return false;
+	}
+	binary.Close();
+
+	const double jsonMS = BestMS([&]() {
+		LevelData parsed;
+		if (LevelBinary::ParseJSON(fileName, parsed))
+		{
+			gSink = gSink + Checksum(parsed.GetView());
+		}
+	});
+
+	const double binaryMS = BestMS([&]() {
+		LevelBinary mapped;
+		if (mapped.Open(fileName + ".bin"))
+		{
+			gSink = gSink + Checksum(mapped.GetView());
+		}
+	});
+
+	// JSON parse throughput, for comparing parser changes on big levels
+	std::ifstream file(fileName, std::ios::binary | std::ios::ate);
+	const double megabytes = static_cast<double>(file.tellg()) / (1024.0 * 1024.0);
+
+	printf("  %-32s json %8.3f ms (%6.1f MB/s)   binary %8.3f ms   %6.1fx\n",
+		   fileName.c_str(), jsonMS, megabytes * 1000.0 / jsonMS, binaryMS,
+		   jsonMS / binaryMS);
+	return true;
+}
+
+
+// ============================================================================
+// A square grid of blocks plus a player and a checkpoint, in the same shape
+// the editor writes
+// ============================================================================
+static bool Generate(int numBlocks, const char* fileName)
+{
+	FILE* file = fopen(fileName, "w");
+	if (!file)
+	{
+		printf("Couldn't open %s for writing\n", fileName);
+		return false;
+	}
+
+	int side = 1;
+	while (side * side < numBlocks)
+	{
+		side++;
+	}
+
+	fprintf(file, "{\n\t\"version\": 1,\n\t\"actors\": [\n");
+	fprintf(file, "\t\t{ \"type\": \"Player\", \"pos\": [0.0, 0.0, 100.0] },\n");
+	for (int i = 0; i < numBlocks; i++)
+	{
+		const float x = static_cast<float>(i % side) * 64.0f;
+		const float y = static_cast<float>(i / side) * 64.0f;
+		fprintf(file, "\t\t{ \"type\": \"Block\", \"pos\": [%.1f, %.1f, 0.0], "
+				"\"scale\": 64.0, \"texture\": %d },\n", x, y, i % 4);
+	}
+	fprintf(file, "\t\t{ \"type\": \"Checkpoint\", \"pos\": [0.0, 0.0, 50.0], "
+			"\"text\": \"Generated\" }\n");
+	fprintf(file, "\t]\n}\n");
+	fclose(file);
+	printf("%s: %d blocks\n", fileName, numBlocks);
+	return true;
+}
+
+
+// ============================================================================
+// ============================================================================
+int main(int argc, char** argv)
+{
+	if (argc == 4 && strcmp(argv[1], "--generate") == 0)
+	{
+		return Generate(atoi(argv[2]), argv[3]) ? 0 : 1;
+	}
+
+	bool compare = false;
+	std::vector<std::string> files;
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--compare") == 0)
+		{
+			compare = true;
+		}
+		else
+		{
+			files.emplace_back(argv[i]);
+		}
+	}
+
+	if (files.empty())
+	{
+		printf("Usage: LevelConvert [--compare] level.json...\n");
+		printf("       LevelConvert --generate <blocks> out.json\n");
+		return 1;
+	}
+
+	int failures = 0;
+	for (const auto& file : files)
+	{
+		LevelData data;
+		if (!LevelBinary::ParseJSON(file, data) ||
+			!LevelBinary::Write(file + ".bin", data))
+		{
+			printf("%s: FAILED\n", file.c_str());
+			failures++;
+			continue;
+		}
+		printf("%s -> %s.bin (%u blocks, %u actors)\n", file.c_str(), file.c_str(),
+			   static_cast<unsigned>(data.mBlockPositions.size()),
+			   static_cast<unsigned>(data.mActors.size()));
+	}
+
+	if (compare)
+	{
+		printf("Load time, best of %d:\n", sCompareRuns);
+		for (const auto& file : files)
+		{
+			if (!Compare(file))
+			{
+				failures++;
+			}
+		}
+	}
+	return failures == 0 ? 0 : 1;
+}
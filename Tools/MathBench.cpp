@@ -0,0 +1,831 @@
+// Math microbenchmark and accuracy report.
+//
+// Times the Math.h routines the game leans on every frame (actor world
+// transforms, the camera look-at, arrow quaternions, unproject) over batches
+// of random inputs stored structure-of-arrays, and reports ns/op and
+// throughput. Then compares every fast path against its reference, prints
+// the worst error in ULPs and fails (exit code 1) if any goes over its
+// tolerance: 0 for the kernels that must match the scalar code bit for bit,
+// a few ULPs against a double reference for the inverses and trig.
+//
+// Standalone, no SDL or GL. Build from the repo root:
+//   g++ -std=c++14 -O2 Tools/MathBench.cpp Math.cpp -o MathBench
+//   cl /O2 /EHsc Tools\MathBench.cpp Math.cpp
+// Add -DMATH_NO_SIMD (/DMATH_NO_SIMD) to get the scalar-only numbers.
+//
+// Usage: MathBench [--check] [batchSize] [repeats]
+//   --check  skip the timings and only run the accuracy pass
+#include "../Math.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <vector>
+#include <algorithm>
+
+// Outputs are folded in here after timing so the work can't be optimized out
+static volatile float gSink = 0.0f;
+
+// Random inputs, one array per component
+struct Batch
+{
+	size_t mCount;
+
+	// Points / directions
+	std::vector<float> mPosX, mPosY, mPosZ;
+
+	// A second set of points, used as look-at targets
+	std::vector<float> mTargetX, mTargetY, mTargetZ;
+
+	// Axis-angle rotations (axis is normalized)
+	std::vector<float> mAxisX, mAxisY, mAxisZ, mAngle;
+
+	// Per-actor scale and z rotation
+	std::vector<float> mScale, mRotZ;
+
+	// Interpolation factors and general angles for the trig helpers
+	std::vector<float> mT;
+
+	// Derived inputs for the matrix/quaternion kernels
+	std::vector<Matrix4> mWorld;
+	std::vector<Matrix4> mOther;
+	std::vector<Quaternion> mQuatA, mQuatB;
+};
+
+
+// ============================================================================
+// ============================================================================
+static Batch MakeBatch(size_t count)
+{
+	std::mt19937 rng(1234);
+	std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+	std::uniform_real_distribution<float> world(-2000.0f, 2000.0f);
+	std::uniform_real_distribution<float> scale(0.25f, 4.0f);
+	std::uniform_real_distribution<float> angle(-Math::Pi, Math::Pi);
+	std::uniform_real_distribution<float> t(0.0f, 1.0f);
+
+	Batch b;
+	b.mCount = count;
+	std::vector<float>* arrays[] =
+	{
+		&b.mPosX, &b.mPosY, &b.mPosZ, &b.mTargetX, &b.mTargetY, &b.mTargetZ,
+		&b.mAxisX, &b.mAxisY, &b.mAxisZ, &b.mAngle, &b.mScale, &b.mRotZ, &b.mT
+	};
+	for (auto a : arrays)
+	{
+		a->resize(count);
+	}
+
+	for (size_t i = 0; i < count; i++)
+	{
+		b.mPosX[i] = world(rng);
+		b.mPosY[i] = world(rng);
+		b.mPosZ[i] = world(rng);
+		b.mTargetX[i] = b.mPosX[i] + unit(rng) * 100.0f;
+		b.mTargetY[i] = b.mPosY[i] + unit(rng) * 100.0f;
+		b.mTargetZ[i] = b.mPosZ[i] + unit(rng) * 100.0f;
+
+		Vector3 axis(unit(rng), unit(rng), unit(rng));
+		if (axis.LengthSq() < 0.01f)
+		{
+			axis = Vector3::UnitZ;
+		}
+		axis.Normalize();
+		b.mAxisX[i] = axis.x;
+		b.mAxisY[i] = axis.y;
+		b.mAxisZ[i] = axis.z;
+		b.mAngle[i] = angle(rng);
+		b.mScale[i] = scale(rng);
+		b.mRotZ[i] = angle(rng);
+		b.mT[i] = t(rng);
+	}
+
+	// Build the matrices/quaternions the same way the game does
+	b.mWorld.resize(count);
+	b.mOther.resize(count);
+	b.mQuatA.resize(count);
+	b.mQuatB.resize(count);
+	for (size_t i = 0; i < count; i++)
+	{
+		b.mQuatA[i] = Quaternion(
+			Vector3(b.mAxisX[i], b.mAxisY[i], b.mAxisZ[i]), b.mAngle[i]);
+		const size_t j = (i + 1) % count;
+		b.mQuatB[i] = Quaternion(
+			Vector3(b.mAxisX[j], b.mAxisY[j], b.mAxisZ[j]), b.mAngle[j]);
+
+		const Vector3 pos(b.mPosX[i], b.mPosY[i], b.mPosZ[i]);
+		b.mWorld[i] = Matrix4::CreateScale(b.mScale[i]) *
+			Matrix4::CreateRotationZ(b.mRotZ[i]) *
+			Matrix4::CreateFromQuaternion(b.mQuatA[i]) *
+			Matrix4::CreateTranslation(pos);
+		const Vector3 target(b.mTargetX[i], b.mTargetY[i], b.mTargetZ[i]);
+		b.mOther[i] = Matrix4::CreateLookAt(pos, target, Vector3::UnitZ);
+	}
+	return b;
+}
+
+
+// ============================================================================
+// Run fn over the whole batch `repeats` times and report the best pass
+// ============================================================================
+template <typename Fn>
+static void Bench(const char* name, size_t count, int repeats, Fn fn)
+{
+	typedef std::chrono::steady_clock Clock;
+
+	// Warm the caches and the branch predictors
+	fn();
+
+	double best = 1e30;
+	for (int r = 0; r < repeats; r++)
+	{
+		const auto start = Clock::now();
+		fn();
+		const auto end = Clock::now();
+		best = std::min(best,
+			std::chrono::duration<double>(end - start).count());
+	}
+
+	const double nsPerOp = best * 1e9 / static_cast<double>(count);
+	const double mopsPerSec = static_cast<double>(count) / best / 1e6;
+	printf("  %-40s %9.2f ns/op %10.1f Mop/s\n", name, nsPerOp, mopsPerSec);
+}
+
+
+// ============================================================================
+// ============================================================================
+static void Sink(const float* data, size_t numFloats)
+{
+	float sum = 0.0f;
+	for (size_t i = 0; i < numFloats; i++)
+	{
+		sum += data[i];
+	}
+	gSink = gSink + sum;
+}
+
+
+// ============================================================================
+// Size of one ULP at the magnitude of x
+// ============================================================================
+static double UlpAt(float x)
+{
+	x = fabsf(x);
+	if (x < std::numeric_limits<float>::min())
+	{
+		x = std::numeric_limits<float>::min();
+	}
+	return static_cast<double>(
+		nextafterf(x, std::numeric_limits<float>::infinity()) - x);
+}
+
+
+// Worst error seen for one fast path, in ULPs. Errors are measured against
+// the ULP of the largest element of the reference result: an element that
+// should be ~0 after cancellation would otherwise report millions of ULPs
+// for an error that is invisible next to its neighbours.
+struct UlpReport
+{
+	const char* mName;
+	// Most error allowed before the check fails
+	double mTolerance;
+	double mMaxUlp;
+	size_t mExact;
+	size_t mTotal;
+};
+
+
+// ============================================================================
+// ============================================================================
+static void Accumulate(UlpReport& report, const float* fast, const double* ref,
+					   size_t numFloats)
+{
+	double magnitude = 0.0;
+	for (size_t i = 0; i < numFloats; i++)
+	{
+		magnitude = std::max(magnitude, fabs(ref[i]));
+	}
+	const double ulp = UlpAt(static_cast<float>(magnitude));
+
+	for (size_t i = 0; i < numFloats; i++)
+	{
+		const double err = fabs(static_cast<double>(fast[i]) - ref[i]);
+		report.mMaxUlp = std::max(report.mMaxUlp, err / ulp);
+		if (fast[i] == static_cast<float>(ref[i]))
+		{
+			report.mExact++;
+		}
+		report.mTotal++;
+	}
+}
+
+
+// ============================================================================
+// ============================================================================
+static void Accumulate(UlpReport& report, const float* fast, const float* ref,
+					   size_t numFloats)
+{
+	double refD[16];
+	for (size_t i = 0; i < numFloats; i++)
+	{
+		refD[i] = ref[i];
+	}
+	Accumulate(report, fast, refD, numFloats);
+}
+
+
+// ============================================================================
+// Gauss-Jordan in double, the ground truth for both float inverses
+// ============================================================================
+static void InvertDouble(const Matrix4& m, double out[16])
+{
+	double a[4][8];
+	for (int i = 0; i < 4; i++)
+	{
+		for (int j = 0; j < 4; j++)
+		{
+			a[i][j] = m.mat[i][j];
+			a[i][j + 4] = (i == j) ? 1.0 : 0.0;
+		}
+	}
+
+	for (int col = 0; col < 4; col++)
+	{
+		int pivot = col;
+		for (int row = col + 1; row < 4; row++)
+		{
+			if (fabs(a[row][col]) > fabs(a[pivot][col]))
+			{
+				pivot = row;
+			}
+		}
+		for (int j = 0; j < 8; j++)
+		{
+			std::swap(a[col][j], a[pivot][j]);
+		}
+
+		const double inv = 1.0 / a[col][col];
+		for (int j = 0; j < 8; j++)
+		{
+			a[col][j] *= inv;
+		}
+		for (int row = 0; row < 4; row++)
+		{
+			if (row != col)
+			{
+				const double f = a[row][col];
+				for (int j = 0; j < 8; j++)
+				{
+					a[row][j] -= f * a[col][j];
+				}
+			}
+		}
+	}
+
+	for (int i = 0; i < 4; i++)
+	{
+		for (int j = 0; j < 4; j++)
+		{
+			out[i * 4 + j] = a[i][j + 4];
+		}
+	}
+}
+
+
+// ============================================================================
+// ============================================================================
+static void RunMatrixBenchmarks(const Batch& b, int repeats)
+{
+	const size_t n = b.mCount;
+	std::vector<Matrix4> out(n);
+	std::vector<Affine3x4> outAffine(n);
+
+	printf("Matrix4\n");
+	Bench("operator* (world * view)", n, repeats, [&]() {
+		for (size_t i = 0; i < n; i++)
+		{
+			out[i] = b.mWorld[i] * b.mOther[i];
+		}
+	});
+	Sink(out[0].GetAsFloatPtr(), 16);
+
+#if MATH_SIMD
+	Bench("MultiplySIMD", n, repeats, [&]() {
+		for (size_t i = 0; i < n; i++)
+		{
+			out[i] = Matrix4::MultiplySIMD(b.mWorld[i], b.mOther[i]);
+		}
+	});
+	Sink(out[0].GetAsFloatPtr(), 16);
+#endif
+
+	Bench("CreateLookAt", n, repeats, [&]() {
+		for (size_t i = 0; i < n; i++)
+		{
+			out[i] = Matrix4::CreateLookAt(
+				Vector3(b.mPosX[i], b.mPosY[i], b.mPosZ[i]),
+				Vector3(b.mTargetX[i], b.mTargetY[i], b.mTargetZ[i]),
+				Vector3::UnitZ);
+		}
+	});
+	Sink(out[0].GetAsFloatPtr(), 16);
+
+	Bench("Invert", n, repeats, [&]() {
+		for (size_t i = 0; i < n; i++)
+		{
+			out[i] = b.mWorld[i];
+			out[i].Invert();
+		}
+	});
+	Sink(out[0].GetAsFloatPtr(), 16);
+
+	Bench("InvertScalar", n, repeats, [&]() {
+		for (size_t i = 0; i < n; i++)
+		{
+			out[i] = b.mWorld[i];
+			out[i].InvertScalar();
+		}
+	});
+	Sink(out[0].GetAsFloatPtr(), 16);
+
+	Bench("CreateFromQuaternion", n, repeats, [&]() {
+		for (size_t i = 0; i < n; i++)
+		{
+			out[i] = Matrix4::CreateFromQuaternion(b.mQuatA[i]);
+		}
+	});
+	Sink(out[0].GetAsFloatPtr(), 16);
+
+	Bench("CreateFromQuaternionScalar", n, repeats, [&]() {
+		for (size_t i = 0; i < n; i++)
+		{
+			out[i] = Matrix4::CreateFromQuaternionScalar(b.mQuatA[i]);
+		}
+	});
+	Sink(out[0].GetAsFloatPtr(), 16);
+
+	Bench("world: scale*rotZ*quat*trans chain", n, repeats, [&]() {
+		for (size_t i = 0; i < n; i++)
+		{
+			out[i] = Matrix4::CreateScale(b.mScale[i]) *
+				Matrix4::CreateRotationZ(b.mRotZ[i]) *
+				Matrix4::CreateFromQuaternion(b.mQuatA[i]) *
+				Matrix4::CreateTranslation(
+					Vector3(b.mPosX[i], b.mPosY[i], b.mPosZ[i]));
+		}
+	});
+	Sink(out[0].GetAsFloatPtr(), 16);
+
+	printf("Affine3x4\n");
+	Bench("CreateWorld", n, repeats, [&]() {
+		for (size_t i = 0; i < n; i++)
+		{
+			outAffine[i] = Affine3x4::CreateWorld(b.mScale[i], b.mRotZ[i],
+				b.mQuatA[i], Vector3(b.mPosX[i], b.mPosY[i], b.mPosZ[i]));
+		}
+	});
+	Sink(outAffine[0].GetAsFloatPtr(), 12);
+
+	std::vector<Affine3x4> world(n), view(n);
+	for (size_t i = 0; i < n; i++)
+	{
+		world[i] = Affine3x4(b.mWorld[i]);
+		view[i] = Affine3x4(b.mOther[i]);
+	}
+
+	Bench("operator* (world * view)", n, repeats, [&]() {
+		for (size_t i = 0; i < n; i++)
+		{
+			outAffine[i] = world[i] * view[i];
+		}
+	});
+	Sink(outAffine[0].GetAsFloatPtr(), 12);
+
+	Bench("ComposeScalar", n, repeats, [&]() {
+		for (size_t i = 0; i < n; i++)
+		{
+			outAffine[i] = Affine3x4::ComposeScalar(world[i], view[i]);
+		}
+	});
+	Sink(outAffine[0].GetAsFloatPtr(), 12);
+
+	Bench("Invert", n, repeats, [&]() {
+		for (size_t i = 0; i < n; i++)
+		{
+			outAffine[i] = world[i];
+			outAffine[i].Invert();
+		}
+	});
+	Sink(outAffine[0].GetAsFloatPtr(), 12);
+
+	Bench("InvertOrthonormal (look-at)", n, repeats, [&]() {
+		for (size_t i = 0; i < n; i++)
+		{
+			outAffine[i] = view[i];
+			outAffine[i].InvertOrthonormal();
+		}
+	});
+	Sink(outAffine[0].GetAsFloatPtr(), 12);
+}
+
+
+// ============================================================================
+// ============================================================================
+static void RunVectorBenchmarks(const Batch& b, int repeats)
+{
+	const size_t n = b.mCount;
+	std::vector<float> outX(n), outY(n), outZ(n);
+	const Matrix4 proj =
+		Matrix4::CreatePerspectiveFOV(Math::ToRadians(70.0f),
+									  1024.0f, 768.0f, 10.0f, 10000.0f);
+	Matrix4 unproject = b.mOther[0] * proj;
+	unproject.Invert();
+
+	auto store = [&](size_t i, const Vector3& v) {
+		outX[i] = v.x;
+		outY[i] = v.y;
+		outZ[i] = v.z;
+	};
+
+	printf("Vector3\n");
+	Bench("Transform (point by world)", n, repeats, [&]() {
+		for (size_t i = 0; i < n; i++)
+		{
+			store(i, Vector3::Transform(
+				Vector3(b.mPosX[i], b.mPosY[i], b.mPosZ[i]), b.mWorld[i]));
+		}
+	});
+	Sink(outX.data(), n);
+
+	Bench("TransformScalar", n, repeats, [&]() {
+		for (size_t i = 0; i < n; i++)
+		{
+			store(i, Vector3::TransformScalar(
+				Vector3(b.mPosX[i], b.mPosY[i], b.mPosZ[i]), b.mWorld[i]));
+		}
+	});
+	Sink(outX.data(), n);
+
+	Bench("TransformWithPerspDiv (unproject)", n, repeats, [&]() {
+		for (size_t i = 0; i < n; i++)
+		{
+			store(i, Vector3::TransformWithPerspDiv(
+				Vector3(b.mAxisX[i], b.mAxisY[i], b.mT[i]), unproject));
+		}
+	});
+	Sink(outX.data(), n);
+
+	Bench("Transform (by quaternion)", n, repeats, [&]() {
+		for (size_t i = 0; i < n; i++)
+		{
+			store(i, Vector3::Transform(
+				Vector3(b.mPosX[i], b.mPosY[i], b.mPosZ[i]), b.mQuatA[i]));
+		}
+	});
+	Sink(outX.data(), n);
+
+	std::vector<Affine3x4> world(n);
+	for (size_t i = 0; i < n; i++)
+	{
+		world[i] = Affine3x4(b.mWorld[i]);
+	}
+	Bench("Affine3x4::TransformPoint", n, repeats, [&]() {
+		for (size_t i = 0; i < n; i++)
+		{
+			store(i, world[i].TransformPoint(
+				Vector3(b.mPosX[i], b.mPosY[i], b.mPosZ[i])));
+		}
+	});
+	Sink(outX.data(), n);
+}
+
+
+// ============================================================================
+// ============================================================================
+static void RunQuaternionBenchmarks(const Batch& b, int repeats)
+{
+	const size_t n = b.mCount;
+	std::vector<Quaternion> out(n);
+
+	printf("Quaternion\n");
+	Bench("Quaternion(axis, angle)", n, repeats, [&]() {
+		for (size_t i = 0; i < n; i++)
+		{
+			out[i] = Quaternion(
+				Vector3(b.mAxisX[i], b.mAxisY[i], b.mAxisZ[i]), b.mAngle[i]);
+		}
+	});
+	Sink(&out[0].x, 4);
+
+	Bench("Slerp", n, repeats, [&]() {
+		for (size_t i = 0; i < n; i++)
+		{
+			out[i] = Quaternion::Slerp(b.mQuatA[i], b.mQuatB[i], b.mT[i]);
+		}
+	});
+	Sink(&out[0].x, 4);
+
+	Bench("Concatenate", n, repeats, [&]() {
+		for (size_t i = 0; i < n; i++)
+		{
+			out[i] = Quaternion::Concatenate(b.mQuatA[i], b.mQuatB[i]);
+		}
+	});
+	Sink(&out[0].x, 4);
+}
+
+
+// ============================================================================
+// ============================================================================
+static void RunTrigBenchmarks(const Batch& b, int repeats)
+{
+	const size_t n = b.mCount;
+	std::vector<float> out(n);
+
+	printf("Trig\n");
+	Bench("Math::Sin", n, repeats, [&]() {
+		for (size_t i = 0; i < n; i++)
+		{
+			out[i] = Math::Sin(b.mAngle[i]);
+		}
+	});
+	Sink(out.data(), n);
+
+	Bench("Math::Cos", n, repeats, [&]() {
+		for (size_t i = 0; i < n; i++)
+		{
+			out[i] = Math::Cos(b.mAngle[i]);
+		}
+	});
+	Sink(out.data(), n);
+
+	std::vector<float> out2(n);
+	Bench("Math::Sin + Math::Cos", n, repeats, [&]() {
+		for (size_t i = 0; i < n; i++)
+		{
+			out[i] = Math::Sin(b.mAngle[i]);
+			out2[i] = Math::Cos(b.mAngle[i]);
+		}
+	});
+	Sink(out.data(), n);
+	Sink(out2.data(), n);
+
+	Bench("Math::Acos", n, repeats, [&]() {
+		for (size_t i = 0; i < n; i++)
+		{
+			out[i] = Math::Acos(b.mAxisX[i]);
+		}
+	});
+	Sink(out.data(), n);
+
+	Bench("Math::Atan2", n, repeats, [&]() {
+		for (size_t i = 0; i < n; i++)
+		{
+			out[i] = Math::Atan2(b.mAxisY[i], b.mAxisX[i]);
+		}
+	});
+	Sink(out.data(), n);
+
+	Bench("Math::Sqrt", n, repeats, [&]() {
+		for (size_t i = 0; i < n; i++)
+		{
+			out[i] = Math::Sqrt(b.mScale[i]);
+		}
+	});
+	Sink(out.data(), n);
+}
+
+
+// ============================================================================
+// The orientation work PlayerMove does in a tick: one rotation change, then
+// forward/right for the input forces and forward again in CanWallClimb and
+// CanWallRun. PlayerMove itself needs SDL and a Game, so this isolates just
+// the basis part, with the same data layout the TransformSystem uses.
+// ============================================================================
+static void RunBasisBenchmarks(const Batch& b, int repeats)
+{
+	const size_t n = b.mCount;
+	std::vector<float> rotations(n);
+	std::vector<Vector3> forwards(n), rights(n), forces(n);
+
+	printf("Actor basis (PlayerMove tick)\n");
+
+	// Before: GetForward/GetRight did sin and cos of the rotation per call.
+	// In the game those calls are spread over several functions, so the
+	// rotation is re-read through volatile to stop the compiler merging them.
+	auto getRotation = [&](size_t i) {
+		return *static_cast<const volatile float*>(&rotations[i]);
+	};
+	Bench("per-call sin/cos", n, repeats, [&]() {
+		for (size_t i = 0; i < n; i++)
+		{
+			rotations[i] = b.mAngle[i];
+
+			Vector3 force = Vector3(Math::Cos(getRotation(i)),
+									Math::Sin(getRotation(i)), 0.0f) * 700.0f;
+			force += Vector3(Math::Cos(getRotation(i) + Math::PiOver2),
+							 Math::Sin(getRotation(i) + Math::PiOver2), 0.0f) * 700.0f;
+			const Vector3 climb(Math::Cos(getRotation(i)),
+								Math::Sin(getRotation(i)), 0.0f);
+			const Vector3 run(Math::Cos(getRotation(i)),
+							  Math::Sin(getRotation(i)), 0.0f);
+			forces[i] = force + climb * b.mT[i] + run;
+		}
+	});
+	Sink(&forces[0].x, 3);
+
+	// After: the setter refreshes the cached basis once, readers just load it
+	Bench("cached basis", n, repeats, [&]() {
+		for (size_t i = 0; i < n; i++)
+		{
+			rotations[i] = b.mAngle[i];
+			const float s = Math::Sin(rotations[i]);
+			const float c = Math::Cos(rotations[i]);
+			forwards[i] = Vector3(c, s, 0.0f);
+			rights[i] = Vector3(-s, c, 0.0f);
+
+			Vector3 force = forwards[i] * 700.0f;
+			force += rights[i] * 700.0f;
+			const Vector3& climb = forwards[i];
+			const Vector3& run = forwards[i];
+			forces[i] = force + climb * b.mT[i] + run;
+		}
+	});
+	Sink(&forces[0].x, 3);
+}
+
+
+// ============================================================================
+// ============================================================================
+static bool PrintReport(const UlpReport& r)
+{
+	const bool passed = r.mMaxUlp <= r.mTolerance;
+	printf("  %-40s max %8.2f ulp  exact %6.2f%%  limit %5.2f%s\n", r.mName,
+		   r.mMaxUlp, 100.0 * static_cast<double>(r.mExact) / static_cast<double>(r.mTotal),
+		   r.mTolerance, passed ? "" : "  FAIL");
+	return passed;
+}
+
+
+// Accuracy tolerances in ULPs (see RunAccuracy)
+static const double sExactUlp = 0.0;
+static const double sInvertUlp = 16.0;
+static const double sTrigUlp = 1.0;
+
+
+// ============================================================================
+// The SIMD kernels do the same float operations in the same order as their
+// scalar versions, so anything but an exact match is a bug. The inverses are
+// held to the double result; the random matrices are well conditioned and
+// land within about 5 ULPs, so 16 leaves room without hiding a broken
+// cofactor. Returns false if any report is over its tolerance.
+// ============================================================================
+static bool RunAccuracy(const Batch& b)
+{
+	const size_t n = b.mCount;
+#if MATH_SIMD
+	UlpReport multiply = { "Matrix4 MultiplySIMD vs MultiplyScalar", sExactUlp, 0.0, 0, 0 };
+#endif
+	UlpReport transform = { "Vector3::Transform vs TransformScalar", sExactUlp, 0.0, 0, 0 };
+	UlpReport fromQuat = { "CreateFromQuaternion vs Scalar", sExactUlp, 0.0, 0, 0 };
+	UlpReport invert = { "Invert vs double", sInvertUlp, 0.0, 0, 0 };
+	UlpReport invertScalar = { "InvertScalar vs double", sInvertUlp, 0.0, 0, 0 };
+#if MATH_SIMD
+	UlpReport compose = { "Affine3x4 ComposeSIMD vs ComposeScalar", sExactUlp, 0.0, 0, 0 };
+#endif
+	UlpReport world = { "Affine3x4::CreateWorld vs Matrix4 chain", sExactUlp, 0.0, 0, 0 };
+	UlpReport affineInvert = { "Affine3x4::Invert vs double", sInvertUlp, 0.0, 0, 0 };
+	UlpReport rigidInvert = { "Affine3x4::InvertOrthonormal vs double", sInvertUlp, 0.0, 0, 0 };
+	UlpReport sinCos = { "Math::Sin/Cos vs double", sTrigUlp, 0.0, 0, 0 };
+
+	for (size_t i = 0; i < n; i++)
+	{
+#if MATH_SIMD
+		const Matrix4 fast = Matrix4::MultiplySIMD(b.mWorld[i], b.mOther[i]);
+		const Matrix4 ref = Matrix4::MultiplyScalar(b.mWorld[i], b.mOther[i]);
+		Accumulate(multiply, fast.GetAsFloatPtr(), ref.GetAsFloatPtr(), 16);
+#endif
+
+		const Vector3 p(b.mPosX[i], b.mPosY[i], b.mPosZ[i]);
+		const Vector3 v = Vector3::Transform(p, b.mWorld[i]);
+		const Vector3 vRef = Vector3::TransformScalar(p, b.mWorld[i]);
+		Accumulate(transform, v.GetAsFloatPtr(), vRef.GetAsFloatPtr(), 3);
+
+		const Matrix4 q = Matrix4::CreateFromQuaternion(b.mQuatA[i]);
+		const Matrix4 qRef = Matrix4::CreateFromQuaternionScalar(b.mQuatA[i]);
+		Accumulate(fromQuat, q.GetAsFloatPtr(), qRef.GetAsFloatPtr(), 16);
+
+		double invRef[16];
+		InvertDouble(b.mWorld[i], invRef);
+		Matrix4 inv = b.mWorld[i];
+		inv.Invert();
+		Accumulate(invert, inv.GetAsFloatPtr(), invRef, 16);
+		inv = b.mWorld[i];
+		inv.InvertScalar();
+		Accumulate(invertScalar, inv.GetAsFloatPtr(), invRef, 16);
+
+		const Affine3x4 w = Affine3x4::CreateWorld(b.mScale[i], b.mRotZ[i],
+												   b.mQuatA[i], p);
+		const Matrix4 wFull = w.ToMatrix4();
+		Accumulate(world, wFull.GetAsFloatPtr(), b.mWorld[i].GetAsFloatPtr(), 16);
+
+#if MATH_SIMD
+		const Affine3x4 wAff(b.mWorld[i]);
+		const Affine3x4 vAff(b.mOther[i]);
+		const Affine3x4 comp = Affine3x4::ComposeSIMD(wAff, vAff);
+		const Affine3x4 compRef = Affine3x4::ComposeScalar(wAff, vAff);
+		Accumulate(compose, comp.GetAsFloatPtr(), compRef.GetAsFloatPtr(), 12);
+#endif
+
+		Affine3x4 affInv(b.mWorld[i]);
+		affInv.Invert();
+		const Matrix4 affInvFull = affInv.ToMatrix4();
+		Accumulate(affineInvert, affInvFull.GetAsFloatPtr(), invRef, 16);
+
+		double viewInvRef[16];
+		InvertDouble(b.mOther[i], viewInvRef);
+		Affine3x4 viewInv(b.mOther[i]);
+		viewInv.InvertOrthonormal();
+		const Matrix4 viewInvFull = viewInv.ToMatrix4();
+		Accumulate(rigidInvert, viewInvFull.GetAsFloatPtr(), viewInvRef, 16);
+
+		// Angles well outside [-pi, pi] too, rotations accumulate
+		const float angle = b.mAngle[i] * 8.0f;
+		const double scRef[2] = { sin(static_cast<double>(angle)),
+								  cos(static_cast<double>(angle)) };
+		float sc[2];
+		sc[0] = Math::Sin(angle);
+		sc[1] = Math::Cos(angle);
+		Accumulate(sinCos, sc, scRef, 2);
+	}
+
+	printf("Accuracy (error in ULPs of the largest reference element)\n");
+	bool passed = true;
+#if MATH_SIMD
+	passed &= PrintReport(multiply);
+#endif
+	passed &= PrintReport(transform);
+	passed &= PrintReport(fromQuat);
+	passed &= PrintReport(invert);
+	passed &= PrintReport(invertScalar);
+#if MATH_SIMD
+	passed &= PrintReport(compose);
+#endif
+	passed &= PrintReport(world);
+	passed &= PrintReport(affineInvert);
+	passed &= PrintReport(rigidInvert);
+	passed &= PrintReport(sinCos);
+	printf(passed ? "All within tolerance\n" : "Accuracy check FAILED\n");
+	return passed;
+}
+
+
+// ============================================================================
+// ============================================================================
+int main(int argc, char** argv)
+{
+	size_t count = 4096;
+	int repeats = 50;
+	bool checkOnly = false;
+	if (argc > 1 && strcmp(argv[1], "--check") == 0)
+	{
+		checkOnly = true;
+		argc--;
+		argv++;
+	}
+	if (argc > 1)
+	{
+		count = static_cast<size_t>(std::max(1, atoi(argv[1])));
+	}
+	if (argc > 2)
+	{
+		repeats = std::max(1, atoi(argv[2]));
+	}
+
+	const Batch batch = MakeBatch(count);
+	if (checkOnly)
+	{
+		printf("MathBench: checking a batch of %u, SIMD %s\n",
+			   static_cast<unsigned>(count), MATH_SIMD ? "on" : "off");
+		return RunAccuracy(batch) ? 0 : 1;
+	}
+
+	printf("MathBench: batch of %u, best of %d, SIMD %s\n",
+		   static_cast<unsigned>(count), repeats, MATH_SIMD ? "on" : "off");
+
+	RunMatrixBenchmarks(batch, repeats);
+	RunVectorBenchmarks(batch, repeats);
+	RunQuaternionBenchmarks(batch, repeats);
+	RunTrigBenchmarks(batch, repeats);
+	RunBasisBenchmarks(batch, repeats);
+	const bool passed = RunAccuracy(batch);
+
+	// Keep the sink alive
+	if (gSink == 12345.0f)
+	{
+		printf("\n");
+	}
+	return passed ? 0 : 1;
+}
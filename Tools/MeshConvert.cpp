@@ -0,0 +1,151 @@
+// Compiles .gpmesh (JSON) meshes into the binary format Mesh::Load maps
+// directly (see MeshBinary.h). Each input is written next to itself as
+// <input>.bin; rerun after editing a .gpmesh or the stale binary wins.
+//
+// Build from the repo root with the game's rapidjson and SDL include paths
+// (SDL is only needed for SDL_Log):
+//   g++ -std=c++14 -O2 <includes> Tools/MeshConvert.cpp MeshBinary.cpp
+//       JSONParser.cpp MemoryTracker.cpp FileSystem.cpp AssetPack.cpp LZ4.cpp
+//       MappedFile.cpp -lSDL2
+//   cl /O2 /EHsc <includes> Tools\MeshConvert.cpp MeshBinary.cpp
+//       JSONParser.cpp MemoryTracker.cpp FileSystem.cpp AssetPack.cpp LZ4.cpp
+//       MappedFile.cpp SDL2.lib
+//
+// Usage: MeshConvert [--compare] file.gpmesh...
+//   --compare  after converting, time loading each mesh from JSON and from
+//              the binary (best of several runs, warm file cache)
+#include "../MeshBinary.h"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+static const int sCompareRuns = 20;
+
+// Stops the compiler from skipping the reads being timed
+static volatile float gSink = 0.0f;
+
+
+// ============================================================================
+// ============================================================================
+template <typename Fn>
+static double BestMS(Fn fn)
+{
+	typedef std::chrono::steady_clock Clock;
+	double best = 1e30;
+	for (int i = 0; i < sCompareRuns; i++)
+	{
+		const auto start = Clock::now();
+		fn();
+		const auto end = Clock::now();
+		const double ms =
+			std::chrono::duration<double, std::milli>(end - start).count();
+		if (ms < best)
+		{
+			best = ms;
+		}
+	}
+	return best;
+}
+
+
+// ============================================================================
+// Touch every vertex and index, like glBufferData does when uploading
+// ============================================================================
+static float Checksum(const float* verts, size_t numFloats,
+					  const unsigned int* indices, size_t numIndices)
+{
+	float sum = 0.0f;
+	for (size_t i = 0; i < numFloats; i++)
+	{
+		sum += verts[i];
+	}
+	for (size_t i = 0; i < numIndices; i++)
+	{
+		sum += static_cast<float>(indices[i]);
+	}
+	return sum;
+}
+
+
+// ============================================================================
+// ============================================================================
+static void Compare(const std::string& fileName)
+{
+	const double jsonMS = BestMS([&]() {
+		MeshData data;
+		if (MeshBinary::ParseJSON(fileName, data))
+		{
+			gSink = gSink + Checksum(data.mVertices.data(), data.mVertices.size(),
+									 data.mIndices.data(), data.mIndices.size());
+		}
+	});
+
+	const double binaryMS = BestMS([&]() {
+		MeshBinary binary;
+		if (binary.Open(fileName + ".bin"))
+		{
+			gSink = gSink + Checksum(binary.GetVertices(),
+									 binary.GetNumVerts() * MeshBinary::VertexSize,
+									 binary.GetIndices(), binary.GetNumIndices());
+		}
+	});
+
+	printf("  %-32s json %8.3f ms   binary %8.3f ms   %6.1fx\n",
+		   fileName.c_str(), jsonMS, binaryMS, jsonMS / binaryMS);
+}
+
+
+// ============================================================================
+// ============================================================================
+int main(int argc, char** argv)
+{
+	bool compare = false;
+	std::vector<std::string> files;
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--compare") == 0)
+		{
+			compare = true;
+		}
+		else
+		{
+			files.emplace_back(argv[i]);
+		}
+	}
+
+	if (files.empty())
+	{
+		printf("Usage: MeshConvert [--compare] file.gpmesh...\n");
+		return 1;
+	}
+
+	int failures = 0;
+	for (const auto& file : files)
+	{
+		MeshData data;
+		if (!MeshBinary::ParseJSON(file, data) ||
+			!MeshBinary::Write(file + ".bin", data))
+		{
+			printf("%s: FAILED\n", file.c_str());
+			failures++;
+			continue;
+		}
+		printf("%s -> %s.bin (%u verts, %u indices, %u textures)\n",
+			   file.c_str(), file.c_str(),
+			   static_cast<unsigned>(data.mVertices.size() / MeshBinary::VertexSize),
+			   static_cast<unsigned>(data.mIndices.size()),
+			   static_cast<unsigned>(data.mTextures.size()));
+	}
+
+	if (compare)
+	{
+		printf("Load time, best of %d:\n", sCompareRuns);
+		for (const auto& file : files)
+		{
+			Compare(file);
+		}
+	}
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,318 @@
+// parkour-pack: packs every file under the given directories into one asset
+// pack (see AssetPack.h). The game mounts Assets.pak from its working
+// directory at startup and reads anything in it from there instead of from
+// the loose file; run it with --loose to ignore the pack. Names are stored as
+// the paths given, so run this from the directory the game runs in, after
+// parkour-cook so the cooked files go in too:
+//   parkour-pack Assets.pak Assets Shaders
+// Rerun after changing any asset or the stale pack wins.
+//
+// Build from the repo root with the game's SDL include path (SDL is only
+// needed for SDL_Log):
+//   g++ -std=c++14 -O2 <includes> -o parkour-pack Tools/Pack.cpp AssetPack.cpp
+//       LZ4.cpp FileSystem.cpp MappedFile.cpp -lSDL2
+//   (cl /O2 /EHsc with the same sources and SDL2.lib)
+//
+// Usage: parkour-pack [--compress] [--compare] out.pak dir...
+//   --compress  LZ4 compress every file it shrinks by at least a quarter.
+//               Smaller on disk, but compressed entries are decompressed
+//               into memory rather than read in place, which costs more
+//               than it saves when the pack is read from a local disk.
+//   --compare   afterwards, time reading every packed file loose and from
+//               the pack, with a warm file cache and (on Linux) a cold one
+#include "../AssetPack.h"
+#include "../FileSystem.h"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static const int sCompareRuns = 10;
+
+// Stops the compiler from skipping the reads being timed
+static volatile size_t gSink = 0;
+
+
+// ============================================================================
+// ============================================================================
+static bool EndsWith(const std::string& str, const char* suffix)
+{
+	const size_t len = strlen(suffix);
+	return str.size() >= len && str.compare(str.size() - len, len, suffix) == 0;
+}
+
+
+// ============================================================================
+// Every file under dir, recursively, with '/' separators
+// ============================================================================
+static void ListFiles(const std::string& dir, std::vector<std::string>& outFiles)
+{
+#ifdef _WIN32
+	WIN32_FIND_DATAA findData;
+	HANDLE find = FindFirstFileA((dir + "/*").c_str(), &findData);
+	if (find == INVALID_HANDLE_VALUE)
+	{
+		return;
+	}
+	do
+	{
+		const std::string name = findData.cFileName;
+		if (name == "." || name == "..")
+		{
+			continue;
+		}
+		if (findData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)
+		{
+			ListFiles(dir + "/" + name, outFiles);
+		}
+		else
+		{
+			outFiles.emplace_back(dir + "/" + name);
+		}
+	} while (FindNextFileA(find, &findData));
+	FindClose(find);
+#else
+	DIR* d = opendir(dir.c_str());
+	if (d == nullptr)
+	{
+		return;
+	}
+	while (dirent* entry = readdir(d))
+	{
+		const std::string name = entry->d_name;
+		if (name == "." || name == "..")
+		{
+			continue;
+		}
+		const std::string path = dir + "/" + name;
+		struct stat info;
+		if (stat(path.c_str(), &info) != 0)
+		{
+			continue;
+		}
+		if (S_ISDIR(info.st_mode))
+		{
+			ListFiles(path, outFiles);
+		}
+		else
+		{
+			outFiles.emplace_back(path);
+		}
+	}
+	closedir(d);
+#endif
+}
+
+
+// ============================================================================
+// Files the game never reads: the cooker's bookkeeping and other packs
+// ============================================================================
+static bool ShouldPack(const std::string& fileName)
+{
+	return !EndsWith(fileName, "/CookManifest.txt") && !EndsWith(fileName, ".pak");
+}
+
+
+// ============================================================================
+// Drop a file from the OS file cache so the next read comes off the disk
+// ============================================================================
+static bool Evict(const std::string& fileName)
+{
+#ifdef _WIN32
+	return false;
+#else
+	const int fd = open(fileName.c_str(), O_RDONLY);
+	if (fd < 0)
+	{
+		return false;
+	}
+	const bool evicted = posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED) == 0;
+	close(fd);
+	return evicted;
+#endif
+}
+
+
+// ============================================================================
+// Read every file through FileSystem, as the game's loaders do. With the
+// pack, mounting it is part of the time.
+// ============================================================================
+static double ReadAll(const std::vector<std::string>& files, const char* packFile)
+{
+	typedef std::chrono::steady_clock Clock;
+	const auto start = Clock::now();
+	if (packFile)
+	{
+		FileSystem::Mount(packFile);
+	}
+	std::vector<char> buffer;
+	for (const auto& file : files)
+	{
+		if (FileSystem::ReadFile(file, buffer))
+		{
+			gSink = gSink + buffer.size();
+		}
+	}
+	FileSystem::Unmount();
+	return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+
+// ============================================================================
+// ============================================================================
+static void Compare(const std::vector<std::string>& files, const char* packFile)
+{
+	double looseMS = 1e30;
+	double packMS = 1e30;
+	for (int i = 0; i < sCompareRuns; i++)
+	{
+		const double loose = ReadAll(files, nullptr);
+		const double packed = ReadAll(files, packFile);
+		looseMS = loose < looseMS ? loose : looseMS;
+		packMS = packed < packMS ? packed : packMS;
+	}
+	printf("Reading %u files, warm cache, best of %d:\n",
+		   static_cast<unsigned>(files.size()), sCompareRuns);
+	printf("  loose %8.3f ms   pack %8.3f ms   %5.1fx\n", looseMS, packMS,
+		   looseMS / packMS);
+
+	bool evicted = Evict(packFile);
+	for (const auto& file : files)
+	{
+		evicted = Evict(file) && evicted;
+	}
+	if (!evicted)
+	{
+		printf("Can't drop files from the OS cache here, skipping the cold read\n");
+		return;
+	}
+	looseMS = ReadAll(files, nullptr);
+	packMS = ReadAll(files, packFile);
+	printf("Cold cache (evicted first, one run):\n");
+	printf("  loose %8.3f ms   pack %8.3f ms   %5.1fx\n", looseMS, packMS,
+		   looseMS / packMS);
+}
+
+
+// ============================================================================
+// ============================================================================
+int main(int argc, char** argv)
+{
+	bool compress = false;
+	bool compare = false;
+	const char* packFile = nullptr;
+	std::vector<std::string> dirs;
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--compress") == 0)
+		{
+			compress = true;
+		}
+		else if (strcmp(argv[i], "--compare") == 0)
+		{
+			compare = true;
+		}
+		else if (argv[i][0] == '-')
+		{
+			dirs.clear();
+			break;
+		}
+		else if (packFile == nullptr)
+		{
+			packFile = argv[i];
+		}
+		else
+		{
+			dirs.emplace_back(argv[i]);
+		}
+	}
+	if (dirs.empty())
+	{
+		printf("Usage: parkour-pack [--compress] [--compare] out.pak dir...\n");
+		return 1;
+	}
+
+	std::vector<std::string> files;
+	for (const auto& dir : dirs)
+	{
+		ListFiles(dir, files);
+	}
+
+	std::vector<AssetPackSource> sources;
+	std::vector<std::string> packed;
+	size_t totalBytes = 0;
+	for (const auto& file : files)
+	{
+		if (!ShouldPack(file))
+		{
+			continue;
+		}
+		std::ifstream in(file, std::ios::binary);
+		if (!in.is_open())
+		{
+			printf("Couldn't read %s\n", file.c_str());
+			return 1;
+		}
+		AssetPackSource source;
+		source.mName = file;
+		source.mData.assign(std::istreambuf_iterator<char>(in),
+							std::istreambuf_iterator<char>());
+		source.mCompress = compress;
+		totalBytes += source.mData.size();
+		sources.emplace_back(std::move(source));
+		packed.emplace_back(file);
+	}
+
+	if (!AssetPack::Write(packFile, sources))
+	{
+		return 1;
+	}
+
+	AssetPack pack;
+	if (!pack.Open(packFile))
+	{
+		printf("Couldn't read back %s\n", packFile);
+		return 1;
+	}
+	// Every file has to come back out byte for byte
+	size_t storedBytes = 0;
+	size_t numCompressed = 0;
+	std::vector<unsigned char> extracted;
+	for (const auto& source : sources)
+	{
+		const AssetPackEntry* entry = pack.Find(source.mName);
+		extracted.resize(source.mData.size());
+		if (entry == nullptr || entry->mSize != source.mData.size() ||
+			!pack.Extract(*entry, extracted.data()) || extracted != source.mData)
+		{
+			printf("%s doesn't read back from %s\n", source.mName.c_str(), packFile);
+			return 1;
+		}
+		storedBytes += static_cast<size_t>(entry->mStoredSize);
+		numCompressed += (entry->mFlags & AssetPackCompressed) ? 1 : 0;
+	}
+	printf("%s: %u files (%u compressed), %.1f KB -> %.1f KB\n", packFile,
+		   static_cast<unsigned>(pack.GetNumEntries()),
+		   static_cast<unsigned>(numCompressed), totalBytes / 1024.0,
+		   storedBytes / 1024.0);
+	pack.Close();
+
+	if (compare)
+	{
+		Compare(packed, packFile);
+	}
+	return 0;
+}
@@ -0,0 +1,213 @@
+#include "TransformSystem.h"
+#include "Actor.h"
+
+
+// ============================================================================
+// ============================================================================
+TransformSystem::TransformSystem()
+{
+}
+
+
+// ============================================================================
+// ============================================================================
+size_t TransformSystem::Add(Actor* owner)
+{
+	const size_t index = mOwners.size();
+	mPositions.emplace_back(Vector3::Zero);
+	mScales.emplace_back(1.0f);
+	mRotations.emplace_back(0.0f);
+	mQuats.emplace_back(Quaternion::Identity);
+	mForwards.emplace_back(Vector3::UnitX);
+	mRights.emplace_back(Vector3::UnitY);
+	mUps.emplace_back(Vector3::UnitZ);
+	mDirty.emplace_back(0);
+	mWorldTransforms.emplace_back(Affine3x4::Identity);
+	mOwners.emplace_back(owner);
+	MarkDirty(index);
+	return index;
+}
+
+
+// ============================================================================
+// ============================================================================
+size_t TransformSystem::AddRange(size_t count)
+{
+	const size_t first = mOwners.size();
+	const size_t size = first + count;
+	mPositions.resize(size, Vector3::Zero);
+	mScales.resize(size, 1.0f);
+	mRotations.resize(size, 0.0f);
+	mQuats.resize(size, Quaternion::Identity);
+	mForwards.resize(size, Vector3::UnitX);
+	mRights.resize(size, Vector3::UnitY);
+	mUps.resize(size, Vector3::UnitZ);
+	mDirty.resize(size, 0);
+	mWorldTransforms.resize(size, Affine3x4::Identity);
+	mOwners.resize(size, nullptr);
+	return first;
+}
+
+
+// ============================================================================
+// ============================================================================
+void TransformSystem::Place(size_t index, const Vector3& pos, float scale,
+							float rotation)
+{
+	mPositions[index] = pos;
+	mScales[index] = scale;
+	mRotations[index] = rotation;
+	mQuats[index] = Quaternion::Identity;
+	UpdateBasis(index);
+	UpdateWorldTransform(index);
+}
+
+
+// ============================================================================
+// ============================================================================
+void TransformSystem::Remove(Actor* owner, size_t index)
+{
+	if (index >= mOwners.size() || mOwners[index] != owner)
+	{
+		return;
+	}
+
+	const size_t last = mOwners.size() - 1;
+	if (index != last)
+	{
+		mPositions[index] = mPositions[last];
+		mScales[index] = mScales[last];
+		mRotations[index] = mRotations[last];
+		mQuats[index] = mQuats[last];
+		mForwards[index] = mForwards[last];
+		mRights[index] = mRights[last];
+		mUps[index] = mUps[last];
+		mWorldTransforms[index] = mWorldTransforms[last];
+		mOwners[index] = mOwners[last];
+		mOwners[index]->SetTransformIndex(index);
+
+		// Carry the dirty bit over to the new slot
+		mDirty[index] = 0;
+		if (mDirty[last])
+		{
+			MarkDirty(index);
+		}
+	}
+
+	mPositions.pop_back();
+	mScales.pop_back();
+	mRotations.pop_back();
+	mQuats.pop_back();
+	mForwards.pop_back();
+	mRights.pop_back();
+	mUps.pop_back();
+	mDirty.pop_back();
+	mWorldTransforms.pop_back();
+	mOwners.pop_back();
+}
+
+
+// ============================================================================
+// ============================================================================
+void TransformSystem::Clear()
+{
+	mPositions.clear();
+	mScales.clear();
+	mRotations.clear();
+	mQuats.clear();
+	mForwards.clear();
+	mRights.clear();
+	mUps.clear();
+	mDirty.clear();
+	mWorldTransforms.clear();
+	mOwners.clear();
+	mDirtyList.clear();
+}
+
+
+// ============================================================================
+// ============================================================================
+void TransformSystem::Reserve(size_t count)
+{
+	mPositions.reserve(count);
+	mScales.reserve(count);
+	mRotations.reserve(count);
+	mQuats.reserve(count);
+	mForwards.reserve(count);
+	mRights.reserve(count);
+	mUps.reserve(count);
+	mDirty.reserve(count);
+	mWorldTransforms.reserve(count);
+	mOwners.reserve(count);
+	mDirtyList.reserve(count);
+}
+
+
+// ============================================================================
+// The rotation is rotationZ then the quaternion, so each basis vector is the
+// matching row of the z rotation pushed through the quaternion's 3x3. Most
+// actors never set a quaternion, skip the matrix for those.
+// ============================================================================
+void TransformSystem::UpdateBasis(size_t index)
+{
+	const float s = Math::Sin(mRotations[index]);
+	const float c = Math::Cos(mRotations[index]);
+
+	const Quaternion& q = mQuats[index];
+	if (q.x == 0.0f && q.y == 0.0f && q.z == 0.0f && q.w == 1.0f)
+	{
+		mForwards[index] = Vector3(c, s, 0.0f);
+		mRights[index] = Vector3(-s, c, 0.0f);
+		mUps[index] = Vector3::UnitZ;
+		return;
+	}
+
+	const Matrix4 r = Matrix4::CreateFromQuaternion(q);
+	const Vector3 q0(r.mat[0][0], r.mat[0][1], r.mat[0][2]);
+	const Vector3 q1(r.mat[1][0], r.mat[1][1], r.mat[1][2]);
+	mForwards[index] = q0 * c + q1 * s;
+	mRights[index] = q1 * c - q0 * s;
+	mUps[index] = Vector3(r.mat[2][0], r.mat[2][1], r.mat[2][2]);
+}
+
+
+// ============================================================================
+// worldMatrix = scale * rotationZ * quaternion * translation. The rotation
+// rows are the cached basis, so this is just a scale per row plus the
+// position; no trig or matrix products.
+// ============================================================================
+void TransformSystem::UpdateWorldTransform(size_t index)
+{
+	const float scale = mScales[index];
+	const Vector3 forward = mForwards[index] * scale;
+	const Vector3 right = mRights[index] * scale;
+	const Vector3 up = mUps[index] * scale;
+	const Vector3& pos = mPositions[index];
+	float temp[4][3] =
+	{
+		{ forward.x, forward.y, forward.z },
+		{ right.x, right.y, right.z },
+		{ up.x, up.y, up.z },
+		{ pos.x, pos.y, pos.z }
+	};
+	mWorldTransforms[index] = Affine3x4(temp);
+}
+
+
+// ============================================================================
+// Only slots touched since the last update are rebuilt
+// ============================================================================
+void TransformSystem::Update()
+{
+	const size_t count = mOwners.size();
+	for (auto index : mDirtyList)
+	{
+		if (index >= count || !mDirty[index])
+		{
+			continue;
+		}
+		mDirty[index] = 0;
+		UpdateWorldTransform(index);
+	}
+	mDirtyList.clear();
+}
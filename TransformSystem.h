@@ -0,0 +1,117 @@
+#pragma once
+#include <vector>
+#include "Math.h"
+
+// Structure-of-arrays storage for every actor's transform. Actors own a slot
+// index and read/write through it; any write marks the slot dirty. Once per
+// frame Update rebuilds the world matrix of just the dirty slots, so static
+// level geometry costs nothing after its first frame.
+class TransformSystem
+{
+public:
+	TransformSystem();
+
+	// Allocate a slot for this actor (starts at the identity transform)
+	size_t Add(class Actor* owner);
+
+	// Append count slots with no owner yet, for a level load to fill in with
+	// Place and hand out with SetOwner. Returns the first one.
+	size_t AddRange(size_t count);
+
+	// Set a slot's whole transform and build its world matrix right away
+	// rather than marking it dirty. Touches only that slot, so different
+	// slots can be placed from different threads.
+	void Place(size_t index, const Vector3& pos, float scale, float rotation);
+
+	void SetOwner(size_t index, class Actor* owner) { mOwners[index] = owner; }
+
+	// Free a slot by moving the last one into it. Ignored if the slot no
+	// longer belongs to this actor (the system was cleared in bulk).
+	void Remove(class Actor* owner, size_t index);
+
+	// Drop every slot at once (for level teardown)
+	void Clear();
+
+	// Grow every array up front so a level load doesn't reallocate per actor
+	void Reserve(size_t count);
+
+	// Recompute the world matrices of every dirty slot
+	void Update();
+
+	const Vector3& GetPosition(size_t index) const { return mPositions[index]; }
+	void SetPosition(size_t index, const Vector3& pos)
+	{
+		mPositions[index] = pos;
+		MarkDirty(index);
+	}
+
+	float GetScale(size_t index) const { return mScales[index]; }
+	void SetScale(size_t index, float scale)
+	{
+		mScales[index] = scale;
+		MarkDirty(index);
+	}
+
+	float GetRotation(size_t index) const { return mRotations[index]; }
+	void SetRotation(size_t index, float rotation)
+	{
+		mRotations[index] = rotation;
+		UpdateBasis(index);
+		MarkDirty(index);
+	}
+
+	const Quaternion& GetQuaternion(size_t index) const { return mQuats[index]; }
+	void SetQuaternion(size_t index, const Quaternion& quat)
+	{
+		mQuats[index] = quat;
+		UpdateBasis(index);
+		MarkDirty(index);
+	}
+
+	// World-space axes of the rotation (z rotation, then quaternion). These
+	// are the rows of the world rotation, kept current by the rotation
+	// setters so reading them is just a load.
+	const Vector3& GetForward(size_t index) const { return mForwards[index]; }
+	const Vector3& GetRight(size_t index) const { return mRights[index]; }
+	const Vector3& GetUp(size_t index) const { return mUps[index]; }
+
+	const Affine3x4& GetWorldTransform(size_t index) const
+	{
+		return mWorldTransforms[index];
+	}
+
+	// Every world matrix, packed back to back in slot order
+	const Affine3x4* GetWorldTransforms() const { return mWorldTransforms.data(); }
+	size_t GetNumTransforms() const { return mOwners.size(); }
+
+private:
+	// Recompute the forward/right/up basis after a rotation change
+	void UpdateBasis(size_t index);
+
+	// Rebuild the world matrix from the basis, scale and position
+	void UpdateWorldTransform(size_t index);
+
+	void MarkDirty(size_t index)
+	{
+		if (!mDirty[index])
+		{
+			mDirty[index] = 1;
+			mDirtyList.emplace_back(index);
+		}
+	}
+
+	std::vector<Vector3> mPositions;
+	std::vector<float> mScales;
+	std::vector<float> mRotations;
+	std::vector<Quaternion> mQuats;
+	std::vector<Vector3> mForwards;
+	std::vector<Vector3> mRights;
+	std::vector<Vector3> mUps;
+	std::vector<unsigned char> mDirty;
+	std::vector<Affine3x4> mWorldTransforms;
+	std::vector<class Actor*> mOwners;
+
+	// Slots marked dirty since the last Update. May hold stale or repeated
+	// indices after a Remove, Update filters those with mDirty.
+	std::vector<size_t> mDirtyList;
+};
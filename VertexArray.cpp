@@ -1,4 +1,5 @@
 #include "VertexArray.h"
+#include "MemoryTracker.h"
 #include <GL/glew.h>
 
 
@@ -44,6 +45,8 @@ VertexArray::VertexArray(const float* verts, unsigned int numVerts,
 	glEnableVertexAttribArray(2);
 	glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float),
 		reinterpret_cast<void*>(sizeof(float) * 6));
+
+	MemoryTracker::Add(MemoryVertexBuffers, GetBufferBytes());
 }
 
 
@@ -54,6 +57,7 @@ VertexArray::~VertexArray()
 	glDeleteBuffers(1, &mVertexBuffer);
 	glDeleteBuffers(1, &mIndexBuffer);
 	glDeleteVertexArrays(1, &mVertexArray);
+	MemoryTracker::Remove(MemoryVertexBuffers, GetBufferBytes());
 }
 
 
@@ -64,3 +68,12 @@ void VertexArray::SetActive()
 	glBindVertexArray(mVertexArray);
 	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mIndexBuffer);
 }
+
+
+// ============================================================================
+// ============================================================================
+size_t VertexArray::GetBufferBytes() const
+{
+	return static_cast<size_t>(mNumVerts) * 8 * sizeof(float) +
+		static_cast<size_t>(mNumIndices) * sizeof(unsigned int);
+}
@@ -1,4 +1,6 @@
 #pragma once
+#include <cstddef>
+
 class VertexArray
 {
 public:
@@ -10,6 +12,9 @@ public:
 	unsigned int GetNumIndices() const { return mNumIndices; }
 	unsigned int GetNumVerts() const { return mNumVerts; }
 	
+	// Size of the vertex and index buffers
+	size_t GetBufferBytes() const;
+	
 private:
 	unsigned int mNumVerts;
 	unsigned int mNumIndices;